@@ -651,11 +651,12 @@ __complex128_eq :: proc(a, b: complex128) -> bool #cc_contextless #inline { retu
 __complex128_ne :: proc(a, b: complex128) -> bool #cc_contextless #inline { return real(a) != real(b) || imag(a) != imag(b); }
 
 
-__bounds_check_error :: proc(file: string, line, column: int, index, count: int) #cc_contextless {
-	if 0 <= index && index < count do return;
+// Only called once the bounds check has failed, the check itself is inlined
+__bounds_check_error :: proc(file: string, line, column: int, index, count: int) #cc_contextless #cold #no_return {
 	fmt.fprintf(os.stderr, "%s(%d:%d) Index %d is out of bounds range 0..%d\n",
 	            file, line, column, index, count);
 	__debug_trap();
+	__trap();
 }
 
 __slice_expr_error :: proc(file: string, line, column: int, low, high, max: int) #cc_contextless {
@@ -683,6 +684,7 @@ __string_decode_rune :: proc(s: string) -> (rune, int) #cc_contextless #inline {
 }
 
 __bounds_check_error_loc :: proc(using loc := #caller_location, index, count: int) #cc_contextless {
+	if 0 <= index && index < count do return;
 	__bounds_check_error(file_path, int(line), int(column), index, count);
 }
 __slice_expr_error_loc :: proc(using loc := #caller_location, low, high, max: int) #cc_contextless {
@@ -0,0 +1,200 @@
+// Map and PtrSet microbenchmark
+//
+// Build and run from the root of the repository:
+//     clang++ misc/bench_map.cpp -std=c++11 -O2 -w -pthread -ldl -lm -o bench_map
+//     ./bench_map
+//
+// Each case mimics how the checker uses the tables and reports the best of several runs. Only the
+// map_*, multi_map_* and ptr_set_* procedures are used, so the benchmark can be built against an
+// older src/ to compare the two.
+//
+//     scopes      string keys, many small scopes and a few large ones
+//     node_types  400k AST node pointers, the shape of `CheckerInfo.types`
+//     graph       many small PtrSets of aligned pointers, the shape of the entity graph
+//     overloads   multi_map insert, count and get_all, the shape of overloaded procedures
+
+#include "../src/common.cpp"
+#include "../src/timings.cpp"
+
+enum {
+	BENCH_RUN_COUNT = 5,
+};
+
+// Stops the compiler from removing the lookups
+gb_global isize volatile bench_sink;
+
+gb_global u64 bench_state = 0x853c49e6748fea9bull;
+
+u64 bench_random(void) {
+	// splitmix64
+	u64 z = (bench_state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+f64 bench_seconds(u64 start, u64 finish) {
+	return cast(f64)(finish - start) / cast(f64)time_stamp__freq();
+}
+
+typedef void BenchProc(void *data);
+
+void bench_run(char const *name, BenchProc *proc, void *data) {
+	f64 best = 1e30;
+	for (isize run = 0; run < BENCH_RUN_COUNT; run++) {
+		u64 start = time_stamp_time_now();
+		proc(data);
+		best = gb_min(best, bench_seconds(start, time_stamp_time_now()));
+	}
+	gb_printf("%s: %.3f s\n", name, best);
+}
+
+
+struct BenchScopes {
+	Array<String> names;
+};
+
+void bench_scopes(void *data) {
+	BenchScopes *b = cast(BenchScopes *)data;
+	gbAllocator a = heap_allocator();
+	isize found = 0;
+	// Most scopes hold a handful of names and are looked up far more often than they are added to
+	for (isize scope = 0; scope < 20000; scope++) {
+		isize count = (scope % 50 == 0) ? 2000 : 1 + scope % 12;
+		isize offset = (scope * 7919) % (b->names.count - count*2);
+		Map<isize> m = {};
+		map_init(&m, a);
+		for (isize i = 0; i < count; i++) {
+			map_set(&m, hash_string(b->names[offset+i]), i);
+		}
+		for (isize i = 0; i < count*8; i++) {
+			isize *v = map_get(&m, hash_string(b->names[offset + (i*31) % (count*2)]));
+			found += v != nullptr;
+		}
+		map_destroy(&m);
+	}
+	bench_sink = found;
+}
+
+
+struct BenchNodeTypes {
+	u8 *  nodes;
+	isize node_count;
+	isize node_size;
+};
+
+void bench_node_types(void *data) {
+	BenchNodeTypes *b = cast(BenchNodeTypes *)data;
+	Map<isize> m = {};
+	map_init(&m, heap_allocator());
+	for (isize i = 0; i < b->node_count; i++) {
+		map_set(&m, hash_pointer(b->nodes + i*b->node_size), i);
+	}
+	isize found = 0;
+	for (isize r = 0; r < 4; r++) {
+		for (isize i = 0; i < b->node_count; i++) {
+			isize j = (i*7 + r) % (b->node_count + b->node_count/8);
+			isize *v = map_get(&m, hash_pointer(b->nodes + j*b->node_size));
+			found += v != nullptr;
+		}
+	}
+	map_destroy(&m);
+	bench_sink = found;
+}
+
+
+struct BenchGraph {
+	u8 *  entities;
+	isize entity_count;
+	isize entity_size;
+};
+
+void bench_graph(void *data) {
+	BenchGraph *b = cast(BenchGraph *)data;
+	isize found = 0;
+	for (isize i = 0; i < b->entity_count; i++) {
+		PtrSet<void *> deps = {};
+		ptr_set_init(&deps, heap_allocator());
+		isize count = 1 + i % 9;
+		for (isize j = 0; j < count; j++) {
+			isize k = (i*13 + j*101) % b->entity_count;
+			ptr_set_add(&deps, cast(void *)(b->entities + k*b->entity_size));
+		}
+		for (isize j = 0; j < count*2; j++) {
+			isize k = (i*13 + j*101) % b->entity_count;
+			found += ptr_set_exists(&deps, cast(void *)(b->entities + k*b->entity_size));
+		}
+		ptr_set_remove(&deps, cast(void *)(b->entities + ((i*13) % b->entity_count)*b->entity_size));
+		ptr_set_destroy(&deps);
+	}
+	bench_sink = found;
+}
+
+
+struct BenchOverloads {
+	Array<String> names;
+};
+
+void bench_overloads(void *data) {
+	BenchOverloads *b = cast(BenchOverloads *)data;
+	gbAllocator a = heap_allocator();
+	isize found = 0;
+	isize items[64] = {};
+	for (isize r = 0; r < 20; r++) {
+		Map<isize> m = {};
+		map_init(&m, a);
+		// A few names with many overloads and many names with one or two
+		for_array(i, b->names) {
+			isize count = (i % 97 == 0) ? 32 : 1 + i % 2;
+			HashKey key = hash_string(b->names[i]);
+			for (isize j = 0; j < count; j++) {
+				multi_map_insert(&m, key, j);
+			}
+		}
+		for_array(i, b->names) {
+			HashKey key = hash_string(b->names[i]);
+			isize count = multi_map_count(&m, key);
+			if (count <= gb_count_of(items)) {
+				multi_map_get_all(&m, key, items);
+				found += items[0];
+			}
+			found += count;
+		}
+		map_destroy(&m);
+	}
+	bench_sink = found;
+}
+
+
+int main(int arg_count, char **arg_ptr) {
+	gbAllocator a = heap_allocator();
+	init_string_buffer_memory();
+
+	Array<String> names = {};
+	array_init(&names, a);
+	for (isize i = 0; i < 40000; i++) {
+		char buf[32] = {};
+		isize len = gb_snprintf(buf, gb_size_of(buf), "name_%llx", cast(unsigned long long)bench_random() % 1000000ull) - 1;
+		array_add(&names, copy_string(a, make_string(cast(u8 *)buf, len)));
+	}
+
+	BenchScopes scopes = {names};
+	bench_run("scopes", bench_scopes, &scopes);
+
+	BenchNodeTypes node_types = {};
+	node_types.node_count = 400000;
+	node_types.node_size  = 64;
+	node_types.nodes      = cast(u8 *)gb_alloc(a, (node_types.node_count + node_types.node_count/8) * node_types.node_size);
+	bench_run("node_types", bench_node_types, &node_types);
+
+	BenchGraph graph = {};
+	graph.entity_count = 200000;
+	graph.entity_size  = 128;
+	graph.entities     = cast(u8 *)gb_alloc(a, graph.entity_count * graph.entity_size);
+	bench_run("graph", bench_graph, &graph);
+
+	BenchOverloads overloads = {names};
+	bench_run("overloads", bench_overloads, &overloads);
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+// Tokenizer microbenchmark
+//
+// Build and run from the root of the repository:
+//     clang++ misc/bench_tokenizer.cpp -std=c++11 -O2 -w -pthread -ldl -lm -o bench_tokenizer
+//     ./bench_tokenizer core/*.odin
+//
+// Reports the throughput of `tokenizer_get_token` over the given files and the cost of classifying
+// their identifiers with the keyword hash table against a linear scan over every keyword.
+// Each figure is the best of several runs.
+
+#include "../src/common.cpp"
+#include "../src/timings.cpp"
+#include "../src/build_settings.cpp"
+#include "../src/tokenizer.cpp"
+
+enum {
+	BENCH_RUN_COUNT        = 5,
+	BENCH_FILE_REPEATS     = 20,
+	BENCH_KEYWORD_REPEATS  = 50,
+};
+
+// Stops the compiler from hoisting the classification out of the repeat loops
+gb_global TokenKind volatile bench_sink;
+
+f64 bench_seconds(u64 start, u64 finish) {
+	return cast(f64)(finish - start) / cast(f64)time_stamp__freq();
+}
+
+// How identifiers were classified before the keyword hash table
+TokenKind keyword_kind_linear(String s) {
+	if (s.len > 1) {
+		for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
+			if (s == token_strings[k]) {
+				return cast(TokenKind)k;
+			}
+		}
+	}
+	return Token_Invalid;
+}
+
+isize bench_tokenize_file(String path, Array<String> *idents) {
+	Tokenizer t = {};
+	if (init_tokenizer(&t, path) != TokenizerInit_None) {
+		gb_printf_err("Unable to open %.*s\n", LIT(path));
+		gb_exit(1);
+	}
+	isize count = 0;
+	for (;;) {
+		Token token = tokenizer_get_token(&t);
+		count += 1;
+		if (idents != nullptr && (token.kind == Token_Ident || token_is_keyword(token.kind))) {
+			array_add(idents, copy_string(heap_allocator(), token.string));
+		}
+		if (token.kind == Token_EOF) {
+			break;
+		}
+	}
+	destroy_tokenizer(&t);
+	return count;
+}
+
+int main(int arg_count, char **arg_ptr) {
+	if (arg_count < 2) {
+		gb_printf_err("Usage: %s file.odin...\n", arg_ptr[0]);
+		return 1;
+	}
+	init_string_buffer_memory();
+	init_global_error_collector();
+	init_token_pos_files();
+	init_keyword_hash_table();
+	init_atom_table();
+
+	Array<String> paths = {};
+	array_init(&paths, heap_allocator());
+	for (isize i = 1; i < arg_count; i++) {
+		array_add(&paths, make_string_c(arg_ptr[i]));
+	}
+
+	Array<String> idents = {};
+	array_init(&idents, heap_allocator());
+	isize token_count = 0;
+	for_array(i, paths) {
+		token_count += bench_tokenize_file(paths[i], &idents);
+	}
+
+	f64 best = 1e30;
+	for (isize run = 0; run < BENCH_RUN_COUNT; run++) {
+		u64 start = time_stamp_time_now();
+		for (isize r = 0; r < BENCH_FILE_REPEATS; r++) {
+			for_array(i, paths) {
+				bench_tokenize_file(paths[i], nullptr);
+			}
+		}
+		best = gb_min(best, bench_seconds(start, time_stamp_time_now()));
+	}
+	f64 total_tokens = cast(f64)token_count * BENCH_FILE_REPEATS;
+	gb_printf("tokenizer:          %td files, %td tokens x %d\n", paths.count, token_count, BENCH_FILE_REPEATS);
+	gb_printf("                    %.3f s, %.2f Mtokens/s\n", best, total_tokens/best/1e6);
+
+	// Both ways must agree before either is timed
+	for_array(i, idents) {
+		if (keyword_kind(idents[i]) != keyword_kind_linear(idents[i])) {
+			gb_printf_err("Keyword classification mismatch for `%.*s`\n", LIT(idents[i]));
+			return 1;
+		}
+	}
+
+	f64 best_hash = 1e30;
+	f64 best_linear = 1e30;
+	isize keyword_count = 0;
+	for (isize run = 0; run < BENCH_RUN_COUNT; run++) {
+		keyword_count = 0;
+		u64 start = time_stamp_time_now();
+		for (isize r = 0; r < BENCH_KEYWORD_REPEATS; r++) {
+			for_array(i, idents) {
+				TokenKind kind = keyword_kind(idents[i]);
+				bench_sink = kind;
+				keyword_count += kind != Token_Invalid;
+			}
+		}
+		best_hash = gb_min(best_hash, bench_seconds(start, time_stamp_time_now()));
+
+		keyword_count = 0;
+		start = time_stamp_time_now();
+		for (isize r = 0; r < BENCH_KEYWORD_REPEATS; r++) {
+			for_array(i, idents) {
+				TokenKind kind = keyword_kind_linear(idents[i]);
+				bench_sink = kind;
+				keyword_count += kind != Token_Invalid;
+			}
+		}
+		best_linear = gb_min(best_linear, bench_seconds(start, time_stamp_time_now()));
+	}
+	f64 total_idents = cast(f64)idents.count * BENCH_KEYWORD_REPEATS;
+	gb_printf("keywords:           %td identifiers x %d, %td keywords\n", idents.count, BENCH_KEYWORD_REPEATS, keyword_count/BENCH_KEYWORD_REPEATS);
+	gb_printf("    hash table      %.3f s, %.2f Midents/s\n", best_hash,   total_idents/best_hash/1e6);
+	gb_printf("    linear scan     %.3f s, %.2f Midents/s\n", best_linear, total_idents/best_linear/1e6);
+
+	return 0;
+}
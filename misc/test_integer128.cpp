@@ -0,0 +1,166 @@
+// Differential test of the native `__int128` and portable 128-bit integer arithmetic
+//
+// Build and run from the root of the repository:
+//     clang++ misc/test_integer128.cpp -std=c++11 -O2 -w -pthread -ldl -lm -o test_integer128
+//     ./test_integer128 [iteration_count] [seed]
+//
+// integer128.cpp is compiled twice: once through common.cpp, which uses `__int128` where the
+// compiler has it, and once within `namespace portable` with BIT128_PORTABLE defined. Every
+// operation which may go native is run on both with edge-biased random operands and the results
+// must be identical. Returns non-zero on the first mismatch.
+
+#include "../src/common.cpp"
+
+#if defined(BIT128_NATIVE)
+	#define TEST_INTEGER128_NATIVE
+#endif
+
+#undef BIT128_NATIVE
+#define BIT128_PORTABLE
+namespace portable {
+#include "../src/integer128.cpp"
+}
+
+gb_global u64 test_state = 0x9e3779b97f4a7c15ull;
+
+u64 test_random(void) {
+	// splitmix64
+	u64 z = (test_state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+// Most operands are near a limb or sign boundary, as that is where the two ways may differ
+u64 test_random_limb(void) {
+	u64 r = test_random();
+	switch (r % 8) {
+	case 0: return 0;
+	case 1: return (r >> 8) % 4;
+	case 2: return BIT128_U64_ALLBITS - (r >> 8) % 4;
+	case 3: return BIT128_U64_HIGHBIT + (r >> 8) % 4 - 2;
+	case 4: return (r >> 8) & 0xffffffffull;
+	case 5: return 1ull << ((r >> 8) % 64);
+	}
+	return test_random();
+}
+
+u128 test_random_u128(void) {
+	return u128_lo_hi(test_random_limb(), test_random_limb());
+}
+
+gb_inline portable::u128 to_portable(u128 a) { return portable::u128_lo_hi(a.lo, a.hi); }
+gb_inline portable::i128 to_portable(i128 a) { return portable::i128_lo_hi(a.lo, a.hi); }
+
+gb_global isize test_failure_count = 0;
+
+void test_check(char const *op, u128 a, u128 b, u128 native, portable::u128 port) {
+	if (native.lo != port.lo || native.hi != port.hi) {
+		gb_printf_err("u128 %s mismatch: a = 0x%016llx%016llx, b = 0x%016llx%016llx\n"
+		              "\tnative   = 0x%016llx%016llx\n\tportable = 0x%016llx%016llx\n",
+		              op,
+		              cast(unsigned long long)a.hi, cast(unsigned long long)a.lo,
+		              cast(unsigned long long)b.hi, cast(unsigned long long)b.lo,
+		              cast(unsigned long long)native.hi, cast(unsigned long long)native.lo,
+		              cast(unsigned long long)port.hi, cast(unsigned long long)port.lo);
+		test_failure_count++;
+	}
+}
+
+void test_check(char const *op, i128 a, i128 b, i128 native, portable::i128 port) {
+	if (native.lo != port.lo || native.hi != port.hi) {
+		gb_printf_err("i128 %s mismatch: a = 0x%016llx%016llx, b = 0x%016llx%016llx\n"
+		              "\tnative   = 0x%016llx%016llx\n\tportable = 0x%016llx%016llx\n",
+		              op,
+		              cast(unsigned long long)a.hi, cast(unsigned long long)a.lo,
+		              cast(unsigned long long)b.hi, cast(unsigned long long)b.lo,
+		              cast(unsigned long long)native.hi, cast(unsigned long long)native.lo,
+		              cast(unsigned long long)port.hi, cast(unsigned long long)port.lo);
+		test_failure_count++;
+	}
+}
+
+void test_u128(u128 a, u128 b, u32 n) {
+	portable::u128 pa = to_portable(a);
+	portable::u128 pb = to_portable(b);
+	test_check("add", a, b, u128_add(a, b), portable::u128_add(pa, pb));
+	test_check("sub", a, b, u128_sub(a, b), portable::u128_sub(pa, pb));
+	test_check("neg", a, b, u128_neg(a),    portable::u128_neg(pa));
+	test_check("mul", a, b, u128_mul(a, b), portable::u128_mul(pa, pb));
+	test_check("shl", a, u128_from_u64(n), u128_shl(a, n), portable::u128_shl(pa, n));
+	test_check("shr", a, u128_from_u64(n), u128_shr(a, n), portable::u128_shr(pa, n));
+	if (u128_ne(b, U128_ZERO)) {
+		u128 quo, rem;
+		portable::u128 pquo, prem;
+		u128_divide(a, b, &quo, &rem);
+		portable::u128_divide(pa, pb, &pquo, &prem);
+		test_check("divide quo", a, b, quo, pquo);
+		test_check("divide rem", a, b, rem, prem);
+		test_check("quo", a, b, u128_quo(a, b), portable::u128_quo(pa, pb));
+		test_check("mod", a, b, u128_mod(a, b), portable::u128_mod(pa, pb));
+	}
+
+	char buf[64] = {};
+	String s = u128_to_string(a, buf, gb_size_of(buf));
+	test_check("string", a, b, u128_from_string(s), portable::u128_from_string(s));
+	test_check("string round trip", a, b, a, portable::u128_from_string(s));
+}
+
+void test_i128(i128 a, i128 b, u32 n) {
+	portable::i128 pa = to_portable(a);
+	portable::i128 pb = to_portable(b);
+	test_check("add", a, b, i128_add(a, b), portable::i128_add(pa, pb));
+	test_check("sub", a, b, i128_sub(a, b), portable::i128_sub(pa, pb));
+	test_check("neg", a, b, i128_neg(a),    portable::i128_neg(pa));
+	test_check("mul", a, b, i128_mul(a, b), portable::i128_mul(pa, pb));
+	test_check("shl", a, i128_from_u64(n), i128_shl(a, n), portable::i128_shl(pa, n));
+	test_check("shr", a, i128_from_u64(n), i128_shr(a, n), portable::i128_shr(pa, n));
+	// When both high limbs are all ones, both ways divide the low limbs as i64 values. That traps
+	// when the low limb of the divisor is 0 or on the minimum value divided by -1, so those pairs
+	// are left out
+	bool is_i64_trap = (~a.hi) == 0 && (~b.hi) == 0 &&
+	                   (b.lo == 0 || (a.lo == BIT128_U64_HIGHBIT && b.lo == BIT128_U64_ALLBITS));
+	if (i128_ne(b, I128_ZERO) && !is_i64_trap) {
+		i128 quo, rem;
+		portable::i128 pquo, prem;
+		i128_divide(a, b, &quo, &rem);
+		portable::i128_divide(pa, pb, &pquo, &prem);
+		test_check("divide quo", a, b, quo, pquo);
+		test_check("divide rem", a, b, rem, prem);
+		test_check("quo", a, b, i128_quo(a, b), portable::i128_quo(pa, pb));
+		test_check("mod", a, b, i128_mod(a, b), portable::i128_mod(pa, pb));
+	}
+
+	char buf[64] = {};
+	String s = i128_to_string(a, buf, gb_size_of(buf));
+	test_check("string", a, b, i128_from_string(s), portable::i128_from_string(s));
+}
+
+int main(int arg_count, char **arg_ptr) {
+	isize iteration_count = 300000;
+	if (arg_count > 1) {
+		iteration_count = cast(isize)gb_str_to_i64(arg_ptr[1], nullptr, 10);
+	}
+	if (arg_count > 2) {
+		test_state = cast(u64)gb_str_to_u64(arg_ptr[2], nullptr, 10);
+	}
+
+#if !defined(TEST_INTEGER128_NATIVE)
+	gb_printf("Note: this compiler has no native __int128, both sides use the portable arithmetic\n");
+#endif
+
+	for (isize i = 0; i < iteration_count; i++) {
+		u128 a = test_random_u128();
+		u128 b = test_random_u128();
+		u32 n = cast(u32)(test_random() % 128);
+		test_u128(a, b, n);
+		test_i128(u128_to_i128(a), u128_to_i128(b), n);
+		if (test_failure_count > 0) {
+			gb_printf_err("Failed after %td iterations\n", i+1);
+			return 1;
+		}
+	}
+
+	gb_printf("integer128: %td iterations, no mismatches\n", iteration_count);
+	return 0;
+}
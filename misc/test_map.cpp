@@ -0,0 +1,291 @@
+// Tests of removing entries from `Map` and `PtrSet`
+//
+// Build and run from the root of the repository:
+//     clang++ misc/test_map.cpp -std=c++11 -O2 -w -pthread -ldl -lm -o test_map
+//     ./test_map [iteration_count] [seed]
+//
+// Removing an entry moves the last entry into its hole and pops it, so `entries` never holds a stale
+// duplicate and `entries.count` is always the number of entries. The targeted tests check that,
+// then a randomized run checks `Map`, the `multi_map_*` procedures and `PtrSet` against a plain
+// array of (key, value) pairs. Returns non-zero on the first failure.
+
+#include "../src/common.cpp"
+
+gb_global isize test_failure_count = 0;
+
+#define TEST_EXPECT(cond) do { \
+		if (!(cond)) { \
+			gb_printf_err("%s(%d): expected `%s`\n", __FILE__, __LINE__, #cond); \
+			test_failure_count++; \
+		} \
+	} while (0)
+
+gb_global u64 test_state = 0x2545f4914f6cdd1dull;
+
+u64 test_random(void) {
+	// splitmix64
+	u64 z = (test_state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+void test_map_remove_pops_last(void) {
+	Map<isize> m = {};
+	map_init(&m, heap_allocator());
+	for (isize i = 0; i < 8; i++) {
+		map_set(&m, hash_integer(cast(u64)i), i*10);
+	}
+	TEST_EXPECT(m.entries.count == 8);
+
+	// The last entry moves into the hole left by the removed one
+	map_remove(&m, hash_integer(2));
+	TEST_EXPECT(m.entries.count == 7);
+	TEST_EXPECT(map_get(&m, hash_integer(2)) == nullptr);
+	TEST_EXPECT(m.entries[2].key.key == 7);
+	TEST_EXPECT(m.entries[2].value == 70);
+	for (isize i = 0; i < 8; i++) {
+		isize *found = map_get(&m, hash_integer(cast(u64)i));
+		if (i == 2) {
+			TEST_EXPECT(found == nullptr);
+		} else {
+			TEST_EXPECT(found != nullptr && *found == i*10);
+		}
+	}
+
+	// Removing the last entry only pops it
+	map_remove(&m, hash_integer(6));
+	TEST_EXPECT(m.entries.count == 6);
+	TEST_EXPECT(m.entries[5].key.key == 5);
+
+	// Removing a key which is not there changes nothing
+	map_remove(&m, hash_integer(100));
+	TEST_EXPECT(m.entries.count == 6);
+
+	// No key is iterated twice
+	for_array(i, m.entries) {
+		for (isize j = i+1; j < m.entries.count; j++) {
+			TEST_EXPECT(m.entries[i].key.key != m.entries[j].key.key);
+		}
+	}
+
+	while (m.entries.count > 0) {
+		map_remove(&m, m.entries[0].key);
+	}
+	TEST_EXPECT(map_get(&m, hash_integer(7)) == nullptr);
+	map_set(&m, hash_integer(7), cast(isize)7);
+	TEST_EXPECT(m.entries.count == 1);
+	TEST_EXPECT(*map_get(&m, hash_integer(7)) == 7);
+
+	map_destroy(&m);
+}
+
+void test_multi_map_remove(void) {
+	Map<isize> m = {};
+	map_init(&m, heap_allocator());
+	HashKey a = hash_integer(1);
+	HashKey b = hash_integer(2);
+	multi_map_insert(&m, a, cast(isize)10);
+	multi_map_insert(&m, b, cast(isize)20);
+	multi_map_insert(&m, a, cast(isize)11);
+	multi_map_insert(&m, b, cast(isize)21);
+	multi_map_insert(&m, a, cast(isize)12);
+	TEST_EXPECT(multi_map_count(&m, a) == 3);
+	TEST_EXPECT(multi_map_count(&m, b) == 2);
+
+	// Remove the middle value of `a`, the last entry (`a` = 12) moves into its hole
+	MapEntry<isize> *e = multi_map_find_first(&m, a);
+	e = multi_map_find_next(&m, e);
+	TEST_EXPECT(e->value == 11);
+	multi_map_remove(&m, a, e);
+	TEST_EXPECT(m.entries.count == 4);
+	TEST_EXPECT(multi_map_count(&m, a) == 2);
+
+	isize items[3] = {};
+	multi_map_get_all(&m, a, items);
+	TEST_EXPECT(items[0] == 12); // The newest value is found first
+	TEST_EXPECT(items[1] == 10);
+
+	// Removing the head of a chain keeps the rest of it
+	multi_map_remove(&m, b, multi_map_find_first(&m, b));
+	TEST_EXPECT(m.entries.count == 3);
+	TEST_EXPECT(multi_map_count(&m, b) == 1);
+	TEST_EXPECT(*map_get(&m, b) == 20);
+	TEST_EXPECT(multi_map_count(&m, a) == 2);
+
+	multi_map_remove_all(&m, a);
+	TEST_EXPECT(m.entries.count == 1);
+	TEST_EXPECT(multi_map_count(&m, a) == 0);
+	TEST_EXPECT(multi_map_count(&m, b) == 1);
+
+	map_destroy(&m);
+}
+
+void test_ptr_set_remove_pops_last(void) {
+	isize values[8] = {};
+	PtrSet<isize *> s = {};
+	ptr_set_init(&s, heap_allocator());
+	for (isize i = 0; i < 8; i++) {
+		ptr_set_add(&s, &values[i]);
+	}
+	ptr_set_remove(&s, &values[3]);
+	TEST_EXPECT(s.entries.count == 7);
+	TEST_EXPECT(s.entries[3].ptr == &values[7]);
+	TEST_EXPECT(!ptr_set_exists(&s, &values[3]));
+	for (isize i = 0; i < 8; i++) {
+		TEST_EXPECT(ptr_set_exists(&s, &values[i]) == (i != 3));
+	}
+	ptr_set_destroy(&s);
+}
+
+
+struct TestPair {
+	u64   key;
+	isize value;
+};
+
+void test_remove_pair(Array<TestPair> *ref, isize index) {
+	gb_memmove(ref->data+index, ref->data+index+1, (ref->count-index-1)*gb_size_of(TestPair));
+	ref->count -= 1;
+}
+
+// The values of `key` in the reference, newest first like `multi_map_get_all`
+isize test_reference_values(Array<TestPair> *ref, u64 key, isize *items) {
+	isize count = 0;
+	for (isize i = ref->count-1; i >= 0; i--) {
+		if ((*ref)[i].key == key) {
+			items[count++] = (*ref)[i].value;
+		}
+	}
+	return count;
+}
+
+void test_map_against_reference(isize iteration_count) {
+	enum {KEY_COUNT = 64, MAX_VALUES = 1024};
+	gbAllocator a = heap_allocator();
+
+	Map<isize> m = {};
+	map_init(&m, a);
+	Array<TestPair> ref = {};
+	array_init(&ref, a);
+	isize *expected = gb_alloc_array(a, isize, MAX_VALUES);
+	isize *actual   = gb_alloc_array(a, isize, MAX_VALUES);
+
+	PtrSet<isize *> s = {};
+	ptr_set_init(&s, a);
+	isize *ptrs = gb_alloc_array(a, isize, KEY_COUNT);
+	bool in_set[KEY_COUNT] = {};
+
+	for (isize it = 0; it < iteration_count && test_failure_count == 0; it++) {
+		u64 r = test_random();
+		u64 key = (r >> 8) % KEY_COUNT;
+		HashKey hkey = hash_integer(key);
+		isize value = cast(isize)it;
+
+		switch (r % 6) {
+		case 0:
+		case 1:
+			if (ref.count < MAX_VALUES) {
+				multi_map_insert(&m, hkey, value);
+				TestPair p = {key, value};
+				array_add(&ref, p);
+			}
+			break;
+		case 2: {
+			// Remove one value of the key, chosen at random
+			isize count = multi_map_count(&m, hkey);
+			if (count > 0) {
+				isize n = cast(isize)((r >> 16) % cast(u64)count);
+				MapEntry<isize> *e = multi_map_find_first(&m, hkey);
+				for (isize i = 0; i < n; i++) {
+					e = multi_map_find_next(&m, e);
+				}
+				isize removed = e->value;
+				multi_map_remove(&m, hkey, e);
+				for_array(i, ref) {
+					if (ref[i].key == key && ref[i].value == removed) {
+						test_remove_pair(&ref, i);
+						break;
+					}
+				}
+			}
+		} break;
+		case 3:
+			map_remove(&m, hkey);
+			for (isize i = ref.count-1; i >= 0; i--) {
+				if (ref[i].key == key) {
+					test_remove_pair(&ref, i);
+					break;
+				}
+			}
+			break;
+		case 4:
+			if (in_set[key]) {
+				ptr_set_remove(&s, &ptrs[key]);
+			} else {
+				ptr_set_add(&s, &ptrs[key]);
+			}
+			in_set[key] = !in_set[key];
+			break;
+		case 5:
+			if ((r >> 16) % 64 == 0) {
+				map_rehash(&m, m.entries.count*2);
+				ptr_set_rehash(&s, s.entries.count*2);
+			}
+			break;
+		}
+
+		TEST_EXPECT(m.entries.count == ref.count);
+		for (u64 k = 0; k < KEY_COUNT; k++) {
+			isize expected_count = test_reference_values(&ref, k, expected);
+			isize actual_count = multi_map_count(&m, hash_integer(k));
+			TEST_EXPECT(actual_count == expected_count);
+			if (actual_count == expected_count) {
+				multi_map_get_all(&m, hash_integer(k), actual);
+				for (isize i = 0; i < actual_count; i++) {
+					TEST_EXPECT(actual[i] == expected[i]);
+				}
+			}
+			TEST_EXPECT(ptr_set_exists(&s, &ptrs[k]) == in_set[k]);
+		}
+		isize set_count = 0;
+		for (isize k = 0; k < KEY_COUNT; k++) {
+			set_count += in_set[k];
+		}
+		TEST_EXPECT(s.entries.count == set_count);
+
+		if (test_failure_count > 0) {
+			gb_printf_err("Failed after %td iterations\n", it+1);
+		}
+	}
+
+	gb_free(a, ptrs);
+	gb_free(a, actual);
+	gb_free(a, expected);
+	ptr_set_destroy(&s);
+	array_free(&ref);
+	map_destroy(&m);
+}
+
+int main(int arg_count, char **arg_ptr) {
+	isize iteration_count = 20000;
+	if (arg_count > 1) {
+		iteration_count = cast(isize)gb_str_to_i64(arg_ptr[1], nullptr, 10);
+	}
+	if (arg_count > 2) {
+		test_state = cast(u64)gb_str_to_u64(arg_ptr[2], nullptr, 10);
+	}
+
+	test_map_remove_pops_last();
+	test_multi_map_remove();
+	test_ptr_set_remove_pops_last();
+	if (test_failure_count == 0) {
+		test_map_against_reference(iteration_count);
+	}
+
+	if (test_failure_count > 0) {
+		return 1;
+	}
+	gb_printf("map: %td iterations, all passed\n", iteration_count);
+	return 0;
+}
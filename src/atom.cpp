@@ -0,0 +1,63 @@
+// An `Atom` is an interned identifier. Every distinct string is interned exactly once, so two
+// atoms are equal if and only if their pointers are equal and the hash never needs recomputing.
+// The table is global and shared between the parsing threads, the checker, and the IR generator.
+
+struct Atom {
+	u64    hash;
+	String string;
+};
+
+// The table is split into shards each with its own lock so that the parsing
+// threads do not all contend on the same mutex
+#define ATOM_TABLE_SHARD_BITS 6
+#define ATOM_TABLE_SHARD_COUNT (1<<ATOM_TABLE_SHARD_BITS)
+
+struct AtomTableShard {
+	gbMutex     mutex;
+	Map<Atom *> atoms; // Key: String
+};
+
+gb_global AtomTableShard atom_table_shards[ATOM_TABLE_SHARD_COUNT];
+
+
+void init_atom_table(void) {
+	for (isize i = 0; i < ATOM_TABLE_SHARD_COUNT; i++) {
+		AtomTableShard *shard = &atom_table_shards[i];
+		gb_mutex_init(&shard->mutex);
+		map_init(&shard->atoms, heap_allocator());
+	}
+}
+
+Atom *make_atom(String str) {
+	HashKey key = hash_string(str);
+	// Use the top bits for the shard as `Map` uses the bottom bits for its buckets
+	AtomTableShard *shard = &atom_table_shards[key.key >> (64-ATOM_TABLE_SHARD_BITS)];
+
+	gb_mutex_lock(&shard->mutex);
+	defer (gb_mutex_unlock(&shard->mutex));
+
+	Atom **found = map_get(&shard->atoms, key);
+	if (found != nullptr) {
+		return *found;
+	}
+
+	// Copy the string as the atom must outlive the file it came from
+	Atom *atom = cast(Atom *)gb_alloc(heap_allocator(), gb_size_of(Atom) + str.len + 1);
+	u8 *text = cast(u8 *)(atom+1);
+	gb_memmove(text, str.text, str.len);
+	text[str.len] = 0;
+	atom->hash   = key.key;
+	atom->string = make_string(text, str.len);
+
+	key.string = atom->string;
+	map_set(&shard->atoms, key, atom);
+	return atom;
+}
+
+gb_inline HashKey hash_atom(Atom *atom) {
+	GB_ASSERT(atom != nullptr);
+	HashKey h = {HashKey_Atom};
+	h.key  = atom->hash;
+	h.atom = atom;
+	return h;
+}
@@ -18,8 +18,11 @@ struct BuildContext {
 	bool   is_dll;
 	bool   generate_docs;
 	i32    optimization_level;
+	i32    ir_optimization_level; // Level of the passes run over the IR before it is printed, 0 unless `-ir-opt` is given
 	bool   show_timings;
 	bool   keep_temp_files;
+	bool   lazy_proc_bodies; // Only parse a procedure body once the checker needs it
+	bool   lazy_check;       // Only check the bodies of the procedures reachable from the entry point
 
 	gbAffinity affinity;
 	isize      thread_count;
@@ -268,9 +271,29 @@ String path_to_fullpath(gbAllocator a, String s) {
 #endif
 
 
+// Many files import the same paths relative to the same directories (e.g. `core`), so
+// remember each canonicalized full path rather than asking the OS to resolve it again. The cache is
+// split into shards each with its own lock so the parsing threads rarely contend.
+#define FULLPATH_CACHE_SHARD_BITS 4
+#define FULLPATH_CACHE_SHARD_COUNT (1<<FULLPATH_CACHE_SHARD_BITS)
+
+struct FullpathCacheShard {
+	gbMutex     mutex;
+	Map<String> paths; // Key: String (base_dir/path)
+};
+
+gb_global FullpathCacheShard fullpath_cache_shards[FULLPATH_CACHE_SHARD_COUNT];
+
+void init_fullpath_cache(void) {
+	for (isize i = 0; i < FULLPATH_CACHE_SHARD_COUNT; i++) {
+		FullpathCacheShard *shard = &fullpath_cache_shards[i];
+		gb_mutex_init(&shard->mutex);
+		map_init(&shard->paths, heap_allocator());
+	}
+}
+
 String get_fullpath_relative(gbAllocator a, String base_dir, String path) {
 	u8 *str = gb_alloc_array(heap_allocator(), u8, base_dir.len+1+path.len+1);
-	defer (gb_free(heap_allocator(), str));
 
 	isize i = 0;
 	gb_memmove(str+i, base_dir.text, base_dir.len); i += base_dir.len;
@@ -280,7 +303,39 @@ String get_fullpath_relative(gbAllocator a, String base_dir, String path) {
 
 	String res = make_string(str, i);
 	res = string_trim_whitespace(res);
-	return path_to_fullpath(a, res);
+
+	HashKey key = hash_string(res);
+	FullpathCacheShard *shard = &fullpath_cache_shards[key.key >> (64-FULLPATH_CACHE_SHARD_BITS)];
+
+	gb_mutex_lock(&shard->mutex);
+	String *found = map_get(&shard->paths, key);
+	if (found != nullptr) {
+		String fullpath = *found;
+		gb_mutex_unlock(&shard->mutex);
+		gb_free(heap_allocator(), str);
+		return copy_string(a, fullpath);
+	}
+	gb_mutex_unlock(&shard->mutex);
+
+	// Resolve the path outside of the lock; if two threads race on the same path,
+	// they both get the same answer and the first one to finish is kept
+	String fullpath = path_to_fullpath(heap_allocator(), res);
+
+	gb_mutex_lock(&shard->mutex);
+	found = map_get(&shard->paths, key);
+	if (found == nullptr) {
+		// The key keeps pointing at `str`, so it is owned by the cache from here on
+		map_set(&shard->paths, key, fullpath);
+		str = nullptr;
+	} else {
+		fullpath = *found;
+	}
+	gb_mutex_unlock(&shard->mutex);
+
+	if (str != nullptr) {
+		gb_free(heap_allocator(), str);
+	}
+	return copy_string(a, fullpath);
 }
 
 
@@ -114,7 +114,7 @@ void check_init_variables(Checker *c, Entity **lhs, isize lhs_count, Array<AstNo
 	isize max = gb_min(lhs_count, rhs_count);
 	for (isize i = 0; i < max; i++) {
 		Entity *e = lhs[i];
-		DeclInfo *d = decl_info_of_entity(&c->info, e);
+		DeclInfo *d = decl_info_of_entity(c->info, e);
 		Operand *o = &operands[i];
 		check_init_variable(c, e, o, context_name);
 		if (d != nullptr) {
@@ -378,7 +378,7 @@ void init_entity_foreign_library(Checker *c, Entity *e) {
 		error(ident, "foreign library names must be an identifier");
 	} else {
 		String name = ident->Ident.token.string;
-		Entity *found = scope_lookup_entity(c->context.scope, name);
+		Entity *found = scope_lookup_entity(c->context.scope, ident->Ident.atom);
 		if (found == nullptr) {
 			if (is_blank_ident(name)) {
 				error(ident, "`_` cannot be used as a value type");
@@ -431,6 +431,7 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 	bool is_inline          = (pl->tags & ProcTag_inline)    != 0;
 	bool is_no_inline       = (pl->tags & ProcTag_no_inline) != 0;
 	bool is_require_results = (pl->tags & ProcTag_require_results) != 0;
+	bool is_no_return       = (pl->tags & ProcTag_no_return) != 0;
 
 
 
@@ -447,10 +448,10 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 		}
 		pt->calling_convention = ProcCC_Contextless;
 		if (d->scope->is_init) {
-			if (c->info.entry_point != nullptr) {
+			if (c->info->entry_point != nullptr) {
 				error(e->token, "Redeclaration of the entry pointer procedure `main`");
 			} else {
-				c->info.entry_point = e;
+				c->info->entry_point = e;
 			}
 		}
 	}
@@ -464,7 +465,7 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 	}
 
 	if (pt->is_polymorphic) {
-		if (pl->body == nullptr) {
+		if (!ast_proc_lit_has_body(d->proc_lit)) {
 			error(e->token, "Polymorphic procedures must have a body");
 		}
 
@@ -474,19 +475,21 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 		}
 	}
 
-	if (pl->body != nullptr) {
+	if (ast_proc_lit_has_body(d->proc_lit)) {
 		if (is_foreign) {
-			error(pl->body, "A foreign procedure cannot have a body");
+			error(pl->type, "A foreign procedure cannot have a body");
 		}
 		if (proc_type->Proc.c_vararg) {
-			error(pl->body, "A procedure with a `#c_vararg` field cannot have a body and must be foreign");
+			error(pl->type, "A procedure with a `#c_vararg` field cannot have a body and must be foreign");
 		}
 
 		d->scope = c->context.scope;
 
-		GB_ASSERT(pl->body->kind == AstNode_BlockStmt);
+		// A polymorphic procedure's body is only needed (and parsed) once it is specialized
 		if (!pt->is_polymorphic) {
-			check_procedure_later(c, c->curr_ast_file, e->token, d, proc_type, pl->body, pl->tags);
+			AstNode *body = ast_proc_lit_body(d->proc_lit);
+			GB_ASSERT(body->kind == AstNode_BlockStmt);
+			check_procedure_later(c, c->curr_ast_file, e->token, d, proc_type, body, pl->tags);
 		}
 	} else if (!is_foreign) {
 		error(e->token, "Only a foreign procedure cannot have a body");
@@ -498,6 +501,10 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 		pt->require_results = is_require_results;
 	}
 
+	if (pt->result_count != 0 && is_no_return) {
+		error(pl->type, "A `#no_return` procedure cannot have results");
+	}
+
 
 
 	if (is_foreign) {
@@ -511,7 +518,9 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 		init_entity_foreign_library(c, e);
 
 
-		auto *fp = &c->info.foreigns;
+		checker_lock_foreigns(c->info);
+		defer (checker_unlock_foreigns(c->info));
+		auto *fp = &c->info->foreigns;
 		HashKey key = hash_string(name);
 		Entity **found = map_get(fp, key);
 		if (found) {
@@ -523,14 +532,14 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 				if (!are_signatures_similar_enough(this_type, other_type)) {
 					error(d->proc_lit,
 					      "Redeclaration of foreign procedure `%.*s` with different type signatures\n"
-					      "\tat %.*s(%td:%td)",
-					      LIT(name), LIT(pos.file), pos.line, pos.column);
+					      "\tat %.*s(%d:%d)",
+					      LIT(name), LIT(token_pos_file(pos)), pos.line, pos.column);
 				}
 			} else if (!are_types_identical(this_type, other_type)) {
 				error(d->proc_lit,
 				      "Foreign entity `%.*s` previously declared elsewhere with a different type\n"
-				      "\tat %.*s(%td:%td)",
-				      LIT(name), LIT(pos.file), pos.line, pos.column);
+				      "\tat %.*s(%d:%d)",
+				      LIT(name), LIT(token_pos_file(pos)), pos.line, pos.column);
 			}
 		} else if (name == "main") {
 			error(d->proc_lit, "The link name `main` is reserved for internal use");
@@ -544,7 +553,9 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 		}
 
 		if (is_link_name || is_export) {
-			auto *fp = &c->info.foreigns;
+			checker_lock_foreigns(c->info);
+			defer (checker_unlock_foreigns(c->info));
+			auto *fp = &c->info->foreigns;
 
 			e->Procedure.link_name = name;
 
@@ -556,8 +567,8 @@ void check_proc_decl(Checker *c, Entity *e, DeclInfo *d) {
 				// TODO(bill): Better error message?
 				error(d->proc_lit,
 				      "Non unique linking name for procedure `%.*s`\n"
-				      "\tother at %.*s(%td:%td)",
-				      LIT(name), LIT(pos.file), pos.line, pos.column);
+				      "\tother at %.*s(%d:%d)",
+				      LIT(name), LIT(token_pos_file(pos)), pos.line, pos.column);
 			} else if (name == "main") {
 				error(d->proc_lit, "The link name `main` is reserved for internal use");
 			} else {
@@ -604,7 +615,9 @@ void check_var_decl(Checker *c, Entity *e, Entity **entities, isize entity_count
 		init_entity_foreign_library(c, e);
 
 		String name = e->token.string;
-		auto *fp = &c->info.foreigns;
+		checker_lock_foreigns(c->info);
+		defer (checker_unlock_foreigns(c->info));
+		auto *fp = &c->info->foreigns;
 		HashKey key = hash_string(name);
 		Entity **found = map_get(fp, key);
 		if (found) {
@@ -615,8 +628,8 @@ void check_var_decl(Checker *c, Entity *e, Entity **entities, isize entity_count
 			if (!are_types_identical(this_type, other_type)) {
 				error(e->token,
 				      "Foreign entity `%.*s` previously declared elsewhere with a different type\n"
-				      "\tat %.*s(%td:%td)",
-				      LIT(name), LIT(pos.file), pos.line, pos.column);
+				      "\tat %.*s(%d:%d)",
+				      LIT(name), LIT(token_pos_file(pos)), pos.line, pos.column);
 			}
 		} else {
 			map_set(fp, key, e);
@@ -645,7 +658,7 @@ void check_entity_decl(Checker *c, Entity *e, DeclInfo *d, Type *named_type) {
 	}
 
 	if (d == nullptr) {
-		d = decl_info_of_entity(&c->info, e);
+		d = decl_info_of_entity(c->info, e);
 		if (d == nullptr) {
 			// TODO(bill): Err here?
 			e->type = t_invalid;
@@ -720,7 +733,7 @@ void check_proc_body(Checker *c, Token token, DeclInfo *decl, Type *type, AstNod
 			if (t->kind == Type_Struct) {
 				Scope *scope = t->Struct.scope;
 				if (scope == nullptr) {
-					scope = scope_of_node(&c->info, t->Struct.node);
+					scope = scope_of_node(c->info, t->Struct.node);
 				}
 				GB_ASSERT(scope != nullptr);
 				for_array(i, scope->elements.entries) {
@@ -760,13 +773,8 @@ void check_proc_body(Checker *c, Token token, DeclInfo *decl, Type *type, AstNod
 
 	check_scope_usage(c, c->context.scope);
 
-	if (decl->parent != nullptr) {
-		// NOTE(bill): Add the dependencies from the procedure literal (lambda)
-		for_array(i, decl->deps.entries) {
-			Entity *e = decl->deps.entries[i].ptr;
-			ptr_set_add(&decl->parent->deps, e);
-		}
-	}
+	// The dependencies of a procedure literal (lambda) are added to its parent
+	// once every procedure body has been checked, see `check_merge_jobs`
 }
 
 
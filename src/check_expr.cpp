@@ -61,6 +61,7 @@ void     check_type_decl                (Checker *c, Entity *e, AstNode *type_ex
 Entity * check_selector                 (Checker *c, Operand *operand, AstNode *node, Type *type_hint);
 Entity * check_ident                    (Checker *c, Operand *o, AstNode *n, Type *named_type, Type *type_hint, bool allow_import_name);
 Entity * find_polymorphic_struct_entity(Checker *c, Type *original_type, isize param_count, Array<Operand> ordered_operands);
+String   make_polymorphic_struct_canonical_name(Type *original_type, isize param_count, Array<Operand> ordered_operands);
 void     check_not_tuple                (Checker *c, Operand *operand);
 void     convert_to_typed               (Checker *c, Operand *operand, Type *target_type, i32 level);
 gbString expr_to_string                 (AstNode *expression);
@@ -122,7 +123,7 @@ void check_scope_decls(Checker *c, Array<AstNode *> nodes, isize reserve_size) {
 		default:
 			continue;
 		}
-		DeclInfo *d = decl_info_of_entity(&c->info, e);
+		DeclInfo *d = decl_info_of_entity(c->info, e);
 		if (d != nullptr) {
 			check_entity_decl(c, e, d, nullptr);
 		}
@@ -172,6 +173,86 @@ bool check_is_assignable_to_using_subtype(Type *src, Type *dst) {
 	return false;
 }
 
+// The operands of a specialization come either from the call or from the procedure type it
+// is assigned to. Reading them one at a time means a cache lookup needs no allocation
+PolyProcCacheOperand poly_proc_cache_operand(Type *dst, Array<Operand> *operands, isize i) {
+	PolyProcCacheOperand o = {};
+	if (operands != nullptr) {
+		Operand *op = &(*operands)[i];
+		o.mode = op->mode;
+		o.type = op->type;
+	} else {
+		o.mode = Addressing_Value;
+		o.type = dst->Proc.params->Tuple.variables[i]->type;
+	}
+	return o;
+}
+
+isize poly_proc_cache_operand_count(Type *dst, Array<Operand> *operands) {
+	if (operands != nullptr) {
+		return operands->count;
+	}
+	return dst->Proc.param_count;
+}
+
+// Only the mode and type of an operand are used to make the procedure type, not any
+// constant value. Types are compared by pointer, as most are unique, so an identical type which is
+// a different `Type *` is just a miss
+u64 poly_proc_cache_hash(Entity *base_entity, bool no_polymorphic_errors, Type *dst, Array<Operand> *operands) {
+	u64 h = gb_fnv64a(&base_entity, gb_size_of(base_entity));
+	h = (h ^ no_polymorphic_errors) * 0x100000001b3ull;
+	isize count = poly_proc_cache_operand_count(dst, operands);
+	for (isize i = 0; i < count; i++) {
+		PolyProcCacheOperand o = poly_proc_cache_operand(dst, operands, i);
+		h = (h ^ o.mode) * 0x100000001b3ull;
+		h = (h ^ cast(u64)cast(uintptr)o.type) * 0x100000001b3ull;
+	}
+	return h;
+}
+
+// The caller must hold the gen lock
+Entity *find_poly_proc_in_cache(CheckerInfo *info, u64 hash, Entity *base_entity, bool no_polymorphic_errors,
+                                Type *dst, Array<Operand> *operands) {
+	isize count = poly_proc_cache_operand_count(dst, operands);
+	auto *e = multi_map_find_first(&info->poly_proc_cache, hash_integer(hash));
+	for (; e != nullptr; e = multi_map_find_next(&info->poly_proc_cache, e)) {
+		PolyProcCacheEntry *entry = &e->value;
+		if (entry->base_entity != base_entity ||
+		    entry->no_polymorphic_errors != no_polymorphic_errors ||
+		    entry->operand_count != count) {
+			continue;
+		}
+		bool ok = true;
+		for (isize i = 0; ok && i < count; i++) {
+			PolyProcCacheOperand o = poly_proc_cache_operand(dst, operands, i);
+			PolyProcCacheOperand *p = &entry->operands[i];
+			ok = p->mode == o.mode && p->type == o.type;
+		}
+		if (ok) {
+			return entry->entity;
+		}
+	}
+	return nullptr;
+}
+
+// The caller must hold the gen lock
+void add_poly_proc_to_cache(CheckerInfo *info, u64 hash, Entity *base_entity, bool no_polymorphic_errors,
+                            Type *dst, Array<Operand> *operands, Entity *entity) {
+	if (find_poly_proc_in_cache(info, hash, base_entity, no_polymorphic_errors, dst, operands) != nullptr) {
+		return;
+	}
+	PolyProcCacheEntry entry = {};
+	entry.base_entity           = base_entity;
+	entry.no_polymorphic_errors = no_polymorphic_errors;
+	entry.operand_count         = poly_proc_cache_operand_count(dst, operands);
+	entry.operands              = gb_alloc_array(heap_allocator(), PolyProcCacheOperand, entry.operand_count);
+	entry.entity                = entity;
+	for (isize i = 0; i < entry.operand_count; i++) {
+		entry.operands[i] = poly_proc_cache_operand(dst, operands, i);
+	}
+	multi_map_insert(&info->poly_proc_cache, hash_integer(hash), entry);
+}
+
 bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Type *type,
                                             Array<Operand> *param_operands, PolyProcData *poly_proc_data) {
 	///////////////////////////////////////////////////////////////////////////////
@@ -218,11 +299,26 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 	}
 
 
-	DeclInfo *old_decl = decl_info_of_entity(&c->info, base_entity);
+	DeclInfo *old_decl = decl_info_of_entity(c->info, base_entity);
 	if (old_decl == nullptr) {
 		return false;
 	}
 
+	// Whether the procedure type can be made from the operands depends on whether the
+	// polymorphic errors are reported, so that is part of the key too
+	bool no_polymorphic_errors = c->context.no_polymorphic_errors;
+	u64 cache_hash = poly_proc_cache_hash(base_entity, no_polymorphic_errors, dst, param_operands);
+	{
+		checker_lock_gen(c->info);
+		Entity *cached = find_poly_proc_in_cache(c->info, cache_hash, base_entity, no_polymorphic_errors, dst, param_operands);
+		checker_unlock_gen(c->info);
+		if (cached != nullptr) {
+			if (poly_proc_data) {
+				poly_proc_data->gen_entity = cached;
+			}
+			return true;
+		}
+	}
 
 
 	gbAllocator a = heap_allocator();
@@ -249,7 +345,10 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 	CheckerContext prev_context = c->context;
 	defer (c->context = prev_context);
 
+	// The parent scope may be shared with the other worker threads
+	checker_lock_gen(c->info);
 	Scope *scope = create_scope(base_entity->scope, a);
+	checker_unlock_gen(c->info);
 	scope->is_proc = true;
 	c->context.scope = scope;
 	c->context.allow_polymorphic_types = true;
@@ -275,14 +374,18 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 	}
 
 
+	// Hold the lock from the lookup until the specialization has been added
+	checker_lock_gen(c->info);
+	defer (checker_unlock_gen(c->info));
 
-	auto *found_gen_procs = map_get(&c->info.gen_procs, hash_pointer(base_entity->identifier));
+	auto *found_gen_procs = map_get(&c->info->gen_procs, hash_pointer(base_entity->identifier));
 	if (found_gen_procs) {
 		auto procs = *found_gen_procs;
 		for_array(i, procs) {
 			Entity *other = procs[i];
 			Type *pt = base_type(other->type);
 			if (are_types_identical(pt, final_proc_type)) {
+				add_poly_proc_to_cache(c->info, cache_hash, base_entity, no_polymorphic_errors, dst, param_operands, other);
 				if (poly_proc_data) {
 					poly_proc_data->gen_entity = other;
 				}
@@ -291,8 +394,10 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 		}
 	}
 
-
 	if (generate_type_again) {
+		CheckerJob *probe = checker_begin_specialization_probe();
+		defer (checker_end_specialization(probe));
+
 		// LEAK TODO(bill): This is technically a memory leak as it has to generate the type twice
 		bool prev_no_polymorphic_errors = c->context.no_polymorphic_errors;
 		defer (c->context.no_polymorphic_errors = prev_no_polymorphic_errors);
@@ -308,12 +413,14 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 		}
 
 
+		found_gen_procs = map_get(&c->info->gen_procs, hash_pointer(base_entity->identifier));
 		if (found_gen_procs) {
 			auto procs = *found_gen_procs;
 			for_array(i, procs) {
 				Entity *other = procs[i];
 				Type *pt = base_type(other->type);
 				if (are_types_identical(pt, final_proc_type)) {
+					add_poly_proc_to_cache(c->info, cache_hash, base_entity, no_polymorphic_errors, dst, param_operands, other);
 					if (poly_proc_data) {
 						poly_proc_data->gen_entity = other;
 					}
@@ -324,6 +431,11 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 	}
 
 
+	gbString type_str = type_to_string(final_proc_type);
+	CheckerJob *job = checker_begin_specialization(base_entity, make_string_c(type_str));
+	gb_string_free(type_str);
+	defer (checker_end_specialization(job));
+
 	AstNode *proc_lit = clone_ast_node(a, old_decl->proc_lit);
 	ast_node(pl, ProcLit, proc_lit);
 	// NOTE(bill): Associate the scope declared above withinth this procedure declaration's type
@@ -361,20 +473,23 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 	proc_info.token = token;
 	proc_info.decl  = d;
 	proc_info.type  = final_proc_type;
-	proc_info.body  = pl->body;
+	proc_info.body  = ast_proc_lit_body(proc_lit);
 	proc_info.tags  = tags;
 	proc_info.generated_from_polymorphic = true;
 
+	// Checking the procedure type may have added to the map
+	found_gen_procs = map_get(&c->info->gen_procs, hash_pointer(base_entity->identifier));
 	if (found_gen_procs) {
 		array_add(found_gen_procs, entity);
 	} else {
 		Array<Entity *> array = {};
 		array_init(&array, heap_allocator());
 		array_add(&array, entity);
-		map_set(&c->info.gen_procs, hash_pointer(base_entity->identifier), array);
+		map_set(&c->info->gen_procs, hash_pointer(base_entity->identifier), array);
 	}
 
 	GB_ASSERT(entity != nullptr);
+	add_poly_proc_to_cache(c->info, cache_hash, base_entity, no_polymorphic_errors, dst, param_operands, entity);
 
 	if (poly_proc_data) {
 		poly_proc_data->gen_entity = entity;
@@ -382,14 +497,18 @@ bool find_or_generate_polymorphic_procedure(Checker *c, Entity *base_entity, Typ
 	}
 
 	// NOTE(bill): Check the newly generated procedure body
-	check_procedure_later(c, proc_info);
+	if (job != nullptr) {
+		job->proc = proc_info;
+	} else {
+		check_procedure_later(c, proc_info);
+	}
 
 	return true;
 }
 
 bool check_polymorphic_procedure_assignment(Checker *c, Operand *operand, Type *type, PolyProcData *poly_proc_data) {
 	if (operand->expr == nullptr) return false;
-	Entity *base_entity = entity_of_ident(&c->info, operand->expr);
+	Entity *base_entity = entity_of_ident(c->info, operand->expr);
 	if (base_entity == nullptr) return false;
 	return find_or_generate_polymorphic_procedure(c, base_entity, type, nullptr, poly_proc_data);
 }
@@ -890,7 +1009,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 	o->expr = n;
 	String name = n->Ident.token.string;
 
-	Entity *e = scope_lookup_entity(c->context.scope, name);
+	Entity *e = scope_lookup_entity(c->context.scope, n->Ident.atom);
 	if (e == nullptr) {
 		if (is_blank_ident(name)) {
 			error(n, "`_` cannot be used as a value type");
@@ -925,7 +1044,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 		is_alias = true;
 	}
 
-	HashKey key = hash_string(e->token.string);
+	HashKey key = hash_atom(e->atom);
 
 
 	if (e->kind == Entity_Procedure) {
@@ -984,7 +1103,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 		// return nullptr;
 	}
 
-	e->flags |= EntityFlag_Used;
+	entity_set_used(e);
 
 	Type *type = e->type;
 	switch (e->kind) {
@@ -1001,7 +1120,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 		break;
 
 	case Entity_Variable:
-		e->flags |= EntityFlag_Used;
+		entity_set_used(e);
 		if (type == t_invalid) {
 			o->type = t_invalid;
 			return e;
@@ -1338,7 +1457,7 @@ bool check_is_expr_vector_index(Checker *c, AstNode *expr) {
 	expr = unparen_expr(expr);
 	if (expr->kind == AstNode_IndexExpr) {
 		ast_node(ie, IndexExpr, expr);
-		Type *t = type_deref(type_of_expr(&c->info, ie->expr));
+		Type *t = type_deref(type_of_expr(c->info, ie->expr));
 		if (t != nullptr) {
 			return is_type_vector(t);
 		}
@@ -1351,7 +1470,7 @@ bool check_is_vector_elem(Checker *c, AstNode *expr) {
 	expr = unparen_expr(expr);
 	if (expr->kind == AstNode_SelectorExpr) {
 		ast_node(se, SelectorExpr, expr);
-		Type *t = type_deref(type_of_expr(&c->info, se->expr));
+		Type *t = type_deref(type_of_expr(c->info, se->expr));
 		if (t != nullptr && is_type_vector(t)) {
 			return true;
 		}
@@ -1598,9 +1717,10 @@ void check_shift(Checker *c, Operand *x, Operand *y, AstNode *node) {
 
 		TokenPos pos = ast_node_token(x->expr).pos;
 		if (x_is_untyped) {
-			ExprInfo *info = check_get_expr_info(&c->info, x->expr);
-			if (info != nullptr) {
-				info->is_lhs = true;
+			ExprInfo info = {};
+			if (check_get_expr_info(c->info, x->expr, &info)) {
+				info.is_lhs = true;
+				check_set_expr_info(c->info, x->expr, info);
 			}
 			x->mode = Addressing_Value;
 			// x->value = x_val;
@@ -2071,11 +2191,10 @@ void check_binary_expr(Checker *c, Operand *x, AstNode *node) {
 
 
 void update_expr_type(Checker *c, AstNode *e, Type *type, bool final) {
-	ExprInfo *found = check_get_expr_info(&c->info, e);
-	if (found == nullptr) {
+	ExprInfo old = {};
+	if (!check_get_expr_info(c->info, e, &old)) {
 		return;
 	}
-	ExprInfo old = *found;
 
 	switch (e->kind) {
 	case_ast_node(ue, UnaryExpr, e);
@@ -2110,12 +2229,12 @@ void update_expr_type(Checker *c, AstNode *e, Type *type, bool final) {
 
 	if (!final && is_type_untyped(type)) {
 		old.type = base_type(type);
-		check_set_expr_info(&c->info, e, old);
+		check_set_expr_info(c->info, e, old);
 		return;
 	}
 
 	// We need to remove it and then give it a new one
-	check_remove_expr_info(&c->info, e);
+	check_remove_expr_info(c->info, e);
 
 	if (old.is_lhs && !is_type_integer(type)) {
 		gbString expr_str = expr_to_string(e);
@@ -2126,13 +2245,14 @@ void update_expr_type(Checker *c, AstNode *e, Type *type, bool final) {
 		return;
 	}
 
-	add_type_and_value(&c->info, e, old.mode, type, old.value);
+	add_type_and_value(c->info, e, old.mode, type, old.value);
 }
 
 void update_expr_value(Checker *c, AstNode *e, ExactValue value) {
-	ExprInfo *found = check_get_expr_info(&c->info, e);
-	if (found) {
-		found->value = value;
+	ExprInfo found = {};
+	if (check_get_expr_info(c->info, e, &found)) {
+		found.value = value;
+		check_set_expr_info(c->info, e, found);
 	}
 }
 
@@ -2305,21 +2425,21 @@ void convert_to_typed(Checker *c, Operand *operand, Type *target_type, i32 level
 				operand->mode = Addressing_Invalid;
 				convert_untyped_error(c, operand, target_type);
 
-				gb_printf_err("Ambiguous type conversion to `%s`, which variant did you mean:\n\t", type_str);
+				error_out("Ambiguous type conversion to `%s`, which variant did you mean:\n\t", type_str);
 				i32 j = 0;
 				for (i32 i = 0; i < valid_count; i++) {
 					ValidIndexAndScore valid = valids[i];
-					if (j > 0 && valid_count > 2) gb_printf_err(", ");
+					if (j > 0 && valid_count > 2) error_out(", ");
 					if (j == valid_count-1) {
-						if (valid_count == 2) gb_printf_err(" ");
-						gb_printf_err("or ");
+						if (valid_count == 2) error_out(" ");
+						error_out("or ");
 					}
 					gbString str = type_to_string(t->Union.variants[valid.index]);
-					gb_printf_err("`%s`", str);
+					error_out("`%s`", str);
 					gb_string_free(str);
 					j++;
 				}
-				gb_printf_err("\n\n");
+				error_out("\n\n");
 
 				return;
 			} else if (is_type_untyped_undef(operand->type) && type_has_undef(target_type)) {
@@ -2328,20 +2448,20 @@ void convert_to_typed(Checker *c, Operand *operand, Type *target_type, i32 level
 				operand->mode = Addressing_Invalid;
 				convert_untyped_error(c, operand, target_type);
 				if (count > 0) {
-					gb_printf_err("`%s` is a union which only excepts the following types:\n", type_str);
-					gb_printf_err("\t");
+					error_out("`%s` is a union which only excepts the following types:\n", type_str);
+					error_out("\t");
 					for (i32 i = 0; i < count; i++) {
 						Type *v = t->Union.variants[i];
-						if (i > 0 && count > 2) gb_printf_err(", ");
+						if (i > 0 && count > 2) error_out(", ");
 						if (i == count-1) {
-							if (count == 2) gb_printf_err(" ");
-							gb_printf_err("or ");
+							if (count == 2) error_out(" ");
+							error_out("or ");
 						}
 						gbString str = type_to_string(v);
-						gb_printf_err("`%s`", str);
+						error_out("`%s`", str);
 						gb_string_free(str);
 					}
-					gb_printf_err("\n\n");
+					error_out("\n\n");
 
 				}
 				return;
@@ -2425,14 +2545,14 @@ bool check_index_value(Checker *c, bool open_range, AstNode *index_value, i64 ma
 	return true;
 }
 
-isize entity_overload_count(Scope *s, String name) {
+isize entity_overload_count(Scope *s, Atom *name) {
 	Entity *e = scope_lookup_entity(s, name);
 	if (e == nullptr) {
 		return 0;
 	}
 	if (e->kind == Entity_Procedure) {
 		// NOTE(bill): Overloads are only allowed with the same scope
-		return multi_map_count(&s->elements, hash_string(e->token.string));
+		return multi_map_count(&s->elements, hash_atom(e->atom));
 	}
 	return 1;
 }
@@ -2486,7 +2606,7 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 
 	if (op_expr->kind == AstNode_Ident) {
 		String op_name = op_expr->Ident.token.string;
-		Entity *e = scope_lookup_entity(c->context.scope, op_name);
+		Entity *e = scope_lookup_entity(c->context.scope, op_expr->Ident.atom);
 
 		bool is_alias = false;
 		while (e != nullptr && e->kind == Entity_Alias) {
@@ -2506,9 +2626,10 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 			String import_name = op_name;
 			Scope *import_scope = e->ImportName.scope;
 			String entity_name = selector->Ident.token.string;
+			Atom *entity_atom = selector->Ident.atom;
 
 			check_op_expr = false;
-			entity = scope_lookup_entity(import_scope, entity_name);
+			entity = scope_lookup_entity(import_scope, entity_atom);
 			bool is_declared = entity != nullptr;
 			if (is_declared) {
 				if (entity->kind == Entity_Builtin) {
@@ -2541,9 +2662,10 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 				// TODO(bill): Which scope do you search for for an alias?
 				// import_scope = entity->scope;
 				entity_name = entity->token.string;
+				entity_atom = entity->atom;
 			}
 
-			isize overload_count = entity_overload_count(import_scope, entity_name);
+			isize overload_count = entity_overload_count(import_scope, entity_atom);
 			bool is_overloaded = overload_count > 1;
 
 			bool implicit_is_found = is_entity_implicitly_imported(e, entity);
@@ -2556,7 +2678,7 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 
 
 			if (is_overloaded) {
-				HashKey key = hash_string(entity_name);
+				HashKey key = hash_atom(entity_atom);
 				bool skip = false;
 
 				Entity **procs = gb_alloc_array(heap_allocator(), Entity *, overload_count);
@@ -3945,7 +4067,7 @@ isize add_dependencies_from_unpacking(Checker *c, Entity **lhs, isize lhs_count,
 	if (lhs != nullptr) {
 		for (isize j = 0; tuple_index < lhs_count && j < tuple_count; j++) {
 			Entity *e = lhs[tuple_index + j];
-			DeclInfo *decl = decl_info_of_entity(&c->info, e);
+			DeclInfo *decl = decl_info_of_entity(c->info, e);
 			if (decl != nullptr) {
 				c->context.decl = decl; // will be reset by the `defer` any way
 				for_array(k, decl->deps.entries) {
@@ -3970,7 +4092,7 @@ void check_unpack_arguments(Checker *c, Entity **lhs, isize lhs_count, Array<Ope
 
 		if (lhs != nullptr && tuple_index < lhs_count) {
 			// NOTE(bill): override DeclInfo for dependency
-			DeclInfo *decl = decl_info_of_entity(&c->info, lhs[tuple_index]);
+			DeclInfo *decl = decl_info_of_entity(c->info, lhs[tuple_index]);
 			if (decl) c->context.decl = decl;
 		}
 
@@ -3985,7 +4107,7 @@ void check_unpack_arguments(Checker *c, Entity **lhs, isize lhs_count, Array<Ope
 			if (allow_ok && lhs_count == 2 && rhs.count == 1 &&
 			    (o.mode == Addressing_MapIndex || o.mode == Addressing_OptionalOk)) {
 				Type *tuple = make_optional_ok_type(c->allocator, o.type);
-				add_type_and_value(&c->info, o.expr, o.mode, tuple, o.value);
+				add_type_and_value(c->info, o.expr, o.mode, tuple, o.value);
 
 				Operand val = o;
 				Operand ok = o;
@@ -4381,6 +4503,155 @@ CALL_ARGUMENT_CHECKER(check_named_call_arguments) {
 }
 
 
+u64 overload_cache_hash_value(ExactValue v) {
+	u64 h = (0xcbf29ce484222325ull ^ v.kind) * 0x100000001b3ull;
+	switch (v.kind) {
+	case ExactValue_Bool:     return (h ^ v.value_bool) * 0x100000001b3ull;
+	case ExactValue_String:   return h ^ gb_fnv64a(v.value_string.text, v.value_string.len);
+	case ExactValue_Integer:  return h ^ gb_fnv64a(&v.value_integer, gb_size_of(v.value_integer));
+	case ExactValue_Float:    return h ^ gb_fnv64a(&v.value_float,   gb_size_of(v.value_float));
+	case ExactValue_Complex:  return h ^ gb_fnv64a(&v.value_complex, gb_size_of(v.value_complex));
+	case ExactValue_Pointer:  return h ^ gb_fnv64a(&v.value_pointer, gb_size_of(v.value_pointer));
+	}
+	return h;
+}
+
+bool overload_cache_values_equal(ExactValue x, ExactValue y) {
+	if (x.kind != y.kind) {
+		return false;
+	}
+	switch (x.kind) {
+	case ExactValue_Invalid:  return true;
+	case ExactValue_Bool:     return x.value_bool    == y.value_bool;
+	case ExactValue_String:   return x.value_string  == y.value_string;
+	case ExactValue_Integer:  return x.value_integer == y.value_integer;
+	case ExactValue_Float:    return gb_memcompare(&x.value_float,   &y.value_float,   gb_size_of(x.value_float))   == 0;
+	case ExactValue_Complex:  return gb_memcompare(&x.value_complex, &y.value_complex, gb_size_of(x.value_complex)) == 0;
+	case ExactValue_Pointer:  return x.value_pointer == y.value_pointer;
+	}
+	return false;
+}
+
+OverloadCacheOperand overload_cache_operand(Operand *o) {
+	OverloadCacheOperand co = {};
+	co.mode = o->mode;
+	co.type = o->type;
+	if (o->mode == Addressing_Constant && is_type_untyped(o->type)) {
+		co.value = o->value;
+	}
+	return co;
+}
+
+// Choosing an overload is only cached when it has no side effects other than adding
+// type infos. Checking a polymorphic overload, or passing a procedure which may be polymorphic,
+// can generate a specialization. The names of named arguments are not part of the key
+bool is_overload_call_cacheable(AstNodeCallExpr *ce, Entity **procs, isize proc_count, Array<Operand> operands) {
+	if (is_call_expr_field_value(ce)) {
+		return false;
+	}
+	for (isize i = 0; i < proc_count; i++) {
+		Type *pt = base_type(procs[i]->type);
+		if (pt == nullptr || pt->kind != Type_Proc || pt->Proc.is_polymorphic) {
+			return false;
+		}
+	}
+	for_array(i, operands) {
+		Operand *o = &operands[i];
+		if (o->mode == Addressing_Overload || o->mode == Addressing_Builtin || o->mode == Addressing_Invalid) {
+			return false;
+		}
+		if (o->type == nullptr || is_type_proc(o->type)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+u64 overload_cache_hash(Entity **procs, isize proc_count, Array<Operand> operands, bool vari_expand) {
+	u64 h = gb_fnv64a(procs, proc_count*gb_size_of(Entity *));
+	h = (h ^ vari_expand) * 0x100000001b3ull;
+	for_array(i, operands) {
+		OverloadCacheOperand o = overload_cache_operand(&operands[i]);
+		h = (h ^ o.mode) * 0x100000001b3ull;
+		h = (h ^ cast(u64)cast(uintptr)o.type) * 0x100000001b3ull;
+		if (o.value.kind != ExactValue_Invalid) {
+			h = (h ^ overload_cache_hash_value(o.value)) * 0x100000001b3ull;
+		}
+	}
+	return h;
+}
+
+// The caller must hold the overload lock
+OverloadCacheEntry *find_overload_in_cache(CheckerInfo *info, u64 hash, Entity **procs, isize proc_count,
+                                           Array<Operand> operands, bool vari_expand) {
+	auto *e = multi_map_find_first(&info->overload_cache, hash_integer(hash));
+	for (; e != nullptr; e = multi_map_find_next(&info->overload_cache, e)) {
+		OverloadCacheEntry *entry = &e->value;
+		if (entry->proc_count    != proc_count ||
+		    entry->operand_count != operands.count ||
+		    entry->vari_expand   != vari_expand) {
+			continue;
+		}
+		if (gb_memcompare(entry->procs, procs, proc_count*gb_size_of(Entity *)) != 0) {
+			continue;
+		}
+		bool ok = true;
+		for (isize i = 0; ok && i < operands.count; i++) {
+			OverloadCacheOperand o = overload_cache_operand(&operands[i]);
+			OverloadCacheOperand *p = &entry->operands[i];
+			ok = p->mode == o.mode && p->type == o.type && overload_cache_values_equal(p->value, o.value);
+		}
+		if (ok) {
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+void add_overload_to_cache(CheckerInfo *info, u64 hash, Entity **procs, isize proc_count, Array<Operand> operands,
+                           bool vari_expand, isize index, Array<Type *> type_infos) {
+	gbAllocator a = heap_allocator();
+	checker_lock_overloads(info);
+	defer (checker_unlock_overloads(info));
+	if (find_overload_in_cache(info, hash, procs, proc_count, operands, vari_expand) != nullptr) {
+		return;
+	}
+
+	OverloadCacheEntry entry = {};
+	entry.procs           = gb_alloc_array(a, Entity *, proc_count);
+	entry.proc_count      = proc_count;
+	entry.operands        = gb_alloc_array(a, OverloadCacheOperand, operands.count);
+	entry.operand_count   = operands.count;
+	entry.vari_expand     = vari_expand;
+	entry.index           = index;
+	entry.type_infos      = gb_alloc_array(a, Type *, type_infos.count);
+	entry.type_info_count = type_infos.count;
+	gb_memmove(entry.procs, procs, proc_count*gb_size_of(Entity *));
+	for_array(i, operands) {
+		entry.operands[i] = overload_cache_operand(&operands[i]);
+	}
+	gb_memmove(entry.type_infos, type_infos.data, type_infos.count*gb_size_of(Type *));
+	multi_map_insert(&info->overload_cache, hash_integer(hash), entry);
+}
+
+CallArgumentData check_call_arguments_with_overload(Checker *c, Operand *operand, Entity *e, CallArgumentCheckerType *call_checker,
+                                                    Array<Operand> operands, AstNode *call) {
+	AstNode *ident = operand->expr;
+	while (ident->kind == AstNode_SelectorExpr) {
+		AstNode *s = ident->SelectorExpr.selector;
+		ident = s;
+	}
+
+	CallArgumentData data = {};
+	CallArgumentError err = call_checker(c, call, e->type, e, operands, CallArgumentMode_ShowErrors, &data);
+	if (data.gen_entity != nullptr) {
+		add_entity_use(c, ident, data.gen_entity);
+	} else {
+		add_entity_use(c, ident, e);
+	}
+	return data;
+}
+
 CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_type, AstNode *call) {
 	ast_node(ce, CallExpr, call);
 
@@ -4415,7 +4686,7 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 		          operand->overload_count > 0);
 		isize               overload_count = operand->overload_count;
 		Entity **           procs          = operand->overload_entities;
-		ValidIndexAndScore *valids         = gb_alloc_array(heap_allocator(), ValidIndexAndScore, overload_count);
+		ValidIndexAndScore *valids         = nullptr;
 		isize               valid_count    = 0;
 
 		defer (gb_free(heap_allocator(), procs));
@@ -4423,10 +4694,42 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 
 		String name = procs[0]->token.string;
 
+		bool vari_expand = (ce->ellipsis.pos.line != 0);
+		bool is_cacheable = is_overload_call_cacheable(ce, procs, overload_count, operands);
+		u64 cache_hash = 0;
+		if (is_cacheable) {
+			cache_hash = overload_cache_hash(procs, overload_count, operands, vari_expand);
+
+			isize index = -1;
+			checker_lock_overloads(c->info);
+			OverloadCacheEntry *entry = find_overload_in_cache(c->info, cache_hash, procs, overload_count, operands, vari_expand);
+			if (entry != nullptr) {
+				index = entry->index;
+				for (isize i = 0; i < entry->type_info_count; i++) {
+					add_type_info_type(c, entry->type_infos[i]);
+				}
+			}
+			checker_unlock_overloads(c->info);
+
+			if (index >= 0) {
+				return check_call_arguments_with_overload(c, operand, procs[index], call_checker, operands, call);
+			}
+		}
+
+		Array<Type *> type_info_log = {};
+		Array<Type *> *prev_type_info_log = checker_type_info_log;
+		if (is_cacheable) {
+			array_init(&type_info_log, heap_allocator());
+			checker_type_info_log = &type_info_log;
+		}
+		defer (array_free(&type_info_log));
+
+		valids = gb_alloc_array(heap_allocator(), ValidIndexAndScore, overload_count);
+
 		for (isize i = 0; i < overload_count; i++) {
 			Entity *e = procs[i];
 			GB_ASSERT(e->token.string == name);
-			DeclInfo *d = decl_info_of_entity(&c->info, e);
+			DeclInfo *d = decl_info_of_entity(c->info, e);
 			GB_ASSERT(d != nullptr);
 			check_entity_decl(c, e, d, nullptr);
 		}
@@ -4450,6 +4753,12 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 				}
 			}
 		}
+		checker_type_info_log = prev_type_info_log;
+		if (prev_type_info_log != nullptr) {
+			for_array(i, type_info_log) {
+				array_add(prev_type_info_log, type_info_log[i]);
+			}
+		}
 
 		if (valid_count > 1) {
 			gb_sort_array(valids, valid_count, valid_index_and_score_cmp);
@@ -4471,18 +4780,18 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 
 		if (valid_count == 0) {
 			error(operand->expr, "No overloads or ambiguous call for `%.*s` that match with the given arguments", LIT(name));
-			gb_printf_err("\tGiven argument types -> (");
+			error_out("\tGiven argument types -> (");
 			for_array(i, operands) {
 				Operand o = operands[i];
-				if (i > 0) gb_printf_err(", ");
+				if (i > 0) error_out(", ");
 				gbString type = type_to_string(o.type);
 				defer (gb_string_free(type));
-				gb_printf_err("%s", type);
+				error_out("%s", type);
 			}
-			gb_printf_err(")\n");
+			error_out(")\n");
 
 			if (overload_count > 0) {
-				gb_printf_err("Did you mean to use one of the following:\n");
+				error_out("Did you mean to use one of the following:\n");
 			}
 			for (isize i = 0; i < overload_count; i++) {
 				Entity *proc = procs[i];
@@ -4496,25 +4805,25 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 				} else {
 					pt = type_to_string(t);
 				}
-				gb_printf_err("\t%.*s :: %s at %.*s(%td:%td) with score %lld\n", LIT(name), pt, LIT(pos.file), pos.line, pos.column, cast(long long)valids[i].score);
-				// gb_printf_err("\t%.*s :: %s at %.*s(%td:%td)\n", LIT(name), pt, LIT(pos.file), pos.line, pos.column);
+				error_out("\t%.*s :: %s at %.*s(%d:%d) with score %lld\n", LIT(name), pt, LIT(token_pos_file(pos)), pos.line, pos.column, cast(long long)valids[i].score);
+				// gb_printf_err("\t%.*s :: %s at %.*s(%d:%d)\n", LIT(name), pt, LIT(token_pos_file(pos)), pos.line, pos.column);
 				gb_string_free(pt);
 			}
 			if (overload_count > 0) {
-				gb_printf_err("\n");
+				error_out("\n");
 			}
 			result_type = t_invalid;
 		} else if (valid_count > 1) {
 			error(operand->expr, "Ambiguous procedure call `%.*s` tha match with the given arguments", LIT(name));
-			gb_printf_err("\tGiven argument types -> (");
+			error_out("\tGiven argument types -> (");
 			for_array(i, operands) {
 				Operand o = operands[i];
-				if (i > 0) gb_printf_err(", ");
+				if (i > 0) error_out(", ");
 				gbString type = type_to_string(o.type);
 				defer (gb_string_free(type));
-				gb_printf_err("%s", type);
+				error_out("%s", type);
 			}
-			gb_printf_err(")\n");
+			error_out(")\n");
 
 			for (isize i = 0; i < valid_count; i++) {
 				Entity *proc = procs[valids[i].index];
@@ -4526,29 +4835,17 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 				} else {
 					pt = type_to_string(t);
 				}
-				// gb_printf_err("\t%.*s :: %s at %.*s(%td:%td) with score %lld\n", LIT(name), pt, LIT(pos.file), pos.line, pos.column, cast(long long)valids[i].score);
-				gb_printf_err("\t%.*s :: %s at %.*s(%td:%td)\n", LIT(name), pt, LIT(pos.file), pos.line, pos.column);
+				// gb_printf_err("\t%.*s :: %s at %.*s(%d:%d) with score %lld\n", LIT(name), pt, LIT(token_pos_file(pos)), pos.line, pos.column, cast(long long)valids[i].score);
+				error_out("\t%.*s :: %s at %.*s(%d:%d)\n", LIT(name), pt, LIT(token_pos_file(pos)), pos.line, pos.column);
 				gb_string_free(pt);
 			}
 			result_type = t_invalid;
 		} else {
-			AstNode *ident = operand->expr;
-			while (ident->kind == AstNode_SelectorExpr) {
-				AstNode *s = ident->SelectorExpr.selector;
-				ident = s;
+			if (is_cacheable) {
+				add_overload_to_cache(c->info, cache_hash, procs, overload_count, operands, vari_expand,
+				                      valids[0].index, type_info_log);
 			}
-
-			Entity *e = procs[valids[0].index];
-
-			proc_type = e->type;
-			CallArgumentData data = {};
-			CallArgumentError err = call_checker(c, call, proc_type, e, operands, CallArgumentMode_ShowErrors, &data);
-			if (data.gen_entity != nullptr) {
-				add_entity_use(c, ident, data.gen_entity);
-			} else {
-				add_entity_use(c, ident, e);
-			}
-			return data;
+			return check_call_arguments_with_overload(c, operand, procs[valids[0].index], call_checker, operands, call);
 		}
 	} else {
 		AstNode *ident = operand->expr;
@@ -4557,7 +4854,7 @@ CallArgumentData check_call_arguments(Checker *c, Operand *operand, Type *proc_t
 			ident = s;
 		}
 
-		Entity *e = entity_of_ident(&c->info, ident);
+		Entity *e = entity_of_ident(c->info, ident);
 		CallArgumentData data = {};
 		CallArgumentError err = call_checker(c, call, proc_type, e, operands, CallArgumentMode_ShowErrors, &data);
 		if (data.gen_entity != nullptr) {
@@ -4777,14 +5074,40 @@ CallArgumentError check_polymorphic_struct_type(Checker *c, Operand *operand, As
 		// TODO(bill): Check for previous types
 		gbAllocator a = c->allocator;
 
+		// Hold the lock from the lookup until the specialization has been added
+		checker_lock_gen(c->info);
+		defer (checker_unlock_gen(c->info));
+
+		String call_name = make_string_c(expr_to_string(call));
+
 		Entity *found_entity = find_polymorphic_struct_entity(c, original_type, param_count, ordered_operands);
 		if (found_entity) {
+			checker_use_poly_struct(c, found_entity, call_name);
 			operand->mode = Addressing_Type;
 			operand->type = found_entity->type;
 			return err;
 		}
 
-		String generated_name = make_string_c(expr_to_string(call));
+		String generated_name = call_name;
+		CheckerJob *job = nullptr;
+		if (checker_curr_job != nullptr) {
+			// Renamed after the call with the smallest job key once the jobs are merged
+			generated_name = make_polymorphic_struct_canonical_name(original_type, param_count, ordered_operands);
+			bool is_polymorphic = false;
+			for_array(i, ordered_operands) {
+				Operand o = ordered_operands[i];
+				if (o.mode == Addressing_Type && is_type_polymorphic(o.type)) {
+					is_polymorphic = true;
+				}
+			}
+			if (is_polymorphic) {
+				job = checker_begin_unique_specialization();
+			} else {
+				Entity *base_entity = original_type->kind == Type_Named ? original_type->Named.type_name : nullptr;
+				job = checker_begin_specialization(base_entity, generated_name);
+			}
+		}
+		defer (checker_end_specialization(job));
 
 		Type *named_type = make_type_named(a, generated_name, nullptr, nullptr);
 		AstNode *node = clone_ast_node(a, st->node);
@@ -4797,6 +5120,8 @@ CallArgumentError check_polymorphic_struct_type(Checker *c, Operand *operand, As
 		check_struct_type(c, struct_type, node, &ordered_operands, named_type, original_type);
 		check_close_scope(c);
 
+		checker_add_poly_struct(c, job, named_type->Named.type_name, call_name);
+
 		operand->mode = Addressing_Type;
 		operand->type = named_type;
 	}
@@ -4815,7 +5140,7 @@ ExprKind check_call_expr(Checker *c, Operand *operand, AstNode *call) {
 		operand->builtin_id = BuiltinProc_DIRECTIVE;
 		operand->expr = ce->proc;
 		operand->type = t_invalid;
-		add_type_and_value(&c->info, ce->proc, operand->mode, operand->type, operand->value);
+		add_type_and_value(c->info, ce->proc, operand->mode, operand->type, operand->value);
 	} else {
 		check_expr_or_type(c, operand, ce->proc);
 	}
@@ -4867,8 +5192,8 @@ ExprKind check_call_expr(Checker *c, Operand *operand, AstNode *call) {
 					AstNode *s = ident->SelectorExpr.selector;
 					ident = s;
 				}
-				add_entity_use(c, ident, entity_of_ident(&c->info, ident));
-				add_type_and_value(&c->info, call, Addressing_Type, operand->type, empty_exact_value);
+				add_entity_use(c, ident, entity_of_ident(c->info, ident));
+				add_type_and_value(c->info, call, Addressing_Type, operand->type, empty_exact_value);
 			} else {
 				operand->mode = Addressing_Invalid;
 				operand->type = t_invalid;
@@ -5135,7 +5460,7 @@ ExprKind check_expr_base_internal(Checker *c, Operand *o, AstNode *node, Type *t
 	case_ast_node(bd, BasicDirective, node);
 		if (bd->name == "file") {
 			o->type = t_untyped_string;
-			o->value = exact_value_string(bd->token.pos.file);
+			o->value = exact_value_string(token_pos_file(bd->token.pos));
 		} else if (bd->name == "line") {
 			o->type = t_untyped_integer;
 			o->value = exact_value_i64(bd->token.pos.line);
@@ -5183,12 +5508,12 @@ ExprKind check_expr_base_internal(Checker *c, Operand *o, AstNode *node, Type *t
 				return kind;
 			}
 
-			if (pl->body == nullptr) {
+			if (!ast_proc_lit_has_body(node)) {
 				error(node, "A procedure literal must have a body");
 				return kind;
 			}
 
-			check_procedure_later(c, c->curr_ast_file, empty_token, decl, type, pl->body, pl->tags);
+			check_procedure_later(c, c->curr_ast_file, empty_token, decl, type, ast_proc_lit_body(node), pl->tags);
 		}
 		check_close_scope(c);
 
@@ -5533,7 +5858,9 @@ ExprKind check_expr_base_internal(Checker *c, Operand *o, AstNode *node, Type *t
 			}
 
 			if (t->kind == Type_Array && is_to_be_determined_array_count) {
-				t->Array.count = max;
+				// Array types are interned so make a new one rather than set the count
+				type = make_type_array(c->allocator, t->Array.elem, max);
+				t = type;
 			}
 
 			break;
@@ -6096,9 +6423,9 @@ ExprKind check_expr_base(Checker *c, Operand *o, AstNode *node, Type *type_hint)
 	}
 
 	if (type != nullptr && is_type_untyped(type)) {
-		add_untyped(&c->info, node, false, o->mode, type, value);
+		add_untyped(c->info, node, false, o->mode, type, value);
 	} else {
-		add_type_and_value(&c->info, node, o->mode, type, value);
+		add_type_and_value(c->info, node, o->mode, type, value);
 	}
 	return kind;
 }
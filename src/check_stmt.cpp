@@ -191,7 +191,7 @@ Type *check_assignment_variable(Checker *c, Operand *rhs, AstNode *lhs_node) {
 
 	// NOTE(bill): Ignore assignments to `_`
 	if (is_blank_ident(node)) {
-		add_entity_definition(&c->info, node, nullptr);
+		add_entity_definition(c->info, node, nullptr);
 		check_assignment(c, rhs, nullptr, str_lit("assignment to `_` identifier"));
 		if (rhs->mode == Addressing_Invalid) {
 			return nullptr;
@@ -241,7 +241,7 @@ Type *check_assignment_variable(Checker *c, Operand *rhs, AstNode *lhs_node) {
 	} else {
 		if (node->kind == AstNode_Ident) {
 			ast_node(i, Ident, node);
-			e = scope_lookup_entity(c->context.scope, i->token.string);
+			e = scope_lookup_entity(c->context.scope, i->atom);
 			if (e != nullptr && e->kind == Entity_Variable) {
 				used = (e->flags & EntityFlag_Used) != 0; // TODO(bill): Make backup just in case
 			}
@@ -250,7 +250,7 @@ Type *check_assignment_variable(Checker *c, Operand *rhs, AstNode *lhs_node) {
 	}
 
 	if (e != nullptr && used) {
-		e->flags |= EntityFlag_Used;
+		entity_set_used(e);
 	}
 
 	Type *assignment_type = lhs.type;
@@ -298,7 +298,7 @@ Type *check_assignment_variable(Checker *c, Operand *rhs, AstNode *lhs_node) {
 		AstNode *ln = unparen_expr(lhs_node);
 		if (ln->kind == AstNode_IndexExpr) {
 			AstNode *x = ln->IndexExpr.expr;
-			TypeAndValue tav = type_and_value_of_expr(&c->info, x);
+			TypeAndValue tav = type_and_value_of_expr(c->info, x);
 			GB_ASSERT(tav.mode != Addressing_Invalid);
 			if (tav.mode != Addressing_Variable) {
 				if (!is_type_pointer(tav.type)) {
@@ -511,11 +511,11 @@ bool check_using_stmt_entity(Checker *c, AstNodeUsingStmt *us, AstNode *expr, bo
 				gbString expr_str = expr_to_string(expr);
 				error(us->token,
 				      "Namespace collision while `using` `%s` of: %.*s\n"
-				      "\tat %.*s(%td:%td)\n"
-				      "\tat %.*s(%td:%td)",
+				      "\tat %.*s(%d:%d)\n"
+				      "\tat %.*s(%d:%d)",
 				      expr_str, LIT(found->token.string),
-				      LIT(found->token.pos.file), found->token.pos.line, found->token.pos.column,
-				      LIT(decl->token.pos.file), decl->token.pos.line, decl->token.pos.column
+				      LIT(token_pos_file(found->token.pos)), found->token.pos.line, found->token.pos.column,
+				      LIT(token_pos_file(decl->token.pos)), decl->token.pos.line, decl->token.pos.column
 				      );
 				gb_string_free(expr_str);
 				return false;
@@ -529,7 +529,7 @@ bool check_using_stmt_entity(Checker *c, AstNodeUsingStmt *us, AstNode *expr, bo
 		Type *t = base_type(type_deref(e->type));
 		if (is_type_struct(t) || is_type_raw_union(t) || is_type_union(t)) {
 			// TODO(bill): Make it work for unions too
-			Scope *found = scope_of_node(&c->info, t->Struct.node);
+			Scope *found = scope_of_node(c->info, t->Struct.node);
 			for_array(i, found->elements.entries) {
 				Entity *f = found->elements.entries[i].value;
 				if (f->kind == Entity_Variable) {
@@ -608,7 +608,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 			}
 			if (operand.expr->kind == AstNode_CallExpr) {
 				AstNodeCallExpr *ce = &operand.expr->CallExpr;
-				Type *t = type_of_expr(&c->info, ce->proc);
+				Type *t = type_of_expr(c->info, ce->proc);
 				if (is_type_proc(t)) {
 					if (t->Proc.require_results) {
 						gbString expr_str = expr_to_string(ce->proc);
@@ -1060,8 +1060,8 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 			}
 
 
-			add_type_and_value(&c->info, ie->left,  x.mode, x.type, x.value);
-			add_type_and_value(&c->info, ie->right, y.mode, y.type, y.value);
+			add_type_and_value(c->info, ie->left,  x.mode, x.type, x.value);
+			add_type_and_value(c->info, ie->right, y.mode, y.type, y.value);
 			val = type;
 			idx = t_int;
 		} else {
@@ -1144,18 +1144,18 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 				Entity *found = nullptr;
 
 				if (!is_blank_ident(str)) {
-					found = current_scope_lookup_entity(c->context.scope, str);
+					found = current_scope_lookup_entity(c->context.scope, name->Ident.atom);
 				}
 				if (found == nullptr) {
 					bool is_immutable = true;
 					entity = make_entity_variable(c->allocator, c->context.scope, token, type, is_immutable);
-					add_entity_definition(&c->info, name, entity);
+					add_entity_definition(c->info, name, entity);
 				} else {
 					TokenPos pos = found->token.pos;
 					error(token,
 					      "Redeclaration of `%.*s` in this scope\n"
-					      "\tat %.*s(%td:%td)",
-					      LIT(str), LIT(pos.file), pos.line, pos.column);
+					      "\tat %.*s(%d:%d)",
+					      LIT(str), LIT(token_pos_file(pos)), pos.line, pos.column);
 					entity = found;
 				}
 			} else {
@@ -1204,7 +1204,10 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 			Token token  = {};
 			token.pos    = ast_node_token(ss->body).pos;
 			token.string = str_lit("true");
+			// The file's arena may be used by a lazy procedure body on another thread
+			gb_mutex_lock(&c->curr_ast_file->lazy_body_mutex);
 			x.expr       = ast_ident(c->curr_ast_file, token);
+			gb_mutex_unlock(&c->curr_ast_file->lazy_body_mutex);
 		}
 		if (is_type_vector(x.type)) {
 			gbString str = type_to_string(x.type);
@@ -1234,8 +1237,8 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					TokenPos pos = ast_node_token(first_default).pos;
 					error(stmt,
 					           "multiple `default` clauses\n"
-					           "\tfirst at %.*s(%td:%td)",
-					           LIT(pos.file), pos.line, pos.column);
+					           "\tfirst at %.*s(%d:%d)",
+					           LIT(token_pos_file(pos)), pos.line, pos.column);
 				} else {
 					first_default = default_stmt;
 				}
@@ -1353,9 +1356,9 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 									gbString expr_str = expr_to_string(y.expr);
 									error(y.expr,
 									           "Duplicate case `%s`\n"
-									           "\tprevious case at %.*s(%td:%td)",
+									           "\tprevious case at %.*s(%d:%d)",
 									           expr_str,
-									           LIT(pos.file), pos.line, pos.column);
+									           LIT(token_pos_file(pos)), pos.line, pos.column);
 									gb_string_free(expr_str);
 									continue_outer = true;
 									break;
@@ -1446,7 +1449,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					TokenPos pos = ast_node_token(first_default).pos;
 					error(stmt,
 					           "Multiple `default` clauses\n"
-					           "\tfirst at %.*s(%td:%td)", LIT(pos.file), pos.line, pos.column);
+					           "\tfirst at %.*s(%d:%d)", LIT(token_pos_file(pos)), pos.line, pos.column);
 				} else {
 					first_default = default_stmt;
 				}
@@ -1511,9 +1514,9 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 						gbString expr_str = expr_to_string(y.expr);
 						error(y.expr,
 						           "Duplicate type case `%s`\n"
-						           "\tprevious type case at %.*s(%td:%td)",
+						           "\tprevious type case at %.*s(%d:%d)",
 						           expr_str,
-						           LIT(pos.file), pos.line, pos.column);
+						           LIT(token_pos_file(pos)), pos.line, pos.column);
 						gb_string_free(expr_str);
 						break;
 					}
@@ -1705,7 +1708,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 				Entity *found = nullptr;
 				// NOTE(bill): Ignore assignments to `_`
 				if (!is_blank_ident(str)) {
-					found = current_scope_lookup_entity(c->context.scope, str);
+					found = current_scope_lookup_entity(c->context.scope, name->Ident.atom);
 				}
 				if (found == nullptr) {
 					entity = make_entity_variable(c->allocator, c->context.scope, token, nullptr, false);
@@ -1721,8 +1724,8 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					TokenPos pos = found->token.pos;
 					error(token,
 					      "Redeclaration of `%.*s` in this scope\n"
-					      "\tat %.*s(%td:%td)",
-					      LIT(str), LIT(pos.file), pos.line, pos.column);
+					      "\tat %.*s(%d:%d)",
+					      LIT(str), LIT(token_pos_file(pos)), pos.line, pos.column);
 					entity = found;
 				}
 			}
@@ -1777,7 +1780,9 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 				init_entity_foreign_library(c, e);
 
 				String name = e->token.string;
-				auto *fp = &c->info.foreigns;
+				checker_lock_foreigns(c->info);
+				defer (checker_unlock_foreigns(c->info));
+				auto *fp = &c->info->foreigns;
 				HashKey key = hash_string(name);
 				Entity **found = map_get(fp, key);
 				if (found) {
@@ -1788,8 +1793,8 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					if (!are_types_identical(this_type, other_type)) {
 						error(e->token,
 						      "Foreign entity `%.*s` previously declared elsewhere with a different type\n"
-						      "\tat %.*s(%td:%td)",
-						      LIT(name), LIT(pos.file), pos.line, pos.column);
+						      "\tat %.*s(%d:%d)",
+						      LIT(name), LIT(token_pos_file(pos)), pos.line, pos.column);
 					}
 				} else {
 					map_set(fp, key, e);
@@ -1818,7 +1823,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 				Type *t = base_type(type_deref(e->type));
 
 				if (is_type_struct(t) || is_type_raw_union(t)) {
-					Scope *scope = scope_of_node(&c->info, t->Struct.node);
+					Scope *scope = scope_of_node(c->info, t->Struct.node);
 					for_array(i, scope->elements.entries) {
 						Entity *f = scope->elements.entries[i].value;
 						if (f->kind == Entity_Variable) {
@@ -12,7 +12,7 @@ void populate_using_entity_map(Checker *c, AstNode *node, Type *t, Map<Entity *>
 			Entity *f = t->Struct.fields[i];
 			GB_ASSERT(f->kind == Entity_Variable);
 			String name = f->token.string;
-			HashKey key = hash_string(name);
+			HashKey key = hash_atom(f->atom);
 			Entity **found = map_get(entity_map, key);
 			if (found != nullptr && name != "_") {
 				Entity *e = *found;
@@ -190,7 +190,7 @@ void check_struct_field_decl(Checker *c, AstNode *decl, Array<Entity *> *fields,
 		if (is_blank_ident(name_token)) {
 			array_add(fields, e);
 		} else {
-			HashKey key = hash_string(name_token.string);
+			HashKey key = hash_atom(name->Ident.atom);
 			Entity **found = map_get(entity_map, key);
 			if (found != nullptr) {
 				Entity *e = *found;
@@ -539,8 +539,65 @@ bool check_custom_align(Checker *c, AstNode *node, i64 *align_) {
 }
 
 
+gbString write_exact_value_to_string(gbString s, ExactValue v) {
+	char buf[64] = {};
+	isize len = 0;
+	switch (v.kind) {
+	case ExactValue_Bool:
+		return gb_string_appendc(s, v.value_bool ? "true" : "false");
+	case ExactValue_String:
+		s = gb_string_append_rune(s, '"');
+		s = gb_string_append_length(s, v.value_string.text, v.value_string.len);
+		return gb_string_append_rune(s, '"');
+	case ExactValue_Integer: {
+		String str = i128_to_string(v.value_integer, buf, gb_size_of(buf));
+		return gb_string_append_length(s, str.text, str.len);
+	}
+	case ExactValue_Float:
+		// Print the bits so different values never print the same
+		len = gb_snprintf(buf, gb_size_of(buf), "0h%016llx", *cast(unsigned long long *)&v.value_float)-1;
+		break;
+	case ExactValue_Complex:
+		len = gb_snprintf(buf, gb_size_of(buf), "0h%016llx+0h%016llxi",
+		                  *cast(unsigned long long *)&v.value_complex.real,
+		                  *cast(unsigned long long *)&v.value_complex.imag)-1;
+		break;
+	case ExactValue_Pointer:
+		len = gb_snprintf(buf, gb_size_of(buf), "%lld", cast(long long)v.value_pointer)-1;
+		break;
+	case ExactValue_Type:
+		return write_type_to_string(s, v.value_type);
+	default:
+		len = gb_snprintf(buf, gb_size_of(buf), "%llx", cast(unsigned long long)hash_exact_value(v).key)-1;
+		break;
+	}
+	return gb_string_append_length(s, buf, len);
+}
+
+// Unlike the call expression, this name only depends on the parameters of the specialization
+String make_polymorphic_struct_canonical_name(Type *original_type, isize param_count, Array<Operand> ordered_operands) {
+	gbString s = gb_string_make(heap_allocator(), "");
+	if (original_type->kind == Type_Named) {
+		s = gb_string_append_length(s, original_type->Named.name.text, original_type->Named.name.len);
+	}
+	s = gb_string_append_rune(s, '(');
+	for (isize i = 0; i < param_count; i++) {
+		Operand o = ordered_operands[i];
+		if (i > 0) {
+			s = gb_string_appendc(s, ", ");
+		}
+		if (o.mode == Addressing_Type) {
+			s = write_type_to_string(s, o.type);
+		} else {
+			s = write_exact_value_to_string(s, o.value);
+		}
+	}
+	s = gb_string_append_rune(s, ')');
+	return make_string_c(s);
+}
+
 Entity *find_polymorphic_struct_entity(Checker *c, Type *original_type, isize param_count, Array<Operand> ordered_operands) {
-	auto *found_gen_types = map_get(&c->info.gen_types, hash_pointer(original_type));
+	auto *found_gen_types = map_get(&c->info->gen_types, hash_pointer(original_type));
 
 	if (found_gen_types != nullptr) {
 		for_array(i, *found_gen_types) {
@@ -594,6 +651,7 @@ void add_polymorphic_struct_entity(Checker *c, AstNode *node, Type *named_type,
 		AstNode *node = gb_alloc_item(a, AstNode);
 		node->kind = AstNode_Ident;
 		node->Ident.token = token;
+		node->Ident.atom  = make_atom(token.string);
 
 		e = make_entity_type_name(a, s, token, named_type);
 		add_entity_use(c, node, e);
@@ -601,14 +659,14 @@ void add_polymorphic_struct_entity(Checker *c, AstNode *node, Type *named_type,
 
 	named_type->Named.type_name = e;
 
-	auto *found_gen_types = map_get(&c->info.gen_types, hash_pointer(original_type));
+	auto *found_gen_types = map_get(&c->info->gen_types, hash_pointer(original_type));
 	if (found_gen_types) {
 		array_add(found_gen_types, e);
 	} else {
 		Array<Entity *> array = {};
 		array_init(&array, heap_allocator());
 		array_add(&array, e);
-		map_set(&c->info.gen_types, hash_pointer(original_type), array);
+		map_set(&c->info->gen_types, hash_pointer(original_type), array);
 	}
 }
 
@@ -938,7 +996,7 @@ void check_enum_type(Checker *c, Type *enum_type, Type *named_type, AstNode *nod
 	// NOTE(bill): Must be up here for the `check_init_constant` system
 	enum_type->Enum.base_type = base_type;
 
-	Map<Entity *> entity_map = {}; // Key: String
+	Map<Entity *> entity_map = {}; // Key: Atom *
 	map_init(&entity_map, c->tmp_allocator, 2*(et->fields.count));
 
 	Array<Entity *> fields = {};
@@ -1024,7 +1082,7 @@ void check_enum_type(Checker *c, Type *enum_type, Type *named_type, AstNode *nod
 		e->identifier = ident;
 		e->flags |= EntityFlag_Visited;
 
-		HashKey key = hash_string(name);
+		HashKey key = hash_atom(ident->Ident.atom);
 		if (map_get(&entity_map, key) != nullptr) {
 			error(ident, "`%.*s` is already declared in this enumeration", LIT(name));
 		} else {
@@ -1058,7 +1116,7 @@ void check_bit_field_type(Checker *c, Type *bit_field_type, AstNode *node) {
 	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&c->tmp_arena);
 	defer (gb_temp_arena_memory_end(tmp));
 
-	Map<Entity *> entity_map = {}; // Key: String
+	Map<Entity *> entity_map = {}; // Key: Atom *
 	map_init(&entity_map, c->tmp_allocator, 2*(bft->fields.count));
 
 	isize field_count = 0;
@@ -1101,7 +1159,7 @@ void check_bit_field_type(Checker *c, Type *bit_field_type, AstNode *node) {
 		e->identifier = ident;
 		e->flags |= EntityFlag_BitFieldValue;
 
-		HashKey key = hash_string(name);
+		HashKey key = hash_atom(ident->Ident.atom);
 		if (!is_blank_ident(name) &&
 		    map_get(&entity_map, key) != nullptr) {
 			error(ident, "`%.*s` is already declared in this bit field", LIT(name));
@@ -2370,7 +2428,7 @@ Type *check_type(Checker *c, AstNode *e, Type *named_type) {
 	#endif
 
 	if (is_type_typed(type)) {
-		add_type_and_value(&c->info, e, Addressing_Type, type, empty_exact_value);
+		add_type_and_value(c->info, e, Addressing_Type, type, empty_exact_value);
 	} else {
 		gbString name = type_to_string(type);
 		error(e, "Invalid type definition of %s", name);
@@ -202,6 +202,56 @@ struct ProcedureInfo {
 	bool                  generated_from_polymorphic;
 };
 
+// Procedure bodies are checked in parallel as jobs. Each job logs what it adds to the
+// ordered parts of `CheckerInfo` and the logs are replayed in the order of the jobs' keys once every
+// job has finished, so the result does not depend on the number of threads or the scheduling.
+// A child job's key extends the key of the job that spawned it and the key of a polymorphic
+// specialization is derived from its base entity and type, so neither depends on which job got there first.
+struct CheckerJobDefinition {
+	AstNode *identifier;
+	Entity * entity;
+};
+
+struct CheckerJobDecl {
+	Entity *  entity;
+	DeclInfo *decl;
+};
+
+struct CheckerJob {
+	String                      key;
+	u64                         key_hash;
+	ProcedureInfo               proc; // `proc.type` is nullptr if there is nothing to check
+	CheckerJob *                spawner;
+	isize                       spawn_count;
+	isize                       probe_count;
+	Array<CheckerJob *>         spawned; // Queued once the running job has finished
+
+	Array<Entity *>             entities;
+	Array<CheckerJobDefinition> definitions;
+	Array<CheckerJobDecl>       decls;
+	Array<Type *>               type_infos;
+	gbString                    errors; // Printed in key order once every job has finished, nullptr if none
+
+	// A specialized polymorphic struct is renamed after its call site with the smallest key
+	Entity *                    poly_struct;
+	String                      poly_struct_name;
+	String                      poly_struct_name_key;
+};
+
+struct CheckerJobQueue {
+	gbMutex             mutex;
+	gbSemaphore         semaphore;
+	Array<CheckerJob *> jobs; // Doubles as the work queue
+	isize               curr_job_index;
+	isize               active_worker_count;
+	isize               idle_worker_count;
+	u64                 first_entity_id;
+	Map<CheckerJob *>   poly_structs; // Key: Entity * | Guarded by `CheckerInfo.gen_mutex`
+};
+
+// The job whose logs and keys are in use on this thread
+gb_thread_local CheckerJob *checker_curr_job = nullptr;
+
 // ExprInfo stores information used for "untyped" expressions
 struct ExprInfo {
 	bool           is_lhs; // Debug info
@@ -210,6 +260,20 @@ struct ExprInfo {
 	ExactValue     value;
 };
 
+// What the checker records for the nodes of a file, indexed by `AstNode.index`.
+// Nodes made after the table, e.g. clones and lazily parsed procedure bodies, have no slot
+// and use the maps in `CheckerInfo` instead
+struct CheckerNodeTable {
+	u32            count;
+	TypeAndValue * types;
+	Entity **      definitions;
+	Entity **      uses;
+	Scope **       scopes;
+	Entity **      implicits;
+};
+
+#define CHECKER_NODE_MUTEX_COUNT 16
+
 ExprInfo make_expr_info(bool is_lhs, AddressingMode mode, Type *type, ExactValue value) {
 	ExprInfo ei = {is_lhs, mode, type, value};
 	return ei;
@@ -223,7 +287,7 @@ struct Scope {
 	Scope *          prev, *next;
 	Scope *          first_child;
 	Scope *          last_child;
-	Map<Entity *>    elements; // Key: String
+	Map<Entity *>    elements; // Key: Atom *
 	Map<bool>        implicit; // Key: Entity *
 
 	Array<Scope *>   shared;
@@ -269,13 +333,13 @@ struct EntityGraphNode;
 typedef PtrSet<EntityGraphNode *> EntityGraphNodeSet;
 
 void entity_graph_node_set_destroy(EntityGraphNodeSet *s) {
-	if (s->hashes.data != nullptr) {
+	if (s->entries.data != nullptr) {
 		ptr_set_destroy(s);
 	}
 }
 
 void entity_graph_node_set_add(EntityGraphNodeSet *s, EntityGraphNode *n) {
-	if (s->hashes.data == nullptr) {
+	if (s->entries.data == nullptr) {
 		ptr_set_init(s, heap_allocator());
 	}
 	ptr_set_add(s, n);
@@ -331,13 +395,13 @@ struct ImportGraphNode;
 typedef PtrSet<ImportGraphNode *> ImportGraphNodeSet;
 
 void import_graph_node_set_destroy(ImportGraphNodeSet *s) {
-	if (s->hashes.data != nullptr) {
+	if (s->entries.data != nullptr) {
 		ptr_set_destroy(s);
 	}
 }
 
 void import_graph_node_set_add(ImportGraphNodeSet *s, ImportGraphNode *n) {
-	if (s->hashes.data == nullptr) {
+	if (s->entries.data == nullptr) {
 		ptr_set_init(s, heap_allocator());
 	}
 	ptr_set_add(s, n);
@@ -430,16 +494,56 @@ struct CheckerContext {
 };
 
 
+// A specialization of a polymorphic procedure along with the operands it was made from,
+// see `find_or_generate_polymorphic_procedure`
+struct PolyProcCacheOperand {
+	AddressingMode mode;
+	Type *         type;
+};
+
+struct PolyProcCacheEntry {
+	Entity *               base_entity;
+	bool                   no_polymorphic_errors;
+	PolyProcCacheOperand * operands;
+	isize                  operand_count;
+	Entity *               entity;
+};
+
+// The overload chosen for a call along with the operands it was chosen for,
+// see `check_call_arguments`
+struct OverloadCacheOperand {
+	AddressingMode mode;
+	Type *         type;
+	ExactValue     value; // Only set for untyped constants as it may decide the overload
+};
+
+struct OverloadCacheEntry {
+	Entity **              procs;
+	isize                  proc_count;
+	OverloadCacheOperand * operands;
+	isize                  operand_count;
+	bool                   vari_expand;
+	isize                  index; // Index of the chosen overload in `procs`
+	Type **                type_infos; // Added whilst choosing the overload and so added again on a hit
+	isize                  type_info_count;
+};
+
 // CheckerInfo stores all the symbol information for a type-checked program
 struct CheckerInfo {
-	Map<TypeAndValue>     types;           // Key: AstNode * | Expression -> Type (and value)
+	// `types`, `uses`, `scopes` and `implicits` are only for the nodes without a slot in
+	// their file's `CheckerNodeTable`. `definitions` has every definition in order but lookups use the tables
+	Array<CheckerNodeTable *> node_tables;
+	gbMutex               node_mutexes[CHECKER_NODE_MUTEX_COUNT]; // Guard the node table slots whilst checking in parallel
+	ShardedMap<TypeAndValue> types;        // Key: AstNode * | Expression -> Type (and value)
 	Map<Entity *>         definitions;     // Key: AstNode * | Identifier -> Entity
-	Map<Entity *>         uses;            // Key: AstNode * | Identifier -> Entity
-	Map<Scope *>          scopes;          // Key: AstNode * | Node       -> Scope
-	Map<ExprInfo>         untyped;         // Key: AstNode * | Expression -> ExprInfo
-	Map<Entity *>         implicits;       // Key: AstNode *
+	ShardedMap<Entity *>  uses;            // Key: AstNode * | Identifier -> Entity
+	ShardedMap<Scope *>   scopes;          // Key: AstNode * | Node       -> Scope
+	ShardedMap<ExprInfo>  untyped;         // Key: AstNode * | Expression -> ExprInfo
+	ShardedMap<Entity *>  implicits;       // Key: AstNode *
 	Map<Array<Entity *> > gen_procs;       // Key: AstNode * | Identifier -> Entity
 	Map<Array<Entity *> > gen_types;       // Key: Type *
+	Map<PolyProcCacheEntry> poly_proc_cache; // Key: poly_proc_cache_hash | Multi-map, guarded by `gen_mutex`
+	Map<OverloadCacheEntry> overload_cache;  // Key: overload_cache_hash   | Multi-map, guarded by `overload_mutex`
 	Map<DeclInfo *>       entities;        // Key: Entity *
 	Map<Entity *>         foreigns;        // Key: String
 	Map<AstFile *>        files;           // Key: String (full path)
@@ -447,17 +551,29 @@ struct CheckerInfo {
 
 
 	Map<isize>            type_info_map;   // Key: Type *
+	Map<Type *>           type_info_hashes; // Key: type_hash_structural | Multi-map of the types in `type_info_map`
 	isize                 type_info_count;
 
 	Scope *               init_scope;
 	Entity *              entry_point;
 	PtrSet<Entity *>      minimum_dependency_set;
 
+	// Whilst procedure bodies are being checked (see `check_proc_bodies`), `definitions`
+	// and `entities` are read-only and any new entries go into `new_definitions` and `new_entities`.
+	// These are merged back in the order of the checking jobs once every job has finished.
+	bool                   is_checking_jobs;
+	bool                   is_parallel;     // More than one thread is checking jobs
+	ShardedMap<Entity *>   new_definitions; // Key: AstNode *
+	ShardedMap<DeclInfo *> new_entities;    // Key: Entity *
+	gbMutex                gen_mutex;       // Guards `gen_procs`, `gen_types` and `poly_proc_cache`
+	gbMutex                foreign_mutex;   // Guards `foreigns`
+	gbMutex                overload_mutex;  // Guards `overload_cache`
+	gbMutex                type_info_mutex; // Guards `type_info_map` as `type_info_index` adds to it whilst the IR is built in parallel
 };
 
 struct Checker {
 	Parser *    parser;
-	CheckerInfo info;
+	CheckerInfo *info; // Shared with the copies of the checker used by each worker thread
 
 	AstFile *                  curr_ast_file;
 	Scope *                    global_scope;
@@ -466,9 +582,7 @@ struct Checker {
 	Map<Scope *>               file_scopes; // Key: String (fullpath)
 	Array<ImportGraphNode *>   file_order;
 
-	Pool                       pool;
 	gbAllocator                allocator;
-	gbArena                    arena;
 	gbArena                    tmp_arena;
 	gbAllocator                tmp_allocator;
 
@@ -479,6 +593,7 @@ struct Checker {
 
 	PtrSet<AstFile *>          checked_files;
 
+	CheckerJobQueue *          job_queue; // Only set whilst checking procedure bodies
 };
 
 
@@ -502,13 +617,15 @@ AstFile *    ast_file_of_filename   (CheckerInfo *i, String   filename);
 isize        type_info_index        (CheckerInfo *i, Type *   type, bool error_on_failure = true);
 
 
+Entity *current_scope_lookup_entity(Scope *s, Atom *name);
 Entity *current_scope_lookup_entity(Scope *s, String name);
+Entity *scope_lookup_entity        (Scope *s, Atom *name);
 Entity *scope_lookup_entity        (Scope *s, String name);
-void    scope_lookup_parent_entity (Scope *s, String name, Scope **scope_, Entity **entity_);
+void    scope_lookup_parent_entity (Scope *s, Atom *name, Scope **scope_, Entity **entity_);
 Entity *scope_insert_entity        (Scope *s, Entity *entity);
 
 
-ExprInfo *check_get_expr_info(CheckerInfo *i, AstNode *expr);
+bool check_get_expr_info(CheckerInfo *i, AstNode *expr, ExprInfo *info_);
 void check_set_expr_info(CheckerInfo *i, AstNode *expr, ExprInfo info);
 void check_remove_expr_info(CheckerInfo *i, AstNode *expr);
 void add_untyped(CheckerInfo *i, AstNode *expression, bool lhs, AddressingMode mode, Type *basic_type, ExactValue value);
@@ -547,11 +664,11 @@ bool decl_info_has_init(DeclInfo *d) {
 	}
 	if (d->proc_lit != nullptr) {
 		switch (d->proc_lit->kind) {
-		case_ast_node(pl, ProcLit, d->proc_lit);
-			if (pl->body != nullptr) {
+		case AstNode_ProcLit:
+			if (ast_proc_lit_has_body(d->proc_lit)) {
 				return true;
 			}
-		case_end;
+			break;
 		}
 	}
 
@@ -632,11 +749,80 @@ void destroy_scope(Scope *scope) {
 }
 
 
+CheckerNodeTable *make_checker_node_table(u32 count) {
+	gbAllocator a = heap_allocator();
+	CheckerNodeTable *t = gb_alloc_item(a, CheckerNodeTable);
+	t->count       = count;
+	t->types       = gb_alloc_array(a, TypeAndValue, count);
+	t->definitions = gb_alloc_array(a, Entity *,     count);
+	t->uses        = gb_alloc_array(a, Entity *,     count);
+	t->scopes      = gb_alloc_array(a, Scope *,      count);
+	t->implicits   = gb_alloc_array(a, Entity *,     count);
+	return t;
+}
+
+void destroy_checker_node_table(CheckerNodeTable *t) {
+	gbAllocator a = heap_allocator();
+	gb_free(a, t->types);
+	gb_free(a, t->definitions);
+	gb_free(a, t->uses);
+	gb_free(a, t->scopes);
+	gb_free(a, t->implicits);
+	gb_free(a, t);
+}
+
+// Returns nullptr if `node` has no slot
+gb_inline CheckerNodeTable *checker_node_table(AstNode *node) {
+	AstFile *f = node->file;
+	if (f == nullptr || f->node_table == nullptr) {
+		return nullptr;
+	}
+	CheckerNodeTable *t = f->node_table;
+	if (node->index == 0 || node->index >= t->count) {
+		return nullptr;
+	}
+	return t;
+}
+
+gb_inline gbMutex *checker_node_mutex(CheckerInfo *i, AstNode *node) {
+	return &i->node_mutexes[node->index & (CHECKER_NODE_MUTEX_COUNT-1)];
+}
+
+// Parallel checker jobs may check the same node, e.g. a type used by several bodies
+template <typename T>
+void checker_node_slot_set(CheckerInfo *i, AstNode *node, T *slot, T value) {
+	if (i->is_parallel) {
+		gbMutex *m = checker_node_mutex(i, node);
+		gb_mutex_lock(m);
+		*slot = value;
+		gb_mutex_unlock(m);
+	} else {
+		*slot = value;
+	}
+}
+
+template <typename T>
+T checker_node_slot_get(CheckerInfo *i, AstNode *node, T *slot) {
+	if (i->is_parallel) {
+		gbMutex *m = checker_node_mutex(i, node);
+		gb_mutex_lock(m);
+		T value = *slot;
+		gb_mutex_unlock(m);
+		return value;
+	}
+	return *slot;
+}
+
 void add_scope(Checker *c, AstNode *node, Scope *scope) {
 	GB_ASSERT(node != nullptr);
 	GB_ASSERT(scope != nullptr);
 	scope->node = node;
-	map_set(&c->info.scopes, hash_node(node), scope);
+	CheckerNodeTable *t = checker_node_table(node);
+	if (t != nullptr) {
+		checker_node_slot_set(c->info, node, &t->scopes[node->index], scope);
+	} else {
+		sharded_map_set(&c->info->scopes, hash_node(node), scope);
+	}
 }
 
 
@@ -666,8 +852,8 @@ void check_close_scope(Checker *c) {
 }
 
 
-Entity *current_scope_lookup_entity(Scope *s, String name) {
-	HashKey key = hash_string(name);
+Entity *current_scope_lookup_entity(Scope *s, Atom *name) {
+	HashKey key = hash_atom(name);
 	Entity **found = map_get(&s->elements, key);
 	if (found) {
 		return *found;
@@ -694,10 +880,10 @@ Entity *current_scope_lookup_entity(Scope *s, String name) {
 	return nullptr;
 }
 
-void scope_lookup_parent_entity(Scope *scope, String name, Scope **scope_, Entity **entity_) {
+void scope_lookup_parent_entity(Scope *scope, Atom *name, Scope **scope_, Entity **entity_) {
 	bool gone_thru_proc = false;
 	bool gone_thru_file = false;
-	HashKey key = hash_string(name);
+	HashKey key = hash_atom(name);
 	for (Scope *s = scope; s != nullptr; s = s->parent) {
 		Entity **found = map_get(&s->elements, key);
 		if (found) {
@@ -762,17 +948,24 @@ void scope_lookup_parent_entity(Scope *scope, String name, Scope **scope_, Entit
 	if (scope_) *scope_ = nullptr;
 }
 
-Entity *scope_lookup_entity(Scope *s, String name) {
+Entity *scope_lookup_entity(Scope *s, Atom *name) {
 	Entity *entity = nullptr;
 	scope_lookup_parent_entity(s, name, nullptr, &entity);
 	return entity;
 }
 
+// Prefer the `Atom *` versions where the identifier's token is at hand
+Entity *current_scope_lookup_entity(Scope *s, String name) {
+	return current_scope_lookup_entity(s, make_atom(name));
+}
+Entity *scope_lookup_entity(Scope *s, String name) {
+	return scope_lookup_entity(s, make_atom(name));
+}
+
 
 
 Entity *scope_insert_entity(Scope *s, Entity *entity) {
-	String name = entity->token.string;
-	HashKey key = hash_string(name);
+	HashKey key = hash_atom(entity->atom);
 	Entity **found = map_get(&s->elements, key);
 
 #if 1
@@ -818,7 +1011,7 @@ void add_declaration_dependency(Checker *c, Entity *e) {
 		return;
 	}
 	if (c->context.decl != nullptr) {
-		DeclInfo *decl = decl_info_of_entity(&c->info, e);
+		DeclInfo *decl = decl_info_of_entity(c->info, e);
 		if (decl) add_dependency(c->context.decl, e);
 	}
 }
@@ -914,37 +1107,77 @@ void init_universal_scope(void) {
 
 void init_checker_info(CheckerInfo *i) {
 	gbAllocator a = heap_allocator();
-	map_init(&i->types,         a);
-	map_init(&i->definitions,   a);
-	map_init(&i->uses,          a);
-	map_init(&i->scopes,        a);
-	map_init(&i->entities,      a);
-	map_init(&i->untyped,       a);
-	map_init(&i->foreigns,      a);
-	map_init(&i->implicits,     a);
-	map_init(&i->gen_procs,     a);
-	map_init(&i->gen_types,     a);
-	map_init(&i->type_info_map, a);
-	map_init(&i->files,         a);
+	sharded_map_init(&i->types,     a);
+	map_init(&i->definitions,       a);
+	sharded_map_init(&i->uses,      a);
+	sharded_map_init(&i->scopes,    a);
+	map_init(&i->entities,          a);
+	sharded_map_init(&i->untyped,   a);
+	map_init(&i->foreigns,          a);
+	sharded_map_init(&i->implicits, a);
+	map_init(&i->gen_procs,         a);
+	map_init(&i->poly_proc_cache,   a);
+	map_init(&i->overload_cache,    a);
+	map_init(&i->gen_types,         a);
+	map_init(&i->type_info_map,     a);
+	map_init(&i->type_info_hashes,  a);
+	map_init(&i->files,             a);
 	array_init(&i->variable_init_order, a);
+	array_init(&i->node_tables, a);
+	for (isize j = 0; j < CHECKER_NODE_MUTEX_COUNT; j++) {
+		gb_mutex_init(&i->node_mutexes[j]);
+	}
 
 	i->type_info_count = 0;
+
+	sharded_map_init(&i->new_definitions, a);
+	sharded_map_init(&i->new_entities,    a);
+	gb_mutex_init(&i->gen_mutex);
+	gb_mutex_init(&i->foreign_mutex);
+	gb_mutex_init(&i->overload_mutex);
+	gb_mutex_init(&i->type_info_mutex);
 }
 
 void destroy_checker_info(CheckerInfo *i) {
-	map_destroy(&i->types);
+	sharded_map_destroy(&i->types);
 	map_destroy(&i->definitions);
-	map_destroy(&i->uses);
-	map_destroy(&i->scopes);
+	sharded_map_destroy(&i->uses);
+	sharded_map_destroy(&i->scopes);
 	map_destroy(&i->entities);
-	map_destroy(&i->untyped);
+	sharded_map_destroy(&i->untyped);
 	map_destroy(&i->foreigns);
-	map_destroy(&i->implicits);
+	sharded_map_destroy(&i->implicits);
 	map_destroy(&i->gen_procs);
+	for_array(j, i->poly_proc_cache.entries) {
+		gb_free(heap_allocator(), i->poly_proc_cache.entries[j].value.operands);
+	}
+	map_destroy(&i->poly_proc_cache);
+	for_array(j, i->overload_cache.entries) {
+		OverloadCacheEntry *e = &i->overload_cache.entries[j].value;
+		gb_free(heap_allocator(), e->procs);
+		gb_free(heap_allocator(), e->operands);
+		gb_free(heap_allocator(), e->type_infos);
+	}
+	map_destroy(&i->overload_cache);
 	map_destroy(&i->gen_types);
 	map_destroy(&i->type_info_map);
+	map_destroy(&i->type_info_hashes);
 	map_destroy(&i->files);
 	array_free(&i->variable_init_order);
+	for_array(j, i->node_tables) {
+		destroy_checker_node_table(i->node_tables[j]);
+	}
+	array_free(&i->node_tables);
+	for (isize j = 0; j < CHECKER_NODE_MUTEX_COUNT; j++) {
+		gb_mutex_destroy(&i->node_mutexes[j]);
+	}
+
+	sharded_map_destroy(&i->new_definitions);
+	sharded_map_destroy(&i->new_entities);
+	gb_mutex_destroy(&i->gen_mutex);
+	gb_mutex_destroy(&i->foreign_mutex);
+	gb_mutex_destroy(&i->overload_mutex);
+	gb_mutex_destroy(&i->type_info_mutex);
 }
 
 
@@ -957,7 +1190,8 @@ void init_checker(Checker *c, Parser *parser) {
 	gbAllocator a = heap_allocator();
 
 	c->parser = parser;
-	init_checker_info(&c->info);
+	c->info = gb_alloc_item(a, CheckerInfo);
+	init_checker_info(c->info);
 
 	array_init(&c->proc_stack, a);
 	map_init(&c->procs, a);
@@ -971,12 +1205,9 @@ void init_checker(Checker *c, Parser *parser) {
 	}
 	isize arena_size = 2 * item_size * total_token_count;
 	gb_arena_init_from_allocator(&c->tmp_arena, a, arena_size);
-	gb_arena_init_from_allocator(&c->arena, a, arena_size);
 
-	pool_init(&c->pool, gb_megabytes(4), gb_kilobytes(384));
-	// c->allocator = pool_allocator(&c->pool);
-	c->allocator = heap_allocator();
-	// c->allocator     = gb_arena_allocator(&c->arena);
+	// Entities, Types, Scopes and DeclInfos live until the IR has been generated and printed
+	c->allocator     = region_allocator(Region_Check);
 	c->tmp_allocator = gb_arena_allocator(&c->tmp_arena);
 
 	c->global_scope = create_scope(universal_scope, c->allocator);
@@ -989,29 +1220,43 @@ void init_checker(Checker *c, Parser *parser) {
 }
 
 void destroy_checker(Checker *c) {
-	destroy_checker_info(&c->info);
+	destroy_checker_info(c->info);
+	gb_free(heap_allocator(), c->info);
 	destroy_scope(c->global_scope);
 	array_free(&c->proc_stack);
 	map_destroy(&c->procs);
 
-	pool_destroy(&c->pool);
 	gb_arena_free(&c->tmp_arena);
 
 	map_destroy(&c->file_scopes);
 	ptr_set_destroy(&c->checked_files);
 	array_free(&c->file_order);
+
+	region_release(Region_Check);
 }
 
 
 Entity *entity_of_ident(CheckerInfo *i, AstNode *identifier) {
 	if (identifier->kind == AstNode_Ident) {
+		CheckerNodeTable *t = checker_node_table(identifier);
+		if (t != nullptr) {
+			Entity *e = checker_node_slot_get(i, identifier, &t->definitions[identifier->index]);
+			if (e == nullptr) {
+				e = checker_node_slot_get(i, identifier, &t->uses[identifier->index]);
+			}
+			return e;
+		}
+
+		Entity *e = nullptr;
+		if (i->is_checking_jobs && sharded_map_get(&i->new_definitions, hash_node(identifier), &e)) {
+			return e;
+		}
 		Entity **found = map_get(&i->definitions, hash_node(identifier));
 		if (found) {
 			return *found;
 		}
-		found = map_get(&i->uses, hash_node(identifier));
-		if (found) {
-			return *found;
+		if (sharded_map_get(&i->uses, hash_node(identifier), &e)) {
+			return e;
 		}
 	}
 	return nullptr;
@@ -1019,8 +1264,18 @@ Entity *entity_of_ident(CheckerInfo *i, AstNode *identifier) {
 
 TypeAndValue type_and_value_of_expr(CheckerInfo *i, AstNode *expr) {
 	TypeAndValue result = {};
-	TypeAndValue *found = map_get(&i->types, hash_node(expr));
-	if (found) result = *found;
+	CheckerNodeTable *t = checker_node_table(expr);
+	if (t == nullptr) {
+		sharded_map_get(&i->types, hash_node(expr), &result);
+	} else if (i->is_parallel) {
+		// More than one job may check the same node, e.g. the signature of a polymorphic procedure
+		gbMutex *m = checker_node_mutex(i, expr);
+		gb_mutex_lock(m);
+		result = t->types[expr->index];
+		gb_mutex_unlock(m);
+	} else {
+		result = t->types[expr->index];
+	}
 	return result;
 }
 
@@ -1040,11 +1295,13 @@ Type *type_of_expr(CheckerInfo *i, AstNode *expr) {
 }
 
 Entity *implicit_entity_of_node(CheckerInfo *i, AstNode *clause) {
-	Entity **found = map_get(&i->implicits, hash_node(clause));
-	if (found != nullptr) {
-		return *found;
+	CheckerNodeTable *t = checker_node_table(clause);
+	if (t != nullptr) {
+		return t->implicits[clause->index];
 	}
-	return nullptr;
+	Entity *e = nullptr;
+	sharded_map_get(&i->implicits, hash_node(clause), &e);
+	return e;
 }
 bool is_entity_implicitly_imported(Entity *import_name, Entity *e) {
 	GB_ASSERT(import_name->kind == Entity_ImportName);
@@ -1058,6 +1315,10 @@ DeclInfo *decl_info_of_entity(CheckerInfo *i, Entity *e) {
 		if (found != nullptr) {
 			return *found;
 		}
+		DeclInfo *d = nullptr;
+		if (i->is_checking_jobs && sharded_map_get(&i->new_entities, hash_entity(e), &d)) {
+			return d;
+		}
 	}
 	return nullptr;
 }
@@ -1074,47 +1335,58 @@ AstFile *ast_file_of_filename(CheckerInfo *i, String filename) {
 	return nullptr;
 }
 Scope *scope_of_node(CheckerInfo *i, AstNode *node) {
-	Scope **found = map_get(&i->scopes, hash_node(node));
-	if (found) {
-		return *found;
+	CheckerNodeTable *t = checker_node_table(node);
+	if (t != nullptr) {
+		return checker_node_slot_get(i, node, &t->scopes[node->index]);
 	}
-	return nullptr;
+	Scope *scope = nullptr;
+	sharded_map_get(&i->scopes, hash_node(node), &scope);
+	return scope;
 }
-ExprInfo *check_get_expr_info(CheckerInfo *i, AstNode *expr) {
-	return map_get(&i->untyped, hash_node(expr));
+bool check_get_expr_info(CheckerInfo *i, AstNode *expr, ExprInfo *info_) {
+	return sharded_map_get(&i->untyped, hash_node(expr), info_);
 }
 void check_set_expr_info(CheckerInfo *i, AstNode *expr, ExprInfo info) {
-	map_set(&i->untyped, hash_node(expr), info);
+	sharded_map_set(&i->untyped, hash_node(expr), info);
 }
 void check_remove_expr_info(CheckerInfo *i, AstNode *expr) {
-	map_remove(&i->untyped, hash_node(expr));
+	sharded_map_remove(&i->untyped, hash_node(expr));
 }
 
 
 
+// Returns a type in `type_info_map` which is identical to `type`, or nullptr
+Type *find_identical_type_info_type(CheckerInfo *info, Type *type) {
+	HashKey key = hash_integer(type_hash_structural(type));
+	auto *e = multi_map_find_first(&info->type_info_hashes, key);
+	while (e != nullptr) {
+		if (are_types_identical(e->value, type)) {
+			return e->value;
+		}
+		e = multi_map_find_next(&info->type_info_hashes, e);
+	}
+	return nullptr;
+}
+
 isize type_info_index(CheckerInfo *info, Type *type, bool error_on_failure) {
 	type = default_type(type);
 
 	isize entry_index = -1;
 	HashKey key = hash_type(type);
+	gb_mutex_lock(&info->type_info_mutex);
 	isize *found_entry_index = map_get(&info->type_info_map, key);
 	if (found_entry_index) {
 		entry_index = *found_entry_index;
 	}
 	if (entry_index < 0) {
-		// NOTE(bill): Do manual search
-		// TODO(bill): This is O(n) and can be very slow
-		for_array(i, info->type_info_map.entries){
-			auto *e = &info->type_info_map.entries[i];
-			Type *prev_type = cast(Type *)e->key.ptr;
-			if (are_types_identical(prev_type, type)) {
-				entry_index = e->value;
-				// NOTE(bill): Add it to the search map
-				map_set(&info->type_info_map, key, entry_index);
-				break;
-			}
+		Type *prev_type = find_identical_type_info_type(info, type);
+		if (prev_type != nullptr) {
+			entry_index = *map_get(&info->type_info_map, hash_type(prev_type));
+			// NOTE(bill): Add it to the search map
+			map_set(&info->type_info_map, key, entry_index);
 		}
 	}
+	gb_mutex_unlock(&info->type_info_mutex);
 
 	if (error_on_failure && entry_index < 0) {
 		compiler_error("TypeInfo for `%s` could not be found", type_to_string(type));
@@ -1124,7 +1396,7 @@ isize type_info_index(CheckerInfo *info, Type *type, bool error_on_failure) {
 
 
 void add_untyped(CheckerInfo *i, AstNode *expression, bool lhs, AddressingMode mode, Type *basic_type, ExactValue value) {
-	map_set(&i->untyped, hash_node(expression), make_expr_info(lhs, mode, basic_type, value));
+	sharded_map_set(&i->untyped, hash_node(expression), make_expr_info(lhs, mode, basic_type, value));
 }
 
 void add_type_and_value(CheckerInfo *i, AstNode *expression, AddressingMode mode, Type *type, ExactValue value) {
@@ -1151,7 +1423,17 @@ void add_type_and_value(CheckerInfo *i, AstNode *expression, AddressingMode mode
 	tv.type  = type;
 	tv.value = value;
 	tv.mode  = mode;
-	map_set(&i->types, hash_node(expression), tv);
+	CheckerNodeTable *t = checker_node_table(expression);
+	if (t == nullptr) {
+		sharded_map_set(&i->types, hash_node(expression), tv);
+	} else if (i->is_parallel) {
+		gbMutex *m = checker_node_mutex(i, expression);
+		gb_mutex_lock(m);
+		t->types[expression->index] = tv;
+		gb_mutex_unlock(m);
+	} else {
+		t->types[expression->index] = tv;
+	}
 }
 
 void add_entity_definition(CheckerInfo *i, AstNode *identifier, Entity *entity) {
@@ -1161,7 +1443,22 @@ void add_entity_definition(CheckerInfo *i, AstNode *identifier, Entity *entity)
 			return;
 		}
 		HashKey key = hash_node(identifier);
+		CheckerNodeTable *t = checker_node_table(identifier);
+		CheckerJob *job = checker_curr_job;
+		if (job != nullptr) {
+			CheckerJobDefinition d = {identifier, entity};
+			array_add(&job->definitions, d);
+			if (t != nullptr) {
+				checker_node_slot_set(i, identifier, &t->definitions[identifier->index], entity);
+			} else {
+				sharded_map_set(&i->new_definitions, key, entity);
+			}
+			return;
+		}
 		map_set(&i->definitions, key, entity);
+		if (t != nullptr) {
+			t->definitions[identifier->index] = entity;
+		}
 	} else {
 		// NOTE(bill): Error should be handled elsewhere
 	}
@@ -1184,9 +1481,9 @@ bool add_entity(Checker *c, Scope *scope, AstNode *identifier, Entity *entity) {
 				}
 				error(entity->token,
 				      "Redeclaration of `%.*s` in this scope through `using`\n"
-				      "\tat %.*s(%td:%td)",
+				      "\tat %.*s(%d:%d)",
 				      LIT(name),
-				      LIT(up->token.pos.file), up->token.pos.line, up->token.pos.column);
+				      LIT(token_pos_file(up->token.pos)), up->token.pos.line, up->token.pos.column);
 				return false;
 			} else {
 				if (pos == entity->token.pos) {
@@ -1195,15 +1492,15 @@ bool add_entity(Checker *c, Scope *scope, AstNode *identifier, Entity *entity) {
 				}
 				error(entity->token,
 				      "Redeclaration of `%.*s` in this scope\n"
-				      "\tat %.*s(%td:%td)",
+				      "\tat %.*s(%d:%d)",
 				      LIT(name),
-				      LIT(pos.file), pos.line, pos.column);
+				      LIT(token_pos_file(pos)), pos.line, pos.column);
 				return false;
 			}
 		}
 	}
 	if (identifier != nullptr) {
-		add_entity_definition(&c->info, identifier, entity);
+		add_entity_definition(c->info, identifier, entity);
 	}
 	return true;
 }
@@ -1213,8 +1510,12 @@ void add_entity_use(Checker *c, AstNode *identifier, Entity *entity) {
 	if (identifier->kind != AstNode_Ident) {
 		return;
 	}
-	HashKey key = hash_node(identifier);
-	map_set(&c->info.uses, key, entity);
+	CheckerNodeTable *t = checker_node_table(identifier);
+	if (t != nullptr) {
+		checker_node_slot_set(c->info, identifier, &t->uses[identifier->index], entity);
+	} else {
+		sharded_map_set(&c->info->uses, hash_node(identifier), entity);
+	}
 	add_declaration_dependency(c, entity); // TODO(bill): Should this be here?
 }
 
@@ -1224,26 +1525,45 @@ void add_entity_and_decl_info(Checker *c, AstNode *identifier, Entity *e, DeclIn
 	GB_ASSERT(e != nullptr && d != nullptr);
 	GB_ASSERT(identifier->Ident.token.string == e->token.string);
 	if (e->scope != nullptr) add_entity(c, e->scope, identifier, e);
-	add_entity_definition(&c->info, identifier, e);
-	map_set(&c->info.entities, hash_entity(e), d);
-	e->order_in_src = c->info.entities.entries.count;
+	add_entity_definition(c->info, identifier, e);
+	CheckerJob *job = checker_curr_job;
+	if (job != nullptr) {
+		// `order_in_src` is set once the jobs are merged
+		CheckerJobDecl jd = {e, d};
+		array_add(&job->decls, jd);
+		sharded_map_set(&c->info->new_entities, hash_entity(e), d);
+		return;
+	}
+	map_set(&c->info->entities, hash_entity(e), d);
+	e->order_in_src = c->info->entities.entries.count;
 }
 
 
 void add_implicit_entity(Checker *c, AstNode *node, Entity *e) {
 	GB_ASSERT(node != nullptr);
 	GB_ASSERT(e != nullptr);
-	map_set(&c->info.implicits, hash_node(node), e);
+	CheckerNodeTable *t = checker_node_table(node);
+	if (t != nullptr) {
+		t->implicits[node->index] = e;
+	} else {
+		sharded_map_set(&c->info->implicits, hash_node(node), e);
+	}
 }
 
 
 
 
 
+// If set, every type passed to `add_type_info_type` on this thread is also added here
+gb_thread_local Array<Type *> *checker_type_info_log = nullptr;
+
 void add_type_info_type(Checker *c, Type *t) {
 	if (t == nullptr) {
 		return;
 	}
+	if (checker_type_info_log != nullptr) {
+		array_add(checker_type_info_log, t);
+	}
 	t = default_type(t);
 	if (is_type_bit_field_value(t)) {
 		t = default_bit_field_value_type(t);
@@ -1254,29 +1574,30 @@ void add_type_info_type(Checker *c, Type *t) {
 	if (is_type_polymorphic(base_type(t))) {
 		return;
 	}
+	if (checker_curr_job != nullptr) {
+		// The indices depend on the order the types are added so wait until the jobs are merged
+		array_add(&checker_curr_job->type_infos, t);
+		return;
+	}
 
-	if (map_get(&c->info.type_info_map, hash_type(t)) != nullptr) {
+	if (map_get(&c->info->type_info_map, hash_type(t)) != nullptr) {
 		// Types have already been added
 		return;
 	}
 
 	isize ti_index = -1;
-	for_array(i, c->info.type_info_map.entries) {
-		auto *e = &c->info.type_info_map.entries[i];
-		Type *prev_type = cast(Type *)e->key.ptr;
-		if (are_types_identical(t, prev_type)) {
-			// Duplicate entry
-			ti_index = e->value;
-			break;
-		}
-	}
-	if (ti_index < 0) {
+	Type *prev_type = find_identical_type_info_type(c->info, t);
+	if (prev_type != nullptr) {
+		// Duplicate entry
+		ti_index = *map_get(&c->info->type_info_map, hash_type(prev_type));
+	} else {
 		// Unique entry
 		// NOTE(bill): map entries grow linearly and in order
-		ti_index = c->info.type_info_count;
-		c->info.type_info_count++;
+		ti_index = c->info->type_info_count;
+		c->info->type_info_count++;
+		multi_map_insert(&c->info->type_info_hashes, hash_integer(type_hash_structural(t)), t);
 	}
-	map_set(&c->info.type_info_map, hash_type(t), ti_index);
+	map_set(&c->info->type_info_map, hash_type(t), ti_index);
 
 
 
@@ -1386,10 +1707,244 @@ void add_type_info_type(Checker *c, Type *t) {
 	}
 }
 
+CheckerJob *make_checker_job(String key, ProcedureInfo proc) {
+	gbAllocator a = heap_allocator();
+	CheckerJob *job = gb_alloc_item(a, CheckerJob);
+	job->key      = key;
+	job->key_hash = gb_fnv64a(key.text, key.len);
+	job->proc     = proc;
+	array_init(&job->spawned,     a);
+	array_init(&job->entities,    a);
+	array_init(&job->definitions, a);
+	array_init(&job->decls,       a);
+	array_init(&job->type_infos,  a);
+	return job;
+}
+
+void destroy_checker_job(CheckerJob *job) {
+	array_free(&job->spawned);
+	array_free(&job->entities);
+	array_free(&job->definitions);
+	array_free(&job->decls);
+	array_free(&job->type_infos);
+	if (job->errors != nullptr) {
+		gb_string_free(job->errors);
+	}
+	gb_free(heap_allocator(), job->key.text);
+	gb_free(heap_allocator(), job);
+}
+
+String make_checker_job_key(String prefix, char const *fmt, ...) {
+	char buf[64] = {};
+	va_list va;
+	va_start(va, fmt);
+	isize len = gb_snprintf_va(buf, gb_size_of(buf), fmt, va)-1;
+	va_end(va);
+
+	u8 *text = gb_alloc_array(heap_allocator(), u8, prefix.len+len+1);
+	gb_memmove(text, prefix.text, prefix.len);
+	gb_memmove(text+prefix.len, buf, len);
+	text[prefix.len+len] = 0;
+	return make_string(text, prefix.len+len);
+}
+
+i32 checker_job_key_compare(String x, String y) {
+	// A key sorts before the keys which extend it, so a job sorts before the jobs it spawned
+	i32 cmp = gb_memcompare(x.text, y.text, gb_min(x.len, y.len));
+	if (cmp != 0) {
+		return cmp;
+	}
+	return x.len < y.len ? -1 : x.len > y.len ? +1 : 0;
+}
+
+GB_COMPARE_PROC(checker_job_cmp) {
+	CheckerJob *x = *cast(CheckerJob **)a;
+	CheckerJob *y = *cast(CheckerJob **)b;
+	i32 cmp = checker_job_key_compare(x->key, y->key);
+	if (cmp != 0) {
+		return cmp;
+	}
+	// The jobs which looked for a specialization share the key of the job which made it
+	if (x->decls.count != y->decls.count) {
+		return x->decls.count > y->decls.count ? -1 : +1;
+	}
+	if (x->entities.count != y->entities.count) {
+		return x->entities.count > y->entities.count ? -1 : +1;
+	}
+	// The order must be total as the errors are printed in this order
+	cmp = token_pos_cmp(x->proc.token.pos, y->proc.token.pos);
+	if (cmp != 0) {
+		return cmp;
+	}
+	if (x->decls.count > 0) {
+		cmp = token_pos_cmp(x->decls[0].entity->token.pos, y->decls[0].entity->token.pos);
+		if (cmp != 0) {
+			return cmp;
+		}
+	}
+	if (x->entities.count > 0) {
+		cmp = token_pos_cmp(x->entities[0]->token.pos, y->entities[0]->token.pos);
+		if (cmp != 0) {
+			return cmp;
+		}
+	}
+	String ex = {};
+	String ey = {};
+	if (x->errors != nullptr) ex = make_string(cast(u8 *)x->errors, gb_string_length(x->errors));
+	if (y->errors != nullptr) ey = make_string(cast(u8 *)y->errors, gb_string_length(y->errors));
+	return checker_job_key_compare(ex, ey);
+}
+
+void checker_set_curr_job(CheckerJob *job) {
+	checker_curr_job = job;
+	error_buffer     = job != nullptr ? &job->errors : nullptr;
+}
+
+bool add_entity_to_checker_job(Entity *entity) {
+	CheckerJob *job = checker_curr_job;
+	if (job == nullptr) {
+		return false;
+	}
+	// This id only depends on the job, it is renumbered once the jobs are merged
+	u64 index = cast(u64)job->entities.count;
+	entity->id = gb_murmur64_seed(&index, gb_size_of(index), job->key_hash) | (1ull<<63);
+	array_add(&job->entities, entity);
+	return true;
+}
+
+// The lock is recursive as specializing a polymorphic type may specialize another
+gb_thread_local isize checker_gen_lock_depth = 0;
+
+void checker_lock_gen(CheckerInfo *i) {
+	if (i->is_parallel && checker_gen_lock_depth++ == 0) {
+		gb_mutex_lock(&i->gen_mutex);
+	}
+}
+
+void checker_unlock_gen(CheckerInfo *i) {
+	if (i->is_parallel && --checker_gen_lock_depth == 0) {
+		gb_mutex_unlock(&i->gen_mutex);
+	}
+}
+
+void checker_lock_foreigns(CheckerInfo *i) {
+	if (i->is_parallel) gb_mutex_lock(&i->foreign_mutex);
+}
+
+void checker_unlock_foreigns(CheckerInfo *i) {
+	if (i->is_parallel) gb_mutex_unlock(&i->foreign_mutex);
+}
+
+void checker_lock_overloads(CheckerInfo *i) {
+	if (i->is_parallel) gb_mutex_lock(&i->overload_mutex);
+}
+
+void checker_unlock_overloads(CheckerInfo *i) {
+	if (i->is_parallel) gb_mutex_unlock(&i->overload_mutex);
+}
+
+CheckerJob *checker_begin_sub_job(CheckerJob *spawner, String key) {
+	ProcedureInfo proc = {};
+	CheckerJob *job = make_checker_job(key, proc);
+	job->spawner = spawner;
+	checker_set_curr_job(job);
+	return job;
+}
+
+// Everything logged whilst specializing goes to a job of its own whose key only depends
+// on the base entity and the specialized type, rather than on whichever job happened to get there first.
+// Returns nullptr if the procedure bodies are not being checked.
+CheckerJob *checker_begin_specialization(Entity *base_entity, String type_string) {
+	CheckerJob *spawner = checker_curr_job;
+	if (spawner == nullptr) {
+		return nullptr;
+	}
+	u64 base_id   = base_entity != nullptr ? base_entity->id : 0;
+	u64 type_hash = gb_fnv64a(type_string.text, type_string.len);
+	String key = make_checker_job_key(str_lit(""), "b%016llx#%016llx",
+	                                  cast(unsigned long long)base_id,
+	                                  cast(unsigned long long)type_hash);
+	return checker_begin_sub_job(spawner, key);
+}
+
+// Checking whether a specialization already exists may depend on which jobs have run,
+// so it is logged to a job of its own which does not change the keys of the jobs spawned afterwards
+CheckerJob *checker_begin_specialization_probe(void) {
+	CheckerJob *spawner = checker_curr_job;
+	if (spawner == nullptr) {
+		return nullptr;
+	}
+	String key = make_checker_job_key(spawner->key, "~%06llx", cast(unsigned long long)spawner->probe_count++);
+	return checker_begin_sub_job(spawner, key);
+}
+
+// For a specialization which is never reused, e.g. one which is still polymorphic,
+// so it always belongs to the job which made it
+CheckerJob *checker_begin_unique_specialization(void) {
+	CheckerJob *spawner = checker_curr_job;
+	if (spawner == nullptr) {
+		return nullptr;
+	}
+	String key = make_checker_job_key(spawner->key, ".%06llx", cast(unsigned long long)spawner->spawn_count++);
+	return checker_begin_sub_job(spawner, key);
+}
+
+void checker_end_specialization(CheckerJob *job) {
+	if (job == nullptr) {
+		return;
+	}
+	GB_ASSERT(checker_curr_job == job);
+	CheckerJob *spawner = job->spawner;
+	checker_set_curr_job(spawner);
+	// Anything spawned whilst specializing is queued along with the specialization
+	for_array(i, job->spawned) {
+		array_add(&spawner->spawned, job->spawned[i]);
+	}
+	array_clear(&job->spawned);
+	array_add(&spawner->spawned, job);
+}
+
+// Whilst the jobs are running, a polymorphic struct is specialized by whichever call site
+// gets there first, so it is renamed after the call site with the smallest key once they are merged
+void checker_add_poly_struct(Checker *c, CheckerJob *job, Entity *e, String call_name) {
+	if (job == nullptr || e == nullptr) {
+		return;
+	}
+	job->poly_struct                = e;
+	job->poly_struct_name           = call_name;
+	job->poly_struct_name_key       = job->spawner->key;
+	map_set(&c->job_queue->poly_structs, hash_entity(e), job);
+}
+
+void checker_use_poly_struct(Checker *c, Entity *e, String call_name) {
+	CheckerJob *curr = checker_curr_job;
+	if (curr == nullptr) {
+		return;
+	}
+	CheckerJob **found = map_get(&c->job_queue->poly_structs, hash_entity(e));
+	if (found == nullptr) {
+		// Specialized before the procedure bodies were checked
+		return;
+	}
+	CheckerJob *job = *found;
+	if (checker_job_key_compare(curr->key, job->poly_struct_name_key) < 0) {
+		job->poly_struct_name     = call_name;
+		job->poly_struct_name_key = curr->key;
+	}
+}
+
 void check_procedure_later(Checker *c, ProcedureInfo info) {
-	if (info.decl != nullptr) {
-		map_set(&c->procs, hash_decl_info(info.decl), info);
+	if (info.decl == nullptr) {
+		return;
+	}
+	CheckerJob *job = checker_curr_job;
+	if (job != nullptr) {
+		// Nested procedures are checked once the running job has finished
+		String key = make_checker_job_key(job->key, ".%06llx", cast(unsigned long long)job->spawn_count++);
+		array_add(&job->spawned, make_checker_job(key, info));
+		return;
 	}
+	map_set(&c->procs, hash_decl_info(info.decl), info);
 }
 
 void check_procedure_later(Checker *c, AstFile *file, Token token, DeclInfo *decl, Type *type, AstNode *body, u64 tags) {
@@ -1422,7 +1977,7 @@ Type *const curr_procedure_type(Checker *c) {
 void add_curr_ast_file(Checker *c, AstFile *file) {
 	if (file != nullptr) {
 		TokenPos zero_pos = {};
-		global_error_collector.prev = zero_pos;
+		error_prev_pos = zero_pos;
 		c->curr_ast_file = file;
 		c->context.decl  = file->decl_info;
 		c->context.scope = file->scope;
@@ -1700,6 +2255,12 @@ void init_preload(Checker *c) {
 		t_map_header = e->type;
 	}
 
+	if (entity__any_data == nullptr) {
+		// Created here rather than on first use as procedure bodies may be checked by several threads
+		entity__any_data      = make_entity_field(c->allocator, nullptr, make_token_ident(str_lit("data")),      t_rawptr,        false, 0);
+		entity__any_type_info = make_entity_field(c->allocator, nullptr, make_token_ident(str_lit("type_info")), t_type_info_ptr, false, 1);
+	}
+
 	c->done_preload = true;
 }
 
@@ -1716,7 +2277,7 @@ bool check_is_entity_overloaded(Entity *e) {
 		return false;
 	}
 	Scope *s = e->scope;
-	HashKey key = hash_string(e->token.string);
+	HashKey key = hash_atom(e->atom);
 	isize overload_count = multi_map_count(&s->elements, key);
 	return overload_count > 1;
 }
@@ -1734,8 +2295,7 @@ void check_procedure_overloading(Checker *c, Entity *e) {
 
 	// NOTE(bill): Procedures call only overload other procedures in the same scope
 
-	String name = e->token.string;
-	HashKey key = hash_string(name);
+	HashKey key = hash_atom(e->atom);
 	Scope *s = e->scope;
 	isize overload_count = multi_map_count(&s->elements, key);
 	GB_ASSERT(overload_count >= 1);
@@ -1806,7 +2366,7 @@ void check_procedure_overloading(Checker *c, Entity *e) {
 			}
 
 			if (is_invalid) {
-				gb_printf_err("\tprevious procedure at %.*s(%td:%td)\n", LIT(pos.file), pos.line, pos.column);
+				gb_printf_err("\tprevious procedure at %.*s(%d:%d)\n", LIT(token_pos_file(pos)), pos.line, pos.column);
 				q->type = t_invalid;
 			}
 		}
@@ -2147,8 +2707,8 @@ void check_all_global_entities(Checker *c) {
 	Scope *prev_file = nullptr;
 
 	bool processing_preload = true;
-	for_array(i, c->info.entities.entries) {
-		auto *entry = &c->info.entities.entries[i];
+	for_array(i, c->info->entities.entries) {
+		auto *entry = &c->info->entities.entries[i];
 		Entity *e = cast(Entity *)entry->key.ptr;
 		DeclInfo *d = entry->value;
 
@@ -2194,8 +2754,8 @@ void check_all_global_entities(Checker *c) {
 		}
 	}
 
-	for_array(i, c->info.entities.entries) {
-		auto *entry = &c->info.entities.entries[i];
+	for_array(i, c->info->entities.entries) {
+		auto *entry = &c->info->entities.entries[i];
 		Entity *e = cast(Entity *)entry->key.ptr;
 		if (e->kind != Entity_Procedure) {
 			continue;
@@ -2285,7 +2845,7 @@ void add_import_dependency_node(Checker *c, AstNode *decl, Map<ImportGraphNode *
 				gb_printf_err("%.*s\n", LIT(scope->file->tokenizer.fullpath));
 			}
 			Token token = ast_node_token(decl);
-			gb_printf_err("%.*s(%td:%td)\n", LIT(token.pos.file), token.pos.line, token.pos.column);
+			gb_printf_err("%.*s(%d:%d)\n", LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column);
 			GB_PANIC("Unable to find scope for file: %.*s", LIT(path));
 		}
 		Scope *scope = *found;
@@ -2325,7 +2885,7 @@ void add_import_dependency_node(Checker *c, AstNode *decl, Map<ImportGraphNode *
 				gb_printf_err("%.*s\n", LIT(scope->file->tokenizer.fullpath));
 			}
 			Token token = ast_node_token(decl);
-			gb_printf_err("%.*s(%td:%td)\n", LIT(token.pos.file), token.pos.line, token.pos.column);
+			gb_printf_err("%.*s(%d:%d)\n", LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column);
 			GB_PANIC("Unable to find scope for file: %.*s", LIT(path));
 		}
 		Scope *scope = *found;
@@ -2481,7 +3041,7 @@ void check_add_import_decl(Checker *c, AstNodeImportDecl *id) {
 			Scope *scope = c->file_scopes.entries[scope_index].value;
 			gb_printf_err("%.*s\n", LIT(scope->file->tokenizer.fullpath));
 		}
-		gb_printf_err("%.*s(%td:%td)\n", LIT(token.pos.file), token.pos.line, token.pos.column);
+		gb_printf_err("%.*s(%d:%d)\n", LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column);
 		GB_PANIC("Unable to find scope for file: %.*s", LIT(id->fullpath));
 	}
 	Scope *scope = *found;
@@ -2526,7 +3086,7 @@ void check_add_import_decl(Checker *c, AstNodeImportDecl *id) {
 
 			bool implicit_is_found = map_get(&scope->implicit, hash_entity(e)) != nullptr;
 			if (is_entity_exported(e) && !implicit_is_found) {
-				Entity *prev = scope_lookup_entity(parent_scope, e->token.string);
+				Entity *prev = scope_lookup_entity(parent_scope, e->atom);
 				// if (prev) gb_printf_err("%.*s\n", LIT(prev->token.string));
 				bool ok = add_entity(c, parent_scope, e->identifier, e);
 				if (ok) map_set(&parent_scope->implicit, hash_entity(e), true);
@@ -2552,7 +3112,7 @@ void check_add_export_decl(Checker *c, AstNodeExportDecl *ed) {
 			Scope *scope = c->file_scopes.entries[scope_index].value;
 			gb_printf_err("%.*s\n", LIT(scope->file->tokenizer.fullpath));
 		}
-		gb_printf_err("%.*s(%td:%td)\n", LIT(token.pos.file), token.pos.line, token.pos.column);
+		gb_printf_err("%.*s(%d:%d)\n", LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column);
 		GB_PANIC("Unable to find scope for file: %.*s", LIT(ed->fullpath));
 	}
 	Scope *scope = *found;
@@ -2992,7 +3552,7 @@ Array<Entity *> find_entity_path(Map<DeclInfo *> *map, Entity *start, Entity *en
 
 
 void calculate_global_init_order(Checker *c) {
-	CheckerInfo *info = &c->info;
+	CheckerInfo *info = c->info;
 	auto *m = &info->entities;
 
 	Array<EntityGraphNode *> dep_graph = generate_entity_dependency_graph(info);
@@ -3070,20 +3630,396 @@ void calculate_global_init_order(Checker *c) {
 }
 
 
+void check_proc_job(Checker *c, CheckerJob *job) {
+	ProcedureInfo *pi = &job->proc;
+	if (pi->type == nullptr) {
+		return;
+	}
+	checker_set_curr_job(job);
+	defer (checker_set_curr_job(nullptr));
+
+	CheckerContext prev_context = c->context;
+	defer (c->context = prev_context);
+
+	TypeProc *pt = &pi->type->Proc;
+	String name = pi->token.string;
+	if (pt->is_polymorphic) {
+		GB_ASSERT_MSG(pt->is_poly_specialized, "%.*s", LIT(name));
+	}
+
+	add_curr_ast_file(c, pi->file);
+
+	bool bounds_check    = (pi->tags & ProcTag_bounds_check)    != 0;
+	bool no_bounds_check = (pi->tags & ProcTag_no_bounds_check) != 0;
+
+
+	if (bounds_check) {
+		c->context.stmt_state_flags |= StmtStateFlag_bounds_check;
+		c->context.stmt_state_flags &= ~StmtStateFlag_no_bounds_check;
+	} else if (no_bounds_check) {
+		c->context.stmt_state_flags |= StmtStateFlag_no_bounds_check;
+		c->context.stmt_state_flags &= ~StmtStateFlag_bounds_check;
+	}
+
+	check_proc_body(c, pi->token, pi->decl, pi->type, pi->body);
+}
+
+CheckerJob *check_worker_next_job(CheckerJobQueue *q) {
+	for (;;) {
+		gb_mutex_lock(&q->mutex);
+		if (q->curr_job_index < q->jobs.count) {
+			CheckerJob *job = q->jobs[q->curr_job_index++];
+			q->active_worker_count += 1;
+			gb_mutex_unlock(&q->mutex);
+			return job;
+		}
+		if (q->active_worker_count == 0) {
+			// Nothing is queued and nothing running could queue more
+			gb_mutex_unlock(&q->mutex);
+			gb_semaphore_release(&q->semaphore);
+			return nullptr;
+		}
+		q->idle_worker_count += 1;
+		gb_mutex_unlock(&q->mutex);
+		gb_semaphore_wait(&q->semaphore);
+	}
+}
+
+void check_worker_finish_job(CheckerJobQueue *q, CheckerJob *job) {
+	gb_mutex_lock(&q->mutex);
+	for_array(i, job->spawned) {
+		array_add(&q->jobs, job->spawned[i]);
+	}
+	q->active_worker_count -= 1;
+	isize wake_count = gb_min(q->idle_worker_count, job->spawned.count);
+	if (q->active_worker_count == 0 && q->curr_job_index == q->jobs.count) {
+		wake_count = q->idle_worker_count;
+	}
+	q->idle_worker_count -= wake_count;
+	gb_mutex_unlock(&q->mutex);
+
+	if (wake_count > 0) {
+		gb_semaphore_post(&q->semaphore, cast(i32)wake_count);
+	}
+}
+
+void check_worker_loop(Checker *c) {
+	CheckerJobQueue *q = c->job_queue;
+	for (;;) {
+		CheckerJob *job = check_worker_next_job(q);
+		if (job == nullptr) {
+			break;
+		}
+		check_proc_job(c, job);
+		check_worker_finish_job(q, job);
+	}
+}
+
+GB_THREAD_PROC(check_worker_proc) {
+	Checker *c = cast(Checker *)thread->user_data;
+	check_worker_loop(c);
+	return 0;
+}
+
+GB_COMPARE_PROC(entity_id_cmp) {
+	Entity *x = *cast(Entity **)a;
+	Entity *y = *cast(Entity **)b;
+	return x->id < y->id ? -1 : x->id > y->id ? +1 : 0;
+}
+
+// Replays what each job logged in the order of the job keys, so the checker info
+// is the same whichever thread checked which procedure body and in whatever order
+void check_merge_jobs(Checker *c) {
+	CheckerInfo *info = c->info;
+	CheckerJobQueue *q = c->job_queue;
+	Array<CheckerJob *> jobs = q->jobs;
+	gb_sort_array(jobs.data, jobs.count, checker_job_cmp);
+
+	for_array(i, jobs) {
+		gbString errors = jobs[i]->errors;
+		if (errors != nullptr) {
+			gb_file_write(gb_file_get_standard(gbFileStandard_Error), errors, gb_string_length(errors));
+		}
+	}
+
+	// Renumber the entities as an id may appear in a mangled name. Only the declared
+	// entities are numbered in key order as the other entities a job allocates may depend on which
+	// job got to a specialization first, e.g. when the type of the specialization is checked again
+	u64 id = q->first_entity_id;
+	for_array(i, jobs) {
+		CheckerJob *job = jobs[i];
+		for_array(j, job->decls) {
+			job->decls[j].entity->id = ++id;
+		}
+		if (job->poly_struct != nullptr) {
+			job->poly_struct->id = ++id;
+		}
+	}
+	for_array(i, jobs) {
+		CheckerJob *job = jobs[i];
+		for_array(j, job->entities) {
+			Entity *e = job->entities[j];
+			if ((e->id & (1ull<<63)) != 0) {
+				e->id = ++id;
+			}
+		}
+	}
+	gb_atomic64_store(&global_entity_id, cast(i64)id);
+
+	for_array(i, jobs) {
+		CheckerJob *job = jobs[i];
+		for_array(j, job->definitions) {
+			// The identifiers of a polymorphic procedure's signature are defined again by each
+			// specialization and whether it is checked again may depend on which jobs have run, so the
+			// first definition is kept
+			CheckerJobDefinition *d = &job->definitions[j];
+			HashKey key = hash_node(d->identifier);
+			Entity *e = d->entity;
+			Entity **found = map_get(&info->definitions, key);
+			if (found == nullptr) {
+				map_set(&info->definitions, key, e);
+			} else {
+				e = *found;
+			}
+			CheckerNodeTable *t = checker_node_table(d->identifier);
+			if (t != nullptr) {
+				t->definitions[d->identifier->index] = e;
+			}
+		}
+		for_array(j, job->decls) {
+			CheckerJobDecl *d = &job->decls[j];
+			map_set(&info->entities, hash_entity(d->entity), d->decl);
+			d->entity->order_in_src = info->entities.entries.count;
+		}
+		if (job->poly_struct != nullptr) {
+			Entity *e = job->poly_struct;
+			e->token.string = job->poly_struct_name;
+			e->atom         = make_atom(job->poly_struct_name);
+			if (e->type->kind == Type_Named) {
+				e->type->Named.name = job->poly_struct_name;
+			}
+		}
+
+		ProcedureInfo *pi = &job->proc;
+		if (pi->type != nullptr && pi->body != nullptr && pi->decl->parent != nullptr) {
+			// NOTE(bill): Add the dependencies from the procedure literal (lambda)
+			DeclInfo *decl = pi->decl;
+			for_array(j, decl->deps.entries) {
+				Entity *e = decl->deps.entries[j].ptr;
+				ptr_set_add(&decl->parent->deps, e);
+			}
+		}
+		if (pi->decl != nullptr) {
+			map_set(&c->procs, hash_decl_info(pi->decl), *pi);
+		}
+	}
+	sharded_map_clear(&info->new_definitions);
+	sharded_map_clear(&info->new_entities);
+
+	for_array(i, info->gen_procs.entries) {
+		auto *found = &info->gen_procs.entries[i].value;
+		gb_sort_array(found->data, found->count, entity_id_cmp);
+	}
+	for_array(i, info->gen_types.entries) {
+		auto *found = &info->gen_types.entries[i].value;
+		gb_sort_array(found->data, found->count, entity_id_cmp);
+	}
+
+	for_array(i, jobs) {
+		CheckerJob *job = jobs[i];
+		for_array(j, job->type_infos) {
+			add_type_info_type(c, job->type_infos[j]);
+		}
+	}
+}
+
+// The copies of the checker used by the worker threads. The temporary arenas are
+// only allocated once as the bodies may be checked in many waves with `-lazy-check`
+Array<Checker> make_checker_workers(Checker *c) {
+	gbAllocator a = heap_allocator();
+	isize worker_count = gb_max(build_context.thread_count, 1) - 1;
+	Array<Checker> workers = {};
+	array_init_count(&workers, a, worker_count);
+	for_array(i, workers) {
+		Checker *w = &workers[i];
+		array_init(&w->proc_stack, a);
+		gb_arena_init_from_allocator(&w->tmp_arena, a, c->tmp_arena.total_size);
+	}
+	return workers;
+}
+
+void destroy_checker_workers(Array<Checker> *workers) {
+	for_array(i, *workers) {
+		Checker *w = &(*workers)[i];
+		gb_arena_free(&w->tmp_arena);
+		array_free(&w->proc_stack);
+	}
+	array_free(workers);
+}
+
+// `proc_indices` are indices into `c->procs`, the index is also the key of the job
+void check_proc_bodies(Checker *c, Array<Checker> workers, Array<isize> proc_indices) {
+	CheckerInfo *info = c->info;
+	gbAllocator a = heap_allocator();
+
+	CheckerJobQueue queue = {};
+	CheckerJobQueue *q = &queue;
+	gb_mutex_init(&q->mutex);
+	gb_semaphore_init(&q->semaphore);
+	array_init(&q->jobs, a, proc_indices.count);
+	map_init(&q->poly_structs, a);
+	q->first_entity_id = cast(u64)gb_atomic64_load(&global_entity_id);
+	for_array(i, proc_indices) {
+		isize index = proc_indices[i];
+		String key = make_checker_job_key(str_lit(""), "a%08llx", cast(unsigned long long)index);
+		array_add(&q->jobs, make_checker_job(key, c->procs.entries[index].value));
+	}
+	c->job_queue = q;
+
+	info->is_checking_jobs = true;
+	info->is_parallel      = workers.count > 0;
+	info->types.is_concurrent     = info->is_parallel;
+	info->uses.is_concurrent      = info->is_parallel;
+	info->scopes.is_concurrent    = info->is_parallel;
+	info->untyped.is_concurrent   = info->is_parallel;
+	info->implicits.is_concurrent = info->is_parallel;
+	info->new_definitions.is_concurrent = info->is_parallel;
+	info->new_entities.is_concurrent    = info->is_parallel;
+
+	// The main thread is a worker too
+	isize worker_count = workers.count;
+	Array<gbThread> threads = {};
+	array_init_count(&threads, a, worker_count);
+	for (isize i = 0; i < worker_count; i++) {
+		Checker *w = &workers[i];
+		Array<Type *> proc_stack = w->proc_stack;
+		gbArena       tmp_arena  = w->tmp_arena;
+		*w = *c;
+		w->proc_stack    = proc_stack;
+		w->tmp_arena     = tmp_arena;
+		w->tmp_allocator = gb_arena_allocator(&w->tmp_arena);
+
+		gb_thread_init(&threads[i]);
+		gb_thread_start(&threads[i], check_worker_proc, w);
+	}
+	check_worker_loop(c);
+	for (isize i = 0; i < worker_count; i++) {
+		gb_thread_join(&threads[i]);
+		gb_thread_destroy(&threads[i]);
+	}
+	array_free(&threads);
+
+	info->is_checking_jobs = false;
+	info->is_parallel      = false;
+	info->types.is_concurrent     = false;
+	info->uses.is_concurrent      = false;
+	info->scopes.is_concurrent    = false;
+	info->untyped.is_concurrent   = false;
+	info->implicits.is_concurrent = false;
+	info->new_definitions.is_concurrent = false;
+	info->new_entities.is_concurrent    = false;
+
+	check_merge_jobs(c);
+
+	c->job_queue = nullptr;
+	for_array(i, q->jobs) {
+		destroy_checker_job(q->jobs[i]);
+	}
+	map_destroy(&q->poly_structs);
+	array_free(&q->jobs);
+	gb_semaphore_destroy(&q->semaphore);
+	gb_mutex_destroy(&q->mutex);
+}
+
+bool is_proc_body_reachable(PtrSet<DeclInfo *> *reachable, PtrSet<DeclInfo *> *entity_decls, DeclInfo *d) {
+	for (; d != nullptr; d = d->parent) {
+		if (ptr_set_exists(reachable, d)) {
+			return true;
+		}
+		if (ptr_set_exists(entity_decls, d)) {
+			return false;
+		}
+	}
+	// A procedure literal which does not belong to an entity (e.g. a default value of a
+	// struct field) cannot be traced and so it is always checked
+	return true;
+}
+
+// `-lazy-check` only checks the bodies of the procedures reachable from the entry point
+// (and the runtime and exported procedures). The dependencies of a procedure are only known once its
+// body has been checked so the bodies are checked in waves until no more become reachable
+void check_reachable_proc_bodies(Checker *c, Array<Checker> workers) {
+	CheckerInfo *info = c->info;
+	gbAllocator a = heap_allocator();
+
+	PtrSet<DeclInfo *> entity_decls = {};
+	PtrSet<DeclInfo *> checked      = {};
+	ptr_set_init(&entity_decls, a);
+	ptr_set_init(&checked,      a);
+	defer (ptr_set_destroy(&entity_decls));
+	defer (ptr_set_destroy(&checked));
+	for_array(i, info->entities.entries) {
+		ptr_set_add(&entity_decls, info->entities.entries[i].value);
+	}
+
+	Array<isize> proc_indices = {};
+	array_init(&proc_indices, a);
+	defer (array_free(&proc_indices));
+
+	for (;;) {
+		PtrSet<Entity *> deps = generate_minimum_dependency_set(info, info->entry_point);
+		PtrSet<DeclInfo *> reachable = {};
+		ptr_set_init(&reachable, a);
+		for_array(i, deps.entries) {
+			DeclInfo *d = decl_info_of_entity(info, deps.entries[i].ptr);
+			if (d != nullptr) {
+				ptr_set_add(&reachable, d);
+			}
+		}
+
+		array_clear(&proc_indices);
+		for_array(i, c->procs.entries) {
+			DeclInfo *d = c->procs.entries[i].value.decl;
+			if (!ptr_set_exists(&checked, d) && is_proc_body_reachable(&reachable, &entity_decls, d)) {
+				array_add(&proc_indices, i);
+			}
+		}
+		ptr_set_destroy(&reachable);
+		ptr_set_destroy(&deps);
+
+		if (proc_indices.count == 0) {
+			break;
+		}
+		for_array(i, proc_indices) {
+			ptr_set_add(&checked, c->procs.entries[proc_indices[i]].value.decl);
+		}
+
+		isize prev_proc_count = c->procs.entries.count;
+		check_proc_bodies(c, workers, proc_indices);
+		// The nested procedures of the jobs have been added and checked too
+		for (isize i = prev_proc_count; i < c->procs.entries.count; i++) {
+			ptr_set_add(&checked, c->procs.entries[i].value.decl);
+		}
+	}
+}
+
 void check_parsed_files(Checker *c) {
 	add_type_info_type(c, t_invalid);
 
 	// Map full filepaths to Scopes
 	for_array(i, c->parser->files) {
 		AstFile *f = c->parser->files[i];
+		f->node_table = make_checker_node_table(f->node_count+1);
+		array_add(&c->info->node_tables, f->node_table);
+
 		Scope *scope = create_scope_from_file(c, f);
 		f->decl_info = make_declaration_info(c->allocator, f->scope, c->context.decl);
 		HashKey key = hash_string(f->tokenizer.fullpath);
 		map_set(&c->file_scopes, key, scope);
-		map_set(&c->info.files, key, f);
+		map_set(&c->info->files, key, f);
 
 		if (scope->is_init) {
-			c->info.init_scope = scope;
+			c->info->init_scope = scope;
 		}
 	}
 
@@ -3100,56 +4036,40 @@ void check_parsed_files(Checker *c) {
 	check_all_global_entities(c);
 	init_preload(c); // NOTE(bill): This could be setup previously through the use of `type_info_of`
 
-	// Check procedure bodies
-	// NOTE(bill): Nested procedures bodies will be added to this "queue"
-	for_array(i, c->procs.entries) {
-		ProcedureInfo *pi = &c->procs.entries[i].value;
-		if (pi->type == nullptr) {
-			continue;
-		}
-		CheckerContext prev_context = c->context;
-		defer (c->context = prev_context);
-
-		TypeProc *pt = &pi->type->Proc;
-		String name = pi->token.string;
-		if (pt->is_polymorphic) {
-			GB_ASSERT_MSG(pt->is_poly_specialized, "%.*s", LIT(name));
-		}
-
-		add_curr_ast_file(c, pi->file);
-
-		bool bounds_check    = (pi->tags & ProcTag_bounds_check)    != 0;
-		bool no_bounds_check = (pi->tags & ProcTag_no_bounds_check) != 0;
-
-
-		if (bounds_check) {
-			c->context.stmt_state_flags |= StmtStateFlag_bounds_check;
-			c->context.stmt_state_flags &= ~StmtStateFlag_no_bounds_check;
-		} else if (no_bounds_check) {
-			c->context.stmt_state_flags |= StmtStateFlag_no_bounds_check;
-			c->context.stmt_state_flags &= ~StmtStateFlag_bounds_check;
+	Array<Checker> workers = make_checker_workers(c);
+	if (build_context.lazy_check) {
+		check_reachable_proc_bodies(c, workers);
+	} else {
+		Array<isize> proc_indices = {};
+		array_init_count(&proc_indices, heap_allocator(), c->procs.entries.count);
+		for_array(i, proc_indices) {
+			proc_indices[i] = i;
 		}
-
-		check_proc_body(c, pi->token, pi->decl, pi->type, pi->body);
+		check_proc_bodies(c, workers, proc_indices);
+		array_free(&proc_indices);
 	}
+	destroy_checker_workers(&workers);
 
-	c->info.minimum_dependency_set = generate_minimum_dependency_set(&c->info, c->info.entry_point);
+	c->info->minimum_dependency_set = generate_minimum_dependency_set(c->info, c->info->entry_point);
 
 
 	// Calculate initialization order of global variables
 	calculate_global_init_order(c);
 
 	// Add untyped expression values
-	for_array(i, c->info.untyped.entries) {
-		auto *entry = &c->info.untyped.entries[i];
-		HashKey key = entry->key;
-		AstNode *expr = cast(AstNode *)key.ptr;
-		ExprInfo *info = &entry->value;
-		if (info != nullptr && expr != nullptr) {
-			if (is_type_typed(info->type)) {
-				compiler_error("%s (type %s) is typed!", expr_to_string(expr), type_to_string(info->type));
+	for (isize shard_index = 0; shard_index < SHARDED_MAP_SHARD_COUNT; shard_index++) {
+		auto *untyped = &c->info->untyped.shards[shard_index].map;
+		for_array(i, untyped->entries) {
+			auto *entry = &untyped->entries[i];
+			HashKey key = entry->key;
+			AstNode *expr = cast(AstNode *)key.ptr;
+			ExprInfo *info = &entry->value;
+			if (info != nullptr && expr != nullptr) {
+				if (is_type_typed(info->type)) {
+					compiler_error("%s (type %s) is typed!", expr_to_string(expr), type_to_string(info->type));
+				}
+				add_type_and_value(c->info, expr, info->mode, info->type, info->value);
 			}
-			add_type_and_value(&c->info, expr, info->mode, info->type, info->value);
 		}
 	}
 
@@ -3165,8 +4085,8 @@ void check_parsed_files(Checker *c) {
 	}
 
 	// NOTE(bill): Check for illegal cyclic type declarations
-	for_array(i, c->info.definitions.entries) {
-		Entity *e = c->info.definitions.entries[i].value;
+	for_array(i, c->info->definitions.entries) {
+		Entity *e = c->info->definitions.entries[i].value;
 		if (e->kind == Entity_TypeName && e->type != nullptr) {
 			// i64 size  = type_size_of(c->sizes, c->allocator, e->type);
 			i64 align = type_align_of(c->allocator, e->type);
@@ -3177,18 +4097,18 @@ void check_parsed_files(Checker *c) {
 	}
 
 	if (!build_context.is_dll) {
-		Scope *s = c->info.init_scope;
+		Scope *s = c->info->init_scope;
 		GB_ASSERT(s != nullptr);
 		GB_ASSERT(s->is_init);
 		Entity *e = current_scope_lookup_entity(s, str_lit("main"));
 		if (e == nullptr) {
 			Token token = {};
 			if (s->file->tokens.count > 0) {
-				token = s->file->tokens[0];
+				token = ast_file_token(s->file, 0);
 			} else {
-				token.pos.file   = s->file->tokenizer.fullpath;
-				token.pos.line   = 1;
-				token.pos.column = 1;
+				token.pos.file_id = s->file->tokenizer.file_id;
+				token.pos.line    = 1;
+				token.pos.column  = 1;
 			}
 
 			error(token, "Undefined entry point procedure `main`");
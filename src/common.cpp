@@ -6,6 +6,11 @@
 #define GB_IMPLEMENTATION
 #include "gb/gb.h"
 
+#if defined(GB_CPU_X86)
+// SSE2 is always available on x86-64
+#include <emmintrin.h>
+#endif
+
 
 #include <wchar.h>
 #include <stdio.h>
@@ -112,9 +117,35 @@ u128 fnv128a(void const *data, isize len) {
 	return h;
 }
 
+// Index of the lowest set bit, `x` must not be zero
+gb_inline i32 bit_scan_forward(u32 x) {
+	GB_ASSERT(x != 0);
+#if defined(GB_COMPILER_MSVC)
+	unsigned long index = 0;
+	_BitScanForward(&index, x);
+	return cast(i32)index;
+#else
+	return cast(i32)__builtin_ctz(x);
+#endif
+}
+
+// Index of the highest set bit, `x` must not be zero
+gb_inline i32 bit_scan_reverse(u32 x) {
+	GB_ASSERT(x != 0);
+#if defined(GB_COMPILER_MSVC)
+	unsigned long index = 0;
+	_BitScanReverse(&index, x);
+	return cast(i32)index;
+#else
+	return 31 - cast(i32)__builtin_clz(x);
+#endif
+}
+
 #include "map.cpp"
 #include "ptr_set.cpp"
 #include "priority_queue.cpp"
+#include "atom.cpp"
+#include "region.cpp"
 
 
 
@@ -178,7 +209,7 @@ void pool_free_all(Pool *p) {
 	for_array(i, p->used_memblock) {
 		array_add(&p->unused_memblock, p->used_memblock[i]);
 	}
-	array_clear(&p->unused_memblock);
+	array_clear(&p->used_memblock);
 
 	for_array(i, p->out_of_band_allocations) {
 		gb_free(p->block_allocator, p->out_of_band_allocations[i]);
@@ -213,34 +244,33 @@ void pool_cycle_new_block(Pool *p) {
 
 	p->bytes_left       = p->memblock_size;
 	p->current_memblock = new_block;
-	p->current_memblock = new_block;
+	p->current_pos      = new_block;
 }
 
 void *pool_get(Pool *p,
                isize size, isize alignment = 0) {
 	if (alignment <= 0) alignment = p->alignment;
 
-	isize extra = alignment - (size & alignment);
-	size += extra;
 	if (size >= p->out_of_band_size) {
 		GB_ASSERT(p->block_allocator.proc != nullptr);
-		u8 *memory = cast(u8 *)gb_alloc_align(p->block_allocator, p->memblock_size, alignment);
+		u8 *memory = cast(u8 *)gb_alloc_align(p->block_allocator, size, alignment);
 		if (memory != nullptr) {
 			array_add(&p->out_of_band_allocations, memory);
 		}
 		return memory;
 	}
 
-	if (p->bytes_left < size) {
+	// The padding is at most `alignment-1` bytes
+	if (p->current_memblock == nullptr || p->bytes_left < size+alignment-1) {
 		pool_cycle_new_block(p);
-		if (p->current_memblock != nullptr) {
+		if (p->current_memblock == nullptr) {
 			return nullptr;
 		}
 	}
 
-	u8 *res = p->current_pos;
-	p->current_pos += size;
-	p->bytes_left  -= size;
+	u8 *res = cast(u8 *)gb_align_forward(p->current_pos, alignment);
+	p->bytes_left -= (res + size) - p->current_pos;
+	p->current_pos = res + size;
 	return res;
 }
 
@@ -253,7 +283,12 @@ GB_ALLOCATOR_PROC(pool_allocator_procedure) {
 
 	switch (type) {
 	case gbAllocation_Alloc:
-		return pool_get(p, size, alignment);
+		ptr = pool_get(p, size, alignment);
+		// A block may be reused after `pool_free_all`
+		if (ptr != nullptr && (flags & gbAllocatorFlag_ClearToZero) != 0) {
+			gb_zero_size(ptr, size);
+		}
+		break;
 	case gbAllocation_Free:
 		// Does nothing
 		break;
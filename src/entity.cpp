@@ -62,6 +62,7 @@ struct Entity {
 	u64        id;
 	u32        flags;
 	Token      token;
+	Atom *     atom; // Of `token.string`
 	Scope *    scope;
 	Type *     type;
 	AstNode *  identifier; // Can be nullptr
@@ -155,15 +156,25 @@ bool is_entity_exported(Entity *e) {
 	return name[0] != '_';
 }
 
-gb_global u64 global_entity_id = 0;
+// Procedure bodies are checked in parallel and may use the same global entity at once
+void entity_set_used(Entity *e) {
+	gb_atomic32_fetch_or(cast(gbAtomic32 volatile *)&e->flags, EntityFlag_Used);
+}
+
+gb_global gbAtomic64 global_entity_id = {}; // Atomic as the IR procedure jobs make entities in parallel
+
+bool add_entity_to_checker_job(Entity *entity);
 
 Entity *alloc_entity(gbAllocator a, EntityKind kind, Scope *scope, Token token, Type *type) {
 	Entity *entity = gb_alloc_item(a, Entity);
 	entity->kind   = kind;
 	entity->scope  = scope;
 	entity->token  = token;
+	entity->atom   = make_atom(token.string);
 	entity->type   = type;
-	entity->id     = ++global_entity_id;
+	if (!add_entity_to_checker_job(entity)) {
+		entity->id = cast(u64)gb_atomic64_fetch_add(&global_entity_id, 1) + 1;
+	}
 	return entity;
 }
 
@@ -976,7 +976,7 @@ typedef struct gbThread {
 
 	gbSemaphore   semaphore;
 	isize         stack_size;
-	b32           is_running;
+	b32           is_running; // Started and not yet joined, only the thread which started it writes this
 } gbThread;
 
 GB_DEF void gb_thread_init            (gbThread *t);
@@ -4669,14 +4669,12 @@ gb_inline void gb__thread_run(gbThread *t) {
 	gb_inline DWORD __stdcall gb__thread_proc(void *arg) {
 		gbThread *t = cast(gbThread *)arg;
 		gb__thread_run(t);
-		t->is_running = false;
 		return 0;
 	}
 #else
 	gb_inline void *          gb__thread_proc(void *arg) {
 		gbThread *t = cast(gbThread *)arg;
 		gb__thread_run(t);
-		t->is_running = false;
 		return NULL;
 	}
 #endif
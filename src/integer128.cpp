@@ -5,6 +5,12 @@
 	#pragma intrinsic(_mul128)
 #endif
 
+// Define BIT128_PORTABLE to always use the 64-bit limb arithmetic
+#if defined(__SIZEOF_INT128__) && defined(GB_ARCH_64_BIT) && !defined(BIT128_PORTABLE)
+	#define BIT128_NATIVE
+	typedef unsigned __int128 bit128_native;
+#endif
+
 #define BIT128_U64_HIGHBIT 0x8000000000000000ull
 #define BIT128_U64_BITS62  0x7fffffffffffffffull
 #define BIT128_U64_ALLBITS 0xffffffffffffffffull
@@ -140,6 +146,25 @@ i128 operator>>(i128 const &a, u32 b)         { return i128_shr(a, b); }
 
 ////////////////////////////////////////////////////////////////
 
+#if defined(BIT128_NATIVE)
+// The signed operations are done unsigned too, as they wrap the same way in two's complement
+gb_inline bit128_native u128_to_native(u128 a) { return (cast(bit128_native)a.hi << 64) | a.lo; }
+gb_inline bit128_native i128_to_native(i128 a) { return (cast(bit128_native)cast(u64)a.hi << 64) | a.lo; }
+
+gb_inline u128 u128_from_native(bit128_native n) {
+	u128 r = {};
+	r.lo = cast(u64)n;
+	r.hi = cast(u64)(n >> 64);
+	return r;
+}
+gb_inline i128 i128_from_native(bit128_native n) {
+	i128 r = {};
+	r.lo = cast(u64)n;
+	r.hi = cast(i64)cast(u64)(n >> 64);
+	return r;
+}
+#endif
+
 
 u64 bit128__digit_value(Rune r) {
 	if ('0' <= r && r <= '9') {
@@ -374,6 +399,9 @@ bool u128_le(u128 a, u128 b) { return !u128_gt(a, b); }
 bool u128_ge(u128 a, u128 b) { return !u128_lt(a, b); }
 
 u128 u128_add(u128 a, u128 b) {
+#if defined(BIT128_NATIVE)
+	return u128_from_native(u128_to_native(a) + u128_to_native(b));
+#else
 	u128 old_a = a;
 	a.lo += b.lo;
 	a.hi += b.hi;
@@ -381,14 +409,23 @@ u128 u128_add(u128 a, u128 b) {
 		a.hi += 1;
 	}
 	return a;
+#endif
 }
 u128 u128_not(u128 a) { return u128_lo_hi(~a.lo, ~a.hi); }
 
 u128 u128_neg(u128 a) {
+#if defined(BIT128_NATIVE)
+	return u128_from_native(-u128_to_native(a));
+#else
 	return u128_add(u128_not(a), u128_from_u64(1));
+#endif
 }
 u128 u128_sub(u128 a, u128 b) {
+#if defined(BIT128_NATIVE)
+	return u128_from_native(u128_to_native(a) - u128_to_native(b));
+#else
 	return u128_add(a, u128_neg(b));
+#endif
 }
 u128 u128_and(u128 a, u128 b) { return u128_lo_hi(a.lo&b.lo, a.hi&b.hi); }
 u128 u128_or (u128 a, u128 b) { return u128_lo_hi(a.lo|b.lo, a.hi|b.hi); }
@@ -400,7 +437,9 @@ u128 u128_shl(u128 a, u32 n) {
 	if (n >= 128) {
 		return u128_lo_hi(0, 0);
 	}
-#if 0 && defined(MSVC_AMD64_INTRINSICS)
+#if defined(BIT128_NATIVE)
+	return u128_from_native(u128_to_native(a) << n);
+#elif 0 && defined(MSVC_AMD64_INTRINSICS)
 	a.hi = __shiftleft128(a.lo, a.hi, n);
 	a.lo = a.lo << n;
 	return a;
@@ -426,7 +465,9 @@ u128 u128_shr(u128 a, u32 n) {
 	if (n >= 128) {
 		return u128_lo_hi(0, 0);
 	}
-#if 0 && defined(MSVC_AMD64_INTRINSICS)
+#if defined(BIT128_NATIVE)
+	return u128_from_native(u128_to_native(a) >> n);
+#elif 0 && defined(MSVC_AMD64_INTRINSICS)
 	a.lo = __shiftright128(a.lo, a.hi, n);
 	a.hi = a.hi >> n;
 	return a;
@@ -462,7 +503,9 @@ u128 u128_mul(u128 a, u128 b) {
 	}
 
 
-#if defined(MSVC_AMD64_INTRINSICS)
+#if defined(BIT128_NATIVE)
+	return u128_from_native(u128_to_native(a) * u128_to_native(b));
+#elif defined(MSVC_AMD64_INTRINSICS)
 	if (a.hi == 0 && b.hi == 0) {
 		a.lo = _umul128(a.lo, b.lo, &a.hi);
 		return a;
@@ -491,6 +534,13 @@ void u128_divide(u128 a, u128 b, u128 *quo, u128 *rem) {
 		if (rem) *rem = U128_ZERO;
 		return;
 	}
+#if defined(BIT128_NATIVE)
+	bit128_native n = u128_to_native(a);
+	bit128_native m = u128_to_native(b);
+	if (quo) *quo = u128_from_native(n / m);
+	if (rem) *rem = u128_from_native(n % m);
+	return;
+#endif
 	u128 r = a;
 	u128 d = b;
 	u128 x = U128_ONE;
@@ -560,6 +610,9 @@ bool i128_le(i128 a, i128 b) { return a.hi == b.hi ? a.lo <= b.lo : a.hi <= b.hi
 bool i128_ge(i128 a, i128 b) { return a.hi == b.hi ? a.lo >= b.lo : a.hi >= b.hi; }
 
 i128 i128_add(i128 a, i128 b) {
+#if defined(BIT128_NATIVE)
+	return i128_from_native(i128_to_native(a) + i128_to_native(b));
+#else
 	i128 old_a = a;
 	a.lo += b.lo;
 	a.hi += b.hi;
@@ -567,14 +620,23 @@ i128 i128_add(i128 a, i128 b) {
 		a.hi += 1;
 	}
 	return a;
+#endif
 }
 i128 i128_not(i128 a) { return i128_lo_hi(~a.lo, ~a.hi); }
 
 i128 i128_neg(i128 a) {
+#if defined(BIT128_NATIVE)
+	return i128_from_native(-i128_to_native(a));
+#else
 	return i128_add(i128_not(a), i128_from_u64(1));
+#endif
 }
 i128 i128_sub(i128 a, i128 b) {
+#if defined(BIT128_NATIVE)
+	return i128_from_native(i128_to_native(a) - i128_to_native(b));
+#else
 	return i128_add(a, i128_neg(b));
+#endif
 }
 i128 i128_and(i128 a, i128 b) { return i128_lo_hi(a.lo&b.lo, a.hi&b.hi); }
 i128 i128_or (i128 a, i128 b) { return i128_lo_hi(a.lo|b.lo, a.hi|b.hi); }
@@ -587,7 +649,9 @@ i128 i128_shl(i128 a, u32 n) {
 		return i128_lo_hi(0, 0);
 	}
 
-#if 0 && defined(MSVC_AMD64_INTRINSICS)
+#if defined(BIT128_NATIVE)
+	return i128_from_native(i128_to_native(a) << n);
+#elif 0 && defined(MSVC_AMD64_INTRINSICS)
 	a.hi = __shiftleft128(a.lo, a.hi, n);
 	a.lo = a.lo << n;
 	return a;
@@ -649,7 +713,9 @@ i128 i128_mul(i128 a, i128 b) {
 		return a;
 	}
 
-#if defined(MSVC_AMD64_INTRINSICS)
+#if defined(BIT128_NATIVE)
+	return i128_from_native(i128_to_native(a) * i128_to_native(b));
+#elif defined(MSVC_AMD64_INTRINSICS)
 	if (a.hi == 0 && b.hi == 0) {
 		a.lo = _mul128(a.lo, b.lo, &a.hi);
 		return a;
@@ -705,6 +771,22 @@ void i128_divide(i128 a, i128 b, i128 *quo_, i128 *rem_) {
 		}
 		quo_sign *= rem_sign;
 
+	#if defined(BIT128_NATIVE)
+		// The long division below compares the remainder signed, which is only exact
+		// whilst twice the divisor fits, so only then may it be done natively
+		if (0 <= b.hi && b.hi < 0x4000000000000000ll) {
+			bit128_native n = i128_to_native(a);
+			bit128_native m = i128_to_native(b);
+			iquo = i128_from_native(n / m);
+			irem = i128_from_native(n % m);
+			if (quo_sign < 0) iquo = i128_neg(iquo);
+			if (rem_sign < 0) irem = i128_neg(irem);
+			if (quo_) *quo_ = iquo;
+			if (rem_) *rem_ = irem;
+			return;
+		}
+	#endif
+
 		iquo = a;
 
 		for (isize i = 0; i < 128; i++) {
@@ -2,12 +2,35 @@ struct irProcedure;
 struct irBlock;
 struct irValue;
 struct irDebugInfo;
+struct irModule;
 
 
+// What a procedure job did to the module that depends upon the order in which the
+// procedures are built. They are replayed by `ir_merge_proc_job_chunk` in the order of the jobs.
+enum irMergeOpKind {
+	irMergeOp_Invalid,
+
+	irMergeOp_Member,           // Add `value` to `members` as `name`
+	irMergeOp_ForeignMember,    // Add `value` to `members` as `name` if there is no member with that name
+	irMergeOp_ConstantSlice,    // Name the backing array `value` with `global_array_index`
+	irMergeOp_AnonymousProcLit, // Name the procedure `value` with the count of `anonymous_proc_lits`
+	irMergeOp_ProcToGenerate,   // Add `value` to `procs_to_generate`
+	irMergeOp_LocalTypeName,    // Name the type `entity` declared in procedure `name` with the count of `members`
+
+	irMergeOp_Count,
+};
+
+struct irMergeOp {
+	irMergeOpKind kind;
+	String        name;
+	irValue *     value;
+	Entity *      entity;
+	AstNode *     expr;
+};
+
 
 struct irModule {
 	CheckerInfo * info;
-	gbArena       arena;
 	gbArena       tmp_arena;
 	gbAllocator   allocator;
 	gbAllocator   tmp_allocator;
@@ -43,6 +66,12 @@ struct irModule {
 	Array<irValue *>      procs_to_generate; // NOTE(bill): Procedures to generate
 
 	Array<String>         foreign_library_paths; // Only the ones that were used
+
+	// Only set for the module of a procedure job (see `ir_build_proc_jobs`). Anything
+	// that is not found in the job's maps is looked up in `main_module`, which does not change
+	// whilst the jobs are running
+	irModule *            main_module;
+	Array<irMergeOp>      merge_ops;
 };
 
 // NOTE(bill): For more info, see https://en.wikipedia.org/wiki/Dominator_(graph_theory)
@@ -134,6 +163,10 @@ struct irProcedure {
 
 	Array<irBranchBlocks> branch_blocks;
 
+	// The shared cold block which reports a failed bounds check, the arguments are its phi nodes
+	irBlock *             bounds_check_block;
+	irValue *             bounds_check_args[5];
+
 	i32                   local_count;
 	i32                   instr_count;
 	i32                   block_count;
@@ -867,6 +900,61 @@ void ir_add_entity_name(irModule *m, Entity *e, String name) {
 	map_set(&m->entity_names, hash_entity(e), name);
 }
 
+irValue **ir_module_find_value(irModule *m, Entity *e) {
+	HashKey key = hash_entity(e);
+	irValue **found = map_get(&m->values, key);
+	if (found == nullptr && m->main_module != nullptr) {
+		found = map_get(&m->main_module->values, key);
+	}
+	return found;
+}
+
+irValue **ir_module_find_member(irModule *m, String name) {
+	HashKey key = hash_string(name);
+	irValue **found = map_get(&m->members, key);
+	if (found == nullptr && m->main_module != nullptr) {
+		found = map_get(&m->main_module->members, key);
+	}
+	return found;
+}
+
+irDebugInfo **ir_module_find_debug_info(irModule *m, HashKey key) {
+	irDebugInfo **found = map_get(&m->debug_info, key);
+	if (found == nullptr && m->main_module != nullptr) {
+		found = map_get(&m->main_module->debug_info, key);
+	}
+	return found;
+}
+
+void ir_add_merge_op(irModule *m, irMergeOpKind kind, irValue *value, String name = {}, Entity *entity = nullptr, AstNode *expr = nullptr) {
+	GB_ASSERT(m->main_module != nullptr);
+	irMergeOp op = {kind, name, value, entity, expr};
+	array_add(&m->merge_ops, op);
+}
+
+void ir_module_add_member(irModule *m, String name, irValue *value) {
+	map_set(&m->members, hash_string(name), value);
+	if (m->main_module != nullptr) {
+		ir_add_merge_op(m, irMergeOp_Member, value, name);
+	}
+}
+
+// Only the first declaration of a foreign entity is a member
+void ir_module_add_foreign_member(irModule *m, String name, irValue *value) {
+	map_set(&m->members, hash_string(name), value);
+	if (m->main_module != nullptr) {
+		ir_add_merge_op(m, irMergeOp_ForeignMember, value, name);
+	}
+}
+
+void ir_module_add_proc_to_generate(irModule *m, irValue *value) {
+	if (m->main_module != nullptr) {
+		ir_add_merge_op(m, irMergeOp_ProcToGenerate, value);
+	} else {
+		array_add(&m->procs_to_generate, value);
+	}
+}
+
 
 
 
@@ -1184,7 +1272,7 @@ irValue *ir_generate_array(irModule *m, Type *elem_type, i64 count, String prefi
 	irValue *value = ir_value_global(a, e, nullptr);
 	value->Global.is_private = true;
 	ir_module_add_value(m, e, value);
-	map_set(&m->members, hash_string(s), value);
+	ir_module_add_member(m, s, value);
 	return value;
 }
 
@@ -1257,6 +1345,14 @@ irDefer ir_add_defer_instr(irProcedure *proc, isize scope_index, irValue *instr)
 
 
 
+String ir_constant_slice_name(irModule *m) {
+	isize max_len = 7+8+1;
+	u8 *str = cast(u8 *)gb_alloc_array(m->allocator, u8, max_len);
+	isize len = gb_snprintf(cast(char *)str, max_len, "__csba$%x", m->global_array_index);
+	m->global_array_index++;
+	return make_string(str, len-1);
+}
+
 irValue *ir_add_module_constant(irModule *m, Type *type, ExactValue value) {
 	gbAllocator a = m->allocator;
 	// gbAllocator a = gb_heap_allocator();
@@ -1272,18 +1368,20 @@ irValue *ir_add_module_constant(irModule *m, Type *type, ExactValue value) {
 		Type *t = make_type_array(a, elem, count);
 		irValue *backing_array = ir_add_module_constant(m, t, value);
 
-
-		isize max_len = 7+8+1;
-		u8 *str = cast(u8 *)gb_alloc_array(a, u8, max_len);
-		isize len = gb_snprintf(cast(char *)str, max_len, "__csba$%x", m->global_array_index);
-		m->global_array_index++;
-
-		String name = make_string(str, len-1);
+		String name = {};
+		if (m->main_module == nullptr) {
+			name = ir_constant_slice_name(m);
+		}
 
 		Entity *e = make_entity_constant(a, nullptr, make_token_ident(name), t, value);
 		irValue *g = ir_value_global(a, e, backing_array);
 		ir_module_add_value(m, e, g);
-		map_set(&m->members, hash_string(name), g);
+		if (m->main_module == nullptr) {
+			map_set(&m->members, hash_string(name), g);
+		} else {
+			// Named when the job is merged as the name depends upon the order
+			ir_add_merge_op(m, irMergeOp_ConstantSlice, g);
+		}
 
 		return ir_value_constant_slice(a, type, g, count);
 	}
@@ -1335,7 +1433,7 @@ irValue *ir_add_local(irProcedure *proc, Entity *e, AstNode *expr, bool zero_ini
 	}
 
 	if (expr != nullptr && proc->entity != nullptr) {
-		irDebugInfo *di = *map_get(&proc->module->debug_info, hash_entity(proc->entity));
+		irDebugInfo *di = *ir_module_find_debug_info(proc->module, hash_entity(proc->entity));
 		ir_emit(proc, ir_instr_debug_declare(proc, di, expr, e, true, instr));
 	}
 
@@ -1348,8 +1446,7 @@ irValue *ir_add_local_for_identifier(irProcedure *proc, AstNode *name, bool zero
 		ir_emit_comment(proc, e->token.string);
 		if (e->kind == Entity_Variable &&
 		    e->Variable.is_foreign) {
-			HashKey key = hash_string(e->token.string);
-			irValue **prev_value = map_get(&proc->module->members, key);
+			irValue **prev_value = ir_module_find_member(proc->module, e->token.string);
 			if (prev_value == nullptr) {
 				// NOTE(bill): Don't do mutliple declarations in the IR
 				irValue *g = ir_value_global(proc->module->allocator, e, nullptr);
@@ -1357,7 +1454,7 @@ irValue *ir_add_local_for_identifier(irProcedure *proc, AstNode *name, bool zero
 				g->Global.name = e->token.string;
 				g->Global.is_foreign = true;
 				ir_module_add_value(proc->module, e, g);
-				map_set(&proc->module->members, key, g);
+				ir_module_add_foreign_member(proc->module, e->token.string, g);
 				return g;
 			} else {
 				return *prev_value;
@@ -1604,7 +1701,7 @@ irValue *ir_emit_call(irProcedure *p, irValue *value, irValue **args, isize arg_
 
 irValue *ir_emit_global_call(irProcedure *proc, char *name_, irValue **args, isize arg_count) {
 	String name = make_string_c(name_);
-	irValue **found = map_get(&proc->module->members, hash_string(name));
+	irValue **found = ir_module_find_member(proc->module, name);
 	GB_ASSERT_MSG(found != nullptr, "%.*s", LIT(name));
 	irValue *gp = *found;
 	return ir_emit_call(proc, gp, args, arg_count);
@@ -2798,12 +2895,16 @@ irValue *ir_add_local_slice(irProcedure *proc, Type *slice_type, irValue *base,
 
 
 irValue *ir_find_or_add_entity_string(irModule *m, String str) {
-	irValue **found = map_get(&m->const_strings, hash_string(str));
+	HashKey key = hash_string(str);
+	irValue **found = map_get(&m->const_strings, key);
+	if (found == nullptr && m->main_module != nullptr) {
+		found = map_get(&m->main_module->const_strings, key);
+	}
 	if (found != nullptr) {
 		return *found;
 	}
 	irValue *v = ir_const_string(m->allocator, str);
-	map_set(&m->const_strings, hash_string(str), v);
+	map_set(&m->const_strings, key, v);
 	return v;
 
 }
@@ -3315,7 +3416,7 @@ irValue *ir_emit_union_cast(irProcedure *proc, irValue *value, Type *type, Token
 		irValue **args = gb_alloc_array(a, irValue *, 6);
 		args[0] = ok;
 
-		args[1] = ir_find_or_add_entity_string(proc->module, pos.file);
+		args[1] = ir_find_or_add_entity_string(proc->module, token_pos_file(pos));
 		args[2] = ir_const_int(a, pos.line);
 		args[3] = ir_const_int(a, pos.column);
 
@@ -3374,7 +3475,7 @@ irAddr ir_emit_any_cast_addr(irProcedure *proc, irValue *value, Type *type, Toke
 		irValue **args = gb_alloc_array(a, irValue *, 6);
 		args[0] = ok;
 
-		args[1] = ir_find_or_add_entity_string(proc->module, pos.file);
+		args[1] = ir_find_or_add_entity_string(proc->module, token_pos_file(pos));
 		args[2] = ir_const_int(a, pos.line);
 		args[3] = ir_const_int(a, pos.column);
 
@@ -3482,6 +3583,40 @@ irValue *ir_emit_logical_binary_expr(irProcedure *proc, AstNode *expr) {
 }
 
 
+irBlock *ir_bounds_check_block(irProcedure *proc) {
+	if (proc->bounds_check_block == nullptr) {
+		gbAllocator a = proc->module->allocator;
+		irBlock *b = ir_new_block(proc, nullptr, "bounds.check.fail");
+		Type *types[gb_count_of(proc->bounds_check_args)] = {t_string, t_int, t_int, t_int, t_int};
+		for (isize i = 0; i < gb_count_of(proc->bounds_check_args); i++) {
+			Array<irValue *> edges = {};
+			array_init(&edges, a);
+			irValue *phi = ir_instr_phi(proc, edges, types[i]);
+			phi->Instr.parent = b;
+			array_add(&b->instrs, phi);
+			proc->bounds_check_args[i] = phi;
+		}
+		proc->bounds_check_block = b;
+	}
+	return proc->bounds_check_block;
+}
+
+// Emitted at the end of the procedure so that the failure path is out of line
+void ir_emit_bounds_check_block(irProcedure *proc) {
+	irBlock *b = proc->bounds_check_block;
+	if (b == nullptr || b->preds.count == 0) {
+		return;
+	}
+	isize arg_count = gb_count_of(proc->bounds_check_args);
+	irValue **args = gb_alloc_array(proc->module->allocator, irValue *, arg_count);
+	gb_memmove(args, proc->bounds_check_args, arg_count*gb_size_of(irValue *));
+
+	ir_start_block(proc, b);
+	ir_emit_global_call(proc, "__bounds_check_error", args, arg_count);
+	ir_emit_unreachable(proc);
+	ir_start_block(proc, nullptr);
+}
+
 void ir_emit_bounds_check(irProcedure *proc, Token token, irValue *index, irValue *len) {
 	if ((proc->module->stmt_state_flags & StmtStateFlag_no_bounds_check) != 0) {
 		return;
@@ -3491,18 +3626,24 @@ void ir_emit_bounds_check(irProcedure *proc, Token token, irValue *index, irValu
 	len = ir_emit_conv(proc, len, t_int);
 
 	gbAllocator a = proc->module->allocator;
-	irValue *file = ir_find_or_add_entity_string(proc->module, token.pos.file);
+	irValue *file = ir_find_or_add_entity_string(proc->module, token_pos_file(token.pos));
 	irValue *line = ir_const_int(a, token.pos.line);
 	irValue *column = ir_const_int(a, token.pos.column);
 
-	irValue **args = gb_alloc_array(a, irValue *, 5);
-	args[0] = file;
-	args[1] = line;
-	args[2] = column;
-	args[3] = index;
-	args[4] = len;
+	// A negative index is a large unsigned one so a single unsigned comparison checks both bounds
+	irValue *ok = ir_emit_comp(proc, Token_Lt, ir_emit_conv(proc, index, t_uint), ir_emit_conv(proc, len, t_uint));
 
-	ir_emit_global_call(proc, "__bounds_check_error", args, 5);
+	irBlock *done = ir_new_block(proc, nullptr, "bounds.check.done");
+	irBlock *fail = ir_bounds_check_block(proc);
+	isize pred_count = fail->preds.count;
+	ir_emit_if(proc, ok, done, fail);
+	if (fail->preds.count > pred_count) {
+		irValue *args[gb_count_of(proc->bounds_check_args)] = {file, line, column, index, len};
+		for (isize i = 0; i < gb_count_of(args); i++) {
+			array_add(&proc->bounds_check_args[i]->Instr.Phi.edges, args[i]);
+		}
+	}
+	ir_start_block(proc, done);
 
 	// ir_emit(proc, ir_instr_bounds_check(proc, token.pos, index, len));
 }
@@ -3513,7 +3654,7 @@ void ir_emit_slice_bounds_check(irProcedure *proc, Token token, irValue *low, ir
 	}
 
 	gbAllocator a = proc->module->allocator;
-	irValue *file = ir_find_or_add_entity_string(proc->module, token.pos.file);
+	irValue *file = ir_find_or_add_entity_string(proc->module, token_pos_file(token.pos));
 	irValue *line = ir_const_int(a, token.pos.line);
 	irValue *column = ir_const_int(a, token.pos.column);
 	low  = ir_emit_conv(proc, low,  t_int);
@@ -3669,9 +3810,7 @@ void ir_pop_target_list(irProcedure *proc) {
 
 
 
-irValue *ir_gen_anonymous_proc_lit(irModule *m, String prefix_name, AstNode *expr, irProcedure *proc = nullptr) {
-	ast_node(pl, ProcLit, expr);
-
+void ir_add_anonymous_proc_lit(irModule *m, String prefix_name, AstNode *expr, irValue *value) {
 	// NOTE(bill): Generate a new name
 	// parent$count
 	isize name_len = prefix_name.len + 1 + 8 + 1;
@@ -3680,22 +3819,36 @@ irValue *ir_gen_anonymous_proc_lit(irModule *m, String prefix_name, AstNode *exp
 
 	name_len = gb_snprintf(cast(char *)name_text, name_len, "%.*s$anon-%d", LIT(prefix_name), name_id);
 	String name = make_string(name_text, name_len-1);
+	value->Proc.name = name;
+
+	array_add(&m->procs_to_generate, value);
+	if (value->Proc.parent == nullptr) {
+		map_set(&m->members, hash_string(name), value);
+	}
+
+	map_set(&m->anonymous_proc_lits, hash_pointer(expr), value);
+}
+
+irValue *ir_gen_anonymous_proc_lit(irModule *m, String prefix_name, AstNode *expr, irProcedure *proc = nullptr) {
+	ast_node(pl, ProcLit, expr);
 
 	Type *type = type_of_expr(m->info, expr);
 	irValue *value = ir_value_procedure(m->allocator,
-	                                    m, nullptr, type, pl->type, pl->body, name);
+	                                    m, nullptr, type, pl->type, ast_proc_lit_body(expr), str_lit(""));
 
 	value->Proc.tags = pl->tags;
 	value->Proc.parent = proc;
 
-	array_add(&m->procs_to_generate, value);
 	if (proc != nullptr) {
 		array_add(&proc->children, &value->Proc);
-	} else {
-		map_set(&m->members, hash_string(name), value);
 	}
 
-	map_set(&m->anonymous_proc_lits, hash_pointer(expr), value);
+	if (m->main_module != nullptr) {
+		// Named when the job is merged as the name depends upon the order
+		ir_add_merge_op(m, irMergeOp_AnonymousProcLit, value, prefix_name, nullptr, expr);
+	} else {
+		ir_add_anonymous_proc_lit(m, prefix_name, expr, value);
+	}
 
 	return value;
 }
@@ -3825,7 +3978,7 @@ irValue *ir_emit_clamp(irProcedure *proc, Type *t, irValue *x, irValue *min, irV
 
 
 irValue *ir_find_global_variable(irProcedure *proc, String name) {
-	irValue **value = map_get(&proc->module->members, hash_string(name));
+	irValue **value = ir_module_find_member(proc->module, name);
 	GB_ASSERT_MSG(value != nullptr, "Unable to find global variable `%.*s`", LIT(name));
 	return *value;
 }
@@ -3848,7 +4001,7 @@ bool is_double_pointer(Type *t) {
 irValue *ir_emit_source_code_location(irProcedure *proc, String procedure, TokenPos pos) {
 	gbAllocator a = proc->module->allocator;
 	irValue **args = gb_alloc_array(a, irValue *, 4);
-	args[0] = ir_find_or_add_entity_string(proc->module, pos.file);
+	args[0] = ir_find_or_add_entity_string(proc->module, token_pos_file(pos));
 	args[1] = ir_const_i64(a, pos.line);
 	args[2] = ir_const_i64(a, pos.column);
 	args[3] = ir_find_or_add_entity_string(proc->module, procedure);
@@ -4267,8 +4420,8 @@ irValue *ir_build_builtin_proc(irProcedure *proc, AstNode *expr, TypeAndValue tv
 		Type *type = ir_type(array_ptr);
 		{
 			TokenPos pos = ast_node_token(ce->args[0]).pos;
-			GB_ASSERT_MSG(is_type_pointer(type), "%.*s(%td) %s",
-			              LIT(pos.file), pos.line,
+			GB_ASSERT_MSG(is_type_pointer(type), "%.*s(%d) %s",
+			              LIT(token_pos_file(pos)), pos.line,
 			              type_to_string(type));
 		}
 		type = base_type(type_deref(type));
@@ -4621,12 +4774,12 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 	switch (expr->kind) {
 	case_ast_node(bl, BasicLit, expr);
 		TokenPos pos = bl->pos;
-		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(pos.file), pos.line, pos.column, LIT(token_strings[bl->kind]));
+		GB_PANIC("Non-constant basic literal %.*s(%d:%d) - %.*s", LIT(token_pos_file(pos)), pos.line, pos.column, LIT(token_strings[bl->kind]));
 	case_end;
 
 	case_ast_node(bd, BasicDirective, expr);
 		TokenPos pos = bd->token.pos;
-		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(pos.file), pos.line, pos.column, LIT(bd->name));
+		GB_PANIC("Non-constant basic literal %.*s(%d:%d) - %.*s", LIT(token_pos_file(pos)), pos.line, pos.column, LIT(bd->name));
 	case_end;
 
 	case_ast_node(i, Implicit, expr);
@@ -4643,14 +4796,14 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 		if (e->kind == Entity_Builtin) {
 			Token token = ast_node_token(expr);
 			GB_PANIC("TODO(bill): ir_build_single_expr Entity_Builtin `%.*s`\n"
-			         "\t at %.*s(%td:%td)", LIT(builtin_procs[e->Builtin.id].name),
-			         LIT(token.pos.file), token.pos.line, token.pos.column);
+			         "\t at %.*s(%d:%d)", LIT(builtin_procs[e->Builtin.id].name),
+			         LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column);
 			return nullptr;
 		} else if (e->kind == Entity_Nil) {
 			return ir_value_nil(proc->module->allocator, tv.type);
 		}
 
-		irValue **found = map_get(&proc->module->values, hash_entity(e));
+		irValue **found = ir_module_find_value(proc->module, e);
 		if (found) {
 			irValue *v = *found;
 			if (v->kind == irValue_Proc) {
@@ -5095,7 +5248,7 @@ irValue *ir_get_using_variable(irProcedure *proc, Entity *e) {
 	Entity *parent = e->using_parent;
 	Selection sel = lookup_field(proc->module->allocator, parent->type, name, false);
 	GB_ASSERT(sel.entity != nullptr);
-	irValue **pv = map_get(&proc->module->values, hash_entity(parent));
+	irValue **pv = ir_module_find_value(proc->module, parent);
 	irValue *v = nullptr;
 	if (pv != nullptr) {
 		v = *pv;
@@ -5125,7 +5278,7 @@ irAddr ir_build_addr_from_entity(irProcedure *proc, Entity *e, AstNode *expr) {
 	GB_ASSERT(e->kind != Entity_Constant);
 
 	irValue *v = nullptr;
-	irValue **found = map_get(&proc->module->values, hash_entity(e));
+	irValue **found = ir_module_find_value(proc->module, e);
 	if (found) {
 		v = *found;
 	} else if (e->kind == Entity_Variable && e->flags & EntityFlag_Using) {
@@ -5799,9 +5952,9 @@ irAddr ir_build_addr(irProcedure *proc, AstNode *expr) {
 	TokenPos token_pos = ast_node_token(expr).pos;
 	GB_PANIC("Unexpected address expression\n"
 	         "\tAstNode: %.*s @ "
-	         "%.*s(%td:%td)\n",
+	         "%.*s(%d:%d)\n",
 	         LIT(ast_node_strings[expr->kind]),
-	         LIT(token_pos.file), token_pos.line, token_pos.column);
+	         LIT(token_pos_file(token_pos)), token_pos.line, token_pos.column);
 
 
 	return ir_addr(nullptr);
@@ -5854,8 +6007,9 @@ irValue *ir_build_cond(irProcedure *proc, AstNode *cond, irBlock *true_block, ir
 	return v;
 }
 
-void ir_build_poly_proc(irProcedure *proc, AstNodeProcLit *pd, Entity *e) {
-	GB_ASSERT(pd->body != nullptr);
+void ir_build_poly_proc(irProcedure *proc, AstNode *proc_lit, Entity *e) {
+	ast_node(pd, ProcLit, proc_lit);
+	GB_ASSERT(ast_proc_lit_has_body(proc_lit));
 
 	if (ptr_set_exists(&proc->module->min_dep_set, e) == false) {
 		// NOTE(bill): Nothing depends upon it so doesn't need to be built
@@ -5878,18 +6032,33 @@ void ir_build_poly_proc(irProcedure *proc, AstNodeProcLit *pd, Entity *e) {
 
 
 	irValue *value = ir_value_procedure(proc->module->allocator,
-	                                    proc->module, e, e->type, pd->type, pd->body, name);
+	                                    proc->module, e, e->type, pd->type, ast_proc_lit_body(proc_lit), name);
 
 	value->Proc.tags = pd->tags;
 	value->Proc.parent = proc;
 
 	ir_module_add_value(proc->module, e, value);
 	array_add(&proc->children, &value->Proc);
-	array_add(&proc->module->procs_to_generate, value);
+	ir_module_add_proc_to_generate(proc->module, value);
 }
 
 
 
+void ir_gen_local_type_name(irModule *m, String parent_name, Entity *e) {
+	// NOTE(bill): Generate a new name
+	// parent_proc.name-guid
+	String ts_name = e->token.string;
+
+	isize name_len = parent_name.len + 1 + ts_name.len + 1 + 10 + 1;
+	u8 *name_text = gb_alloc_array(m->allocator, u8, name_len);
+	i32 guid = cast(i32)m->members.entries.count;
+	name_len = gb_snprintf(cast(char *)name_text, name_len, "%.*s.%.*s-%d", LIT(parent_name), LIT(ts_name), guid);
+	String name = make_string(name_text, name_len-1);
+
+	map_set(&m->entity_names, hash_entity(e), name);
+	ir_gen_global_type_name(m, e, name);
+}
+
 void ir_build_constant_value_decl(irProcedure *proc, AstNodeValueDecl *vd) {
 	if (vd == nullptr || vd->is_mutable) {
 		return;
@@ -5908,8 +6077,6 @@ void ir_build_constant_value_decl(irProcedure *proc, AstNodeValueDecl *vd) {
 			continue;
 		}
 
-		String entity_name = e->token.string;
-
 		if (e->kind == Entity_TypeName) {
 			bool polymorphic_struct = false;
 			if (e->type != nullptr && e->kind == Entity_TypeName) {
@@ -5923,26 +6090,18 @@ void ir_build_constant_value_decl(irProcedure *proc, AstNodeValueDecl *vd) {
 				continue;
 			}
 
-			// NOTE(bill): Generate a new name
-			// parent_proc.name-guid
-			String ts_name = entity_name;
-
-			isize name_len = proc->name.len + 1 + ts_name.len + 1 + 10 + 1;
-			u8 *name_text = gb_alloc_array(proc->module->allocator, u8, name_len);
-			i32 guid = cast(i32)proc->module->members.entries.count;
-			name_len = gb_snprintf(cast(char *)name_text, name_len, "%.*s.%.*s-%d", LIT(proc->name), LIT(ts_name), guid);
-			String name = make_string(name_text, name_len-1);
-
-			irValue *value = ir_value_type_name(proc->module->allocator,
-			                                           name, e->type);
-			map_set(&proc->module->entity_names, hash_entity(e), name);
-			ir_gen_global_type_name(proc->module, e, name);
+			if (proc->module->main_module != nullptr) {
+				// Named when the job is merged as the name depends upon the order
+				ir_add_merge_op(proc->module, irMergeOp_LocalTypeName, nullptr, proc->name, e);
+			} else {
+				ir_gen_local_type_name(proc->module, proc->name, e);
+			}
 
 		} else if (e->kind == Entity_Procedure) {
 			CheckerInfo *info = proc->module->info;
 			DeclInfo *decl = decl_info_of_entity(info, e);
 			ast_node(pl, ProcLit, decl->proc_lit);
-			if (pl->body != nullptr) {
+			if (ast_proc_lit_has_body(decl->proc_lit)) {
 				auto *found = map_get(&info->gen_procs, hash_pointer(ident));
 				if (found) {
 					auto procs = *found;
@@ -5952,10 +6111,10 @@ void ir_build_constant_value_decl(irProcedure *proc, AstNodeValueDecl *vd) {
 							continue;
 						}
 						DeclInfo *d = decl_info_of_entity(info, e);
-						ir_build_poly_proc(proc, &d->proc_lit->ProcLit, e);
+						ir_build_poly_proc(proc, d->proc_lit, e);
 					}
 				} else {
-					ir_build_poly_proc(proc, pl, e);
+					ir_build_poly_proc(proc, decl->proc_lit, e);
 				}
 			} else {
 
@@ -5975,11 +6134,10 @@ void ir_build_constant_value_decl(irProcedure *proc, AstNodeValueDecl *vd) {
 				ir_build_proc(value, proc);
 
 				if (value->Proc.tags & ProcTag_foreign) {
-					HashKey key = hash_string(name);
-					irValue **prev_value = map_get(&proc->module->members, key);
+					irValue **prev_value = ir_module_find_member(proc->module, name);
 					if (prev_value == nullptr) {
 						// NOTE(bill): Don't do mutliple declarations in the IR
-						map_set(&proc->module->members, key, value);
+						ir_module_add_foreign_member(proc->module, name, value);
 					}
 				} else {
 					array_add(&proc->children, &value->Proc);
@@ -7320,6 +7478,8 @@ void ir_end_procedure_body(irProcedure *proc) {
 		ir_emit_unreachable(proc);
 	}
 
+	ir_emit_bounds_check_block(proc);
+
 	proc->curr_block = proc->decl_block;
 	ir_emit_jump(proc, proc->entry_block);
 	proc->curr_block = nullptr;
@@ -7345,11 +7505,11 @@ void ir_build_proc(irValue *value, irProcedure *parent) {
 		irModule *m = proc->module;
 		CheckerInfo *info = m->info;
 		Entity *e = proc->entity;
-		String filename = e->token.pos.file;
+		String filename = token_pos_file(e->token.pos);
 		AstFile *f = ast_file_of_filename(info, filename);
 		irDebugInfo *di_file = nullptr;
 
-		irDebugInfo **di_file_found = map_get(&m->debug_info, hash_ast_file(f));
+		irDebugInfo **di_file_found = ir_module_find_debug_info(m, hash_ast_file(f));
 		if (di_file_found) {
 			di_file = *di_file_found;
 			GB_ASSERT(di_file->kind == irDebugInfo_File);
@@ -7427,12 +7587,10 @@ void ir_init_module(irModule *m, Checker *c) {
 	// TODO(bill): Determine a decent size for the arena
 	isize token_count = c->parser->total_token_count;
 	isize arena_size = 4 * token_count * gb_size_of(irValue);
-	gb_arena_init_from_allocator(&m->arena,     heap_allocator(), arena_size);
 	gb_arena_init_from_allocator(&m->tmp_arena, heap_allocator(), arena_size);
-	// m->allocator     = gb_arena_allocator(&m->arena);
-	m->allocator     = heap_allocator();
+	m->allocator     = region_allocator(Region_Ir);
 	m->tmp_allocator = gb_arena_allocator(&m->tmp_arena);
-	m->info = &c->info;
+	m->info = c->info;
 
 	map_init(&m->values,                  heap_allocator());
 	map_init(&m->members,                 heap_allocator());
@@ -7553,7 +7711,8 @@ void ir_destroy_module(irModule *m) {
 	array_free(&m->procs);
 	array_free(&m->procs_to_generate);
 	array_free(&m->foreign_library_paths);
-	gb_arena_free(&m->arena);
+	gb_arena_free(&m->tmp_arena);
+	region_release(Region_Ir);
 }
 
 
@@ -7655,6 +7814,252 @@ void ir_add_foreign_library_path(irModule *m, Entity *e) {
 }
 
 
+////////////////////////////////////////////////////////////////
+//
+// @Procedure Jobs
+//
+////////////////////////////////////////////////////////////////
+
+// A wave of procedure jobs is built in parallel. The jobs are split into chunks of
+// consecutive jobs and each chunk is built in order into its own module. The chunks are merged
+// back in order once the whole wave is built so the module is the same as if the procedures had
+// been built one after the other. A chunk does not see what the other chunks of its wave add,
+// which is fine as a procedure is only queued by the procedure it is within.
+struct irProcJob {
+	irValue *    value;
+	irProcedure *parent;
+};
+
+struct irProcJobChunk {
+	isize    lo, hi; // Indices into the jobs of the wave
+	irModule module;
+};
+
+struct irProcJobQueue {
+	irModule *            main_module;
+	Array<irProcJob>      jobs;
+	Array<irProcJobChunk> chunks;
+	gbAtomic64            next_chunk;
+};
+
+struct irProcWorker {
+	irProcJobQueue *queue;
+	gbArena         tmp_arena;
+	gbThread        thread;
+};
+
+
+void ir_init_job_module(irModule *jm, irModule *m, gbArena *tmp_arena) {
+	gbAllocator a = heap_allocator();
+	jm->info                   = m->info;
+	jm->allocator              = m->allocator;
+	jm->tmp_arena              = *tmp_arena;
+	jm->tmp_allocator          = gb_arena_allocator(&jm->tmp_arena);
+	jm->stmt_state_flags       = m->stmt_state_flags;
+	jm->layout                 = m->layout;
+	jm->min_dep_set            = m->min_dep_set;
+	jm->global_default_context = m->global_default_context;
+	jm->entry_point_entity     = m->entry_point_entity;
+	jm->main_module            = m;
+
+	map_init(&jm->values,        a);
+	map_init(&jm->members,       a);
+	map_init(&jm->debug_info,    a);
+	map_init(&jm->entity_names,  a);
+	map_init(&jm->const_strings, a);
+	array_init(&jm->procs,       a);
+	array_init(&jm->merge_ops,   a);
+}
+
+void ir_destroy_job_module(irModule *jm) {
+	map_destroy(&jm->values);
+	map_destroy(&jm->members);
+	map_destroy(&jm->debug_info);
+	map_destroy(&jm->entity_names);
+	map_destroy(&jm->const_strings);
+	array_free(&jm->procs);
+	array_free(&jm->merge_ops);
+}
+
+void ir_merge_proc_job_chunk(irModule *m, irProcJobQueue *q, irProcJobChunk *chunk) {
+	irModule *jm = &chunk->module;
+	for (isize i = chunk->lo; i < chunk->hi; i++) {
+		q->jobs[i].value->Proc.module = m;
+	}
+
+	for_array(i, jm->values.entries) {
+		auto *entry = &jm->values.entries[i];
+		irValue *v = entry->value;
+		switch (v->kind) {
+		case irValue_Instr:
+		case irValue_Param:
+			// The locals and parameters are only looked up by their own procedure
+			continue;
+		case irValue_Proc:
+			if (v->Proc.module == jm) {
+				v->Proc.module = m;
+			}
+			break;
+		}
+		map_set(&m->values, entry->key, v);
+	}
+
+	for_array(i, jm->debug_info.entries) {
+		auto *entry = &jm->debug_info.entries[i];
+		irDebugInfo *di = entry->value;
+		if (di->kind == irDebugInfo_File) {
+			if (map_get(&m->debug_info, entry->key) != nullptr) {
+				// Added by a previous chunk
+				continue;
+			}
+		} else if (di->kind == irDebugInfo_Proc) {
+			di->Proc.file = *map_get(&m->debug_info, hash_ast_file(di->Proc.file->File.file));
+		}
+		map_set(&m->debug_info, entry->key, di);
+	}
+
+	for_array(i, jm->entity_names.entries) {
+		auto *entry = &jm->entity_names.entries[i];
+		map_set(&m->entity_names, entry->key, entry->value);
+	}
+
+	for_array(i, jm->const_strings.entries) {
+		auto *entry = &jm->const_strings.entries[i];
+		if (map_get(&m->const_strings, entry->key) == nullptr) {
+			map_set(&m->const_strings, entry->key, entry->value);
+		}
+	}
+
+	for_array(i, jm->merge_ops) {
+		irMergeOp *op = &jm->merge_ops[i];
+		irValue *v = op->value;
+		if (v != nullptr && v->kind == irValue_Proc) {
+			v->Proc.module = m;
+		}
+
+		switch (op->kind) {
+		case irMergeOp_Member:
+			map_set(&m->members, hash_string(op->name), v);
+			break;
+		case irMergeOp_ForeignMember:
+			if (map_get(&m->members, hash_string(op->name)) == nullptr) {
+				map_set(&m->members, hash_string(op->name), v);
+			}
+			break;
+		case irMergeOp_ConstantSlice: {
+			String name = ir_constant_slice_name(m);
+			v->Global.entity->token.string = name;
+			map_set(&m->members, hash_string(name), v);
+			break;
+		}
+		case irMergeOp_AnonymousProcLit:
+			ir_add_anonymous_proc_lit(m, op->name, op->expr, v);
+			break;
+		case irMergeOp_ProcToGenerate:
+			array_add(&m->procs_to_generate, v);
+			break;
+		case irMergeOp_LocalTypeName:
+			ir_gen_local_type_name(m, op->name, op->entity);
+			break;
+		default:
+			GB_PANIC("Unknown irMergeOpKind %d", op->kind);
+			break;
+		}
+	}
+
+	for_array(i, jm->procs) {
+		array_add(&m->procs, jm->procs[i]);
+	}
+}
+
+void ir_proc_worker_loop(irProcJobQueue *q, gbArena *tmp_arena) {
+	for (;;) {
+		isize index = cast(isize)gb_atomic64_fetch_add(&q->next_chunk, 1);
+		if (index >= q->chunks.count) {
+			break;
+		}
+		irProcJobChunk *chunk = &q->chunks[index];
+		ir_init_job_module(&chunk->module, q->main_module, tmp_arena);
+		for (isize i = chunk->lo; i < chunk->hi; i++) {
+			irProcJob *job = &q->jobs[i];
+			job->value->Proc.module = &chunk->module;
+			ir_build_proc(job->value, job->parent);
+		}
+	}
+}
+
+GB_THREAD_PROC(ir_proc_worker_proc) {
+	irProcWorker *w = cast(irProcWorker *)thread->user_data;
+	ir_proc_worker_loop(w->queue, &w->tmp_arena);
+	return 0;
+}
+
+// The main thread is a worker too. A job only uses the temporary arena for the duration
+// of a statement so the arenas of the other workers are much smaller than the module's
+Array<irProcWorker> ir_make_proc_workers(irModule *m) {
+	gbAllocator a = heap_allocator();
+	isize worker_count = gb_max(build_context.thread_count, 1) - 1;
+	isize arena_size = gb_min(m->tmp_arena.total_size, gb_megabytes(1));
+	Array<irProcWorker> workers = {};
+	array_init_count(&workers, a, worker_count);
+	for_array(i, workers) {
+		gb_arena_init_from_allocator(&workers[i].tmp_arena, a, arena_size);
+	}
+	return workers;
+}
+
+void ir_destroy_proc_workers(Array<irProcWorker> *workers) {
+	for_array(i, *workers) {
+		gb_arena_free(&(*workers)[i].tmp_arena);
+	}
+	array_free(workers);
+}
+
+enum {
+	IR_PROC_JOB_CHUNK_MIN_COUNT   = 8, // Smaller chunks cost more to merge than they save
+	IR_PROC_JOB_CHUNKS_PER_THREAD = 4, // So a thread with the larger procedures does not hold up the rest
+};
+
+void ir_build_proc_jobs(irModule *m, Array<irProcWorker> workers, Array<irProcJob> jobs) {
+	isize chunk_count = gb_min(jobs.count/IR_PROC_JOB_CHUNK_MIN_COUNT, IR_PROC_JOB_CHUNKS_PER_THREAD*(workers.count+1));
+	if (workers.count == 0 || chunk_count < 2) {
+		for_array(i, jobs) {
+			ir_build_proc(jobs[i].value, jobs[i].parent);
+		}
+		return;
+	}
+
+	irProcJobQueue queue = {};
+	queue.main_module = m;
+	queue.jobs        = jobs;
+
+	array_init_count(&queue.chunks, heap_allocator(), chunk_count);
+	for_array(i, queue.chunks) {
+		queue.chunks[i].lo = jobs.count*i/chunk_count;
+		queue.chunks[i].hi = jobs.count*(i+1)/chunk_count;
+	}
+
+	isize worker_count = gb_min(workers.count, chunk_count-1);
+	for (isize i = 0; i < worker_count; i++) {
+		irProcWorker *w = &workers[i];
+		w->queue = &queue;
+		gb_thread_init(&w->thread);
+		gb_thread_start(&w->thread, ir_proc_worker_proc, w);
+	}
+	ir_proc_worker_loop(&queue, &m->tmp_arena);
+	for (isize i = 0; i < worker_count; i++) {
+		gb_thread_join(&workers[i].thread);
+		gb_thread_destroy(&workers[i].thread);
+	}
+
+	for_array(i, queue.chunks) {
+		ir_merge_proc_job_chunk(m, &queue, &queue.chunks[i]);
+		ir_destroy_job_module(&queue.chunks[i].module);
+	}
+	array_free(&queue.chunks);
+}
+
+
 void ir_gen_tree(irGen *s) {
 	irModule *m = &s->module;
 	CheckerInfo *info = m->info;
@@ -7733,7 +8138,7 @@ void ir_gen_tree(irGen *s) {
 			String name = e->token.string;
 			String original_name = name;
 			if (!e->scope->is_global) {
-				name = ir_mangle_name(s, e->token.pos.file, e);
+				name = ir_mangle_name(s, token_pos_file(e->token.pos), e);
 			}
 			ir_add_entity_name(m, e, name);
 
@@ -7818,10 +8223,10 @@ void ir_gen_tree(irGen *s) {
 				// Handle later
 			// } else if (scope->is_init && e->kind == Entity_Procedure && name == "main") {
 			} else {
-				name = ir_mangle_name(s, e->token.pos.file, e);
+				name = ir_mangle_name(s, token_pos_file(e->token.pos), e);
 			}
 		} else if (check_is_entity_overloaded(e)) {
-			name = ir_mangle_name(s, e->token.pos.file, e);
+			name = ir_mangle_name(s, token_pos_file(e->token.pos), e);
 		}
 		ir_add_entity_name(m, e, name);
 
@@ -7834,7 +8239,7 @@ void ir_gen_tree(irGen *s) {
 		case Entity_Procedure: {
 			ast_node(pl, ProcLit, decl->proc_lit);
 			String original_name = name;
-			AstNode *body = pl->body;
+			AstNode *body = ast_proc_lit_body(decl->proc_lit);
 
 			if (e->Procedure.is_foreign) {
 				name = e->token.string; // NOTE(bill): Don't use the mangled name
@@ -7859,12 +8264,23 @@ void ir_gen_tree(irGen *s) {
 		}
 	}
 
-	for_array(i, m->members.entries) {
-		auto *entry = &m->members.entries[i];
-		irValue *v = entry->value;
-		if (v->kind == irValue_Proc) {
-			ir_build_proc(v, nullptr);
+	Array<irProcWorker> workers = ir_make_proc_workers(m);
+	Array<irProcJob> jobs = {};
+	array_init(&jobs, heap_allocator());
+
+	// The procedures that become members whilst these are built are built in the next wave
+	for (isize start = 0; start < m->members.entries.count; ) {
+		isize end = m->members.entries.count;
+		array_clear(&jobs);
+		for (isize i = start; i < end; i++) {
+			irValue *v = m->members.entries[i].value;
+			if (v->kind == irValue_Proc) {
+				irProcJob job = {v, nullptr};
+				array_add(&jobs, job);
+			}
 		}
+		ir_build_proc_jobs(m, workers, jobs);
+		start = end;
 	}
 
 	irDebugInfo *compile_unit = m->debug_info.entries[0].value;
@@ -8567,10 +8983,20 @@ void ir_gen_tree(irGen *s) {
 
 
 
-	for_array(i, m->procs_to_generate) {
-		irValue *p = m->procs_to_generate[i];
-		ir_build_proc(p, p->Proc.parent);
+	// Each wave builds the procedures queued by the previous one
+	for (isize start = 0; start < m->procs_to_generate.count; ) {
+		isize end = m->procs_to_generate.count;
+		array_clear(&jobs);
+		for (isize i = start; i < end; i++) {
+			irValue *p = m->procs_to_generate[i];
+			irProcJob job = {p, p->Proc.parent};
+			array_add(&jobs, job);
+		}
+		ir_build_proc_jobs(m, workers, jobs);
+		start = end;
 	}
+	array_free(&jobs);
+	ir_destroy_proc_workers(&workers);
 
 	// Number debug info
 	for_array(i, m->debug_info.entries) {
@@ -1,69 +1,84 @@
 // Optimizations for the IR code
 
-void ir_opt_add_operands(Array<irValue *> *ops, irInstr *i) {
+// Adds a pointer to each operand so that a pass may replace the operand in place
+void ir_opt_add_operands(Array<irValue **> *ops, irInstr *i) {
 	switch (i->kind) {
 	case irInstr_Comment:
 		break;
 	case irInstr_Local:
 		break;
 	case irInstr_ZeroInit:
-		array_add(ops, i->ZeroInit.address);
+		array_add(ops, &i->ZeroInit.address);
 		break;
 	case irInstr_Store:
-		array_add(ops, i->Store.address);
-		array_add(ops, i->Store.value);
+		array_add(ops, &i->Store.address);
+		array_add(ops, &i->Store.value);
 		break;
 	case irInstr_Load:
-		array_add(ops, i->Load.address);
+		array_add(ops, &i->Load.address);
 		break;
 	case irInstr_ArrayElementPtr:
-		array_add(ops, i->ArrayElementPtr.address);
-		array_add(ops, i->ArrayElementPtr.elem_index);
+		array_add(ops, &i->ArrayElementPtr.address);
+		array_add(ops, &i->ArrayElementPtr.elem_index);
 		break;
 	case irInstr_StructElementPtr:
-		array_add(ops, i->StructElementPtr.address);
+		array_add(ops, &i->StructElementPtr.address);
 		break;
 	case irInstr_PtrOffset:
-		array_add(ops, i->PtrOffset.address);
-		array_add(ops, i->PtrOffset.offset);
+		array_add(ops, &i->PtrOffset.address);
+		array_add(ops, &i->PtrOffset.offset);
 		break;
 	case irInstr_StructExtractValue:
-		array_add(ops, i->StructExtractValue.address);
+		array_add(ops, &i->StructExtractValue.address);
+		break;
+	case irInstr_UnionTagPtr:
+		array_add(ops, &i->UnionTagPtr.address);
+		break;
+	case irInstr_UnionTagValue:
+		array_add(ops, &i->UnionTagValue.address);
 		break;
 	case irInstr_Conv:
-		array_add(ops, i->Conv.value);
+		array_add(ops, &i->Conv.value);
 		break;
 	case irInstr_Jump:
 		break;
 	case irInstr_If:
-		array_add(ops, i->If.cond);
+		array_add(ops, &i->If.cond);
 		break;
 	case irInstr_Return:
 		if (i->Return.value != nullptr) {
-			array_add(ops, i->Return.value);
+			array_add(ops, &i->Return.value);
 		}
 		break;
 	case irInstr_Select:
-		array_add(ops, i->Select.cond);
+		array_add(ops, &i->Select.cond);
+		array_add(ops, &i->Select.true_value);
+		array_add(ops, &i->Select.false_value);
 		break;
 	case irInstr_Phi:
 		for_array(j, i->Phi.edges) {
-			array_add(ops, i->Phi.edges[j]);
+			array_add(ops, &i->Phi.edges[j]);
 		}
 		break;
 	case irInstr_Unreachable:
 		break;
 	case irInstr_UnaryOp:
-		array_add(ops, i->UnaryOp.expr);
+		array_add(ops, &i->UnaryOp.expr);
 		break;
 	case irInstr_BinaryOp:
-		array_add(ops, i->BinaryOp.left);
-		array_add(ops, i->BinaryOp.right);
+		array_add(ops, &i->BinaryOp.left);
+		array_add(ops, &i->BinaryOp.right);
 		break;
 	case irInstr_Call:
-		array_add(ops, i->Call.value);
+		array_add(ops, &i->Call.value);
+		if (i->Call.return_ptr != nullptr) {
+			array_add(ops, &i->Call.return_ptr);
+		}
 		for (isize j = 0; j < i->Call.arg_count; j++) {
-			array_add(ops, i->Call.args[j]);
+			array_add(ops, &i->Call.args[j]);
+		}
+		if (i->Call.context_ptr != nullptr) {
+			array_add(ops, &i->Call.context_ptr);
 		}
 		break;
 	// case irInstr_VectorExtractElement:
@@ -80,15 +95,18 @@ void ir_opt_add_operands(Array<irValue *> *ops, irInstr *i) {
 		// break;
 	case irInstr_StartupRuntime:
 		break;
+	case irInstr_DebugDeclare:
+		array_add(ops, &i->DebugDeclare.value);
+		break;
 
 	#if 0
 	case irInstr_BoundsCheck:
-		array_add(ops, i->BoundsCheck.index);
-		array_add(ops, i->BoundsCheck.len);
+		array_add(ops, &i->BoundsCheck.index);
+		array_add(ops, &i->BoundsCheck.len);
 		break;
 	case irInstr_SliceBoundsCheck:
-		array_add(ops, i->SliceBoundsCheck.low);
-		array_add(ops, i->SliceBoundsCheck.high);
+		array_add(ops, &i->SliceBoundsCheck.low);
+		array_add(ops, &i->SliceBoundsCheck.high);
 		break;
 	#endif
 	}
@@ -276,7 +294,18 @@ void ir_opt_blocks(irProcedure *proc) {
 void ir_opt_build_referrers(irProcedure *proc) {
 	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&proc->module->tmp_arena);
 
-	Array<irValue *> ops = {0}; // NOTE(bill): Act as a buffer
+	// The locals only belong to this procedure so they can be rebuilt from scratch
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irInstr *instr = &b->instrs[j]->Instr;
+			if (instr->kind == irInstr_Local) {
+				array_clear(&instr->Local.referrers);
+			}
+		}
+	}
+
+	Array<irValue **> ops = {0}; // Act as a buffer
 	array_init(&ops, proc->module->tmp_allocator, 64); // HACK(bill): This _could_ overflow the temp arena
 	for_array(i, proc->blocks) {
 		irBlock *b = proc->blocks[i];
@@ -285,7 +314,7 @@ void ir_opt_build_referrers(irProcedure *proc) {
 			array_clear(&ops);
 			ir_opt_add_operands(&ops, &instr->Instr);
 			for_array(k, ops) {
-				irValue *op = ops[k];
+				irValue *op = *ops[k];
 				if (op == nullptr) {
 					continue;
 				}
@@ -355,14 +384,12 @@ typedef struct irDomPrePost {
 irDomPrePost ir_opt_number_dom_tree(irBlock *v, i32 pre, i32 post) {
 	irDomPrePost result = {pre, post};
 
-	v->dom.pre = pre++;
+	v->dom.pre = result.pre++;
 	for_array(i, v->dom.children) {
 		result = ir_opt_number_dom_tree(v->dom.children[i], result.pre, result.post);
 	}
-	v->dom.post = post++;
+	v->dom.post = result.post++;
 
-	result.pre  = pre;
-	result.post = post;
 	return result;
 }
 
@@ -376,6 +403,12 @@ void ir_opt_build_dom_tree(irProcedure *proc) {
 	i32 n = cast(i32)proc->blocks.count;
 	irBlock **buf = gb_alloc_array(proc->module->tmp_allocator, irBlock *, 5*n);
 
+	for_array(i, proc->blocks) {
+		irDomNode *dom = &proc->blocks[i]->dom;
+		dom->idom = nullptr;
+		array_clear(&dom->children);
+	}
+
 	irLTState lt = {0};
 	lt.count    = n;
 	lt.sdom     = &buf[0*n];
@@ -388,6 +421,7 @@ void ir_opt_build_dom_tree(irProcedure *proc) {
 
 	// Step 1 - number vertices
 	i32 pre_num = ir_lt_depth_first_search(&lt, root, 0, preorder);
+	GB_ASSERT_MSG(pre_num == n, "Unreachable blocks in %.*s", LIT(proc->name));
 	gb_memmove(buckets, preorder, n*gb_size_of(preorder[0]));
 
 	for (i32 i = n-1; i > 0; i--) {
@@ -454,41 +488,1715 @@ void ir_opt_build_dom_tree(irProcedure *proc) {
 	gb_temp_arena_memory_end(tmp);
 }
 
-void ir_opt_mem2reg(irProcedure *proc) {
-	// TODO(bill): ir_opt_mem2reg
+// Requires `ir_opt_build_dom_tree` to be called before this
+// For more info, see: Cooper, Harvey & Kennedy - A Simple, Fast Dominance Algorithm
+void ir_opt_build_dom_frontier(irProcedure *proc, Array<irBlock *> *frontiers) {
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		if (b->preds.count < 2) {
+			continue;
+		}
+		for_array(j, b->preds) {
+			for (irBlock *runner = b->preds[j];
+			     runner != nullptr && runner != b->dom.idom;
+			     runner = runner->dom.idom) {
+				Array<irBlock *> *df = &frontiers[runner->index];
+				if (df->count > 0 && (*df)[df->count-1] == b) {
+					// Already added from a previous predecessor of `b`
+					break;
+				}
+				array_add(df, b);
+			}
+		}
+	}
 }
 
 
+// Promotes the locals that are only ever loaded from and stored to into SSA values.
+// The phi nodes are placed on the iterated dominance frontiers of the stores and the loads are
+// renamed whilst walking the dominator tree.
+// Based on: Cytron et al. - Efficiently Computing Static Single Assignment Form and the Control Dependence Graph
+
+struct irNewPhi {
+	irValue *phi;
+	isize    local_index;
+};
+
+struct irMem2Reg {
+	irProcedure *     proc;
+	Array<irValue *>  locals;       // `value->index` of a promoted local is its index in here
+	Array<irNewPhi> * new_phis;     // Per block
+	PtrSet<irValue *> phi_set;
+	Map<irValue *>    replacements; // Key: irValue * of the removed load or phi
+	irValue **        zeros;
+	irValue **        undefs;
+};
+
+// Only the types that fit in a single register, the aggregates are left for `opt -mem2reg`
+bool ir_opt_is_new_phi(irMem2Reg *s, irValue *v) {
+	if (v == nullptr || v->kind != irValue_Instr || v->Instr.kind != irInstr_Phi) {
+		return false;
+	}
+	return ptr_set_exists(&s->phi_set, v);
+}
 
-void ir_opt_tree(irGen *s) {
-	s->opt_called = true;
+bool ir_opt_is_type_promotable(Type *t) {
+	return is_type_integer(t) ||
+	       is_type_float(t) ||
+	       is_type_boolean(t) ||
+	       is_type_pointer(t) ||
+	       is_type_proc(t);
+}
 
-	for_array(member_index, s->module.procs) {
-		irProcedure *proc = s->module.procs[member_index];
-		if (proc->blocks.count == 0) { // Prototype/external procedure
+bool ir_opt_is_local_promotable(irValue *local) {
+	irInstrLocal *l = &local->Instr.Local;
+	Type *type = l->entity->type;
+	if (!ir_opt_is_type_promotable(type)) {
+		return false;
+	}
+	for_array(i, l->referrers) {
+		irInstr *r = &l->referrers[i]->Instr;
+		switch (r->kind) {
+		case irInstr_Load:
+		case irInstr_ZeroInit:
+		case irInstr_DebugDeclare:
 			continue;
+		case irInstr_Store: {
+			irValue *value = r->Store.value;
+			if (value == local || r->Store.atomic) {
+				return false;
+			}
+			// The stored value replaces the loads so it must be printed as the same type
+			Type *vt = ir_type(value);
+			if (!are_types_identical(vt, type) &&
+			    !(value->kind == irValue_Constant && is_type_untyped(vt))) {
+				return false;
+			}
+			continue;
+		}
 		}
+		// Address taken
+		return false;
+	}
+	return true;
+}
 
-		ir_opt_blocks(proc);
-	#if 0
-		ir_opt_build_referrers(proc);
-		ir_opt_build_dom_tree(proc);
+isize ir_opt_promoted_local_index(irValue *address) {
+	if (address->kind == irValue_Instr &&
+	    address->Instr.kind == irInstr_Local) {
+		return address->index;
+	}
+	return -1;
+}
 
-		// TODO(bill): ir optimization
-		// [ ] cse (common-subexpression) elim
-		// [ ] copy elim
-		// [ ] dead code elim
-		// [ ] dead store/load elim
-		// [ ] phi elim
-		// [ ] short circuit elim
-		// [ ] bounds check elim
-		// [ ] lift/mem2reg
-		// [ ] lift/mem2reg
+Type *ir_opt_promoted_local_type(irMem2Reg *s, isize index) {
+	return s->locals[index]->Instr.Local.entity->type;
+}
+
+irValue *ir_opt_mem2reg_undef(irMem2Reg *s, isize index) {
+	if (s->undefs[index] == nullptr) {
+		s->undefs[index] = ir_value_undef(s->proc->module->allocator, ir_opt_promoted_local_type(s, index));
+	}
+	return s->undefs[index];
+}
+
+irValue *ir_opt_mem2reg_current(irMem2Reg *s, irValue **renaming, isize index) {
+	irValue *v = renaming[index];
+	if (v == nullptr) {
+		// Loaded before anything was stored
+		v = ir_opt_mem2reg_undef(s, index);
+	}
+	return v;
+}
+
+irValue *ir_opt_mem2reg_resolve(irMem2Reg *s, irValue *v) {
+	for (;;) {
+		// Only loads and phi nodes are ever replaced
+		if (v->kind != irValue_Instr ||
+		    (v->Instr.kind != irInstr_Load && v->Instr.kind != irInstr_Phi)) {
+			return v;
+		}
+		irValue **found = map_get(&s->replacements, hash_pointer(v));
+		if (found == nullptr) {
+			return v;
+		}
+		v = *found;
+	}
+}
+
+void ir_opt_mem2reg_rename(irMem2Reg *s, irBlock *b, irValue **renaming) {
+	gbAllocator a = s->proc->module->allocator;
+
+	Array<irNewPhi> *phis = &s->new_phis[b->index];
+	for_array(i, *phis) {
+		irNewPhi np = (*phis)[i];
+		renaming[np.local_index] = np.phi;
+	}
+
+	for_array(i, b->instrs) {
+		irValue *v = b->instrs[i];
+		irInstr *instr = &v->Instr;
+		isize index = -1;
+		switch (instr->kind) {
+		case irInstr_Local:
+			index = v->index;
+			break;
+		case irInstr_ZeroInit:
+			index = ir_opt_promoted_local_index(instr->ZeroInit.address);
+			if (index >= 0) {
+				if (s->zeros[index] == nullptr) {
+					s->zeros[index] = ir_value_nil(a, ir_opt_promoted_local_type(s, index));
+				}
+				renaming[index] = s->zeros[index];
+			}
+			break;
+		case irInstr_Store:
+			index = ir_opt_promoted_local_index(instr->Store.address);
+			if (index >= 0) {
+				irValue *value = instr->Store.value;
+				if (value->kind == irValue_Constant && is_type_untyped(ir_type(value))) {
+					value = ir_value_constant(a, ir_opt_promoted_local_type(s, index), value->Constant.value);
+				}
+				renaming[index] = value;
+			}
+			break;
+		case irInstr_Load:
+			index = ir_opt_promoted_local_index(instr->Load.address);
+			if (index >= 0) {
+				map_set(&s->replacements, hash_pointer(v), ir_opt_mem2reg_current(s, renaming, index));
+			}
+			break;
+		case irInstr_DebugDeclare:
+			index = ir_opt_promoted_local_index(instr->DebugDeclare.value);
+			break;
+		}
+		if (index >= 0) {
+			b->instrs[i] = nullptr;
+		}
+	}
+
+	for_array(i, b->succs) {
+		irBlock *succ = b->succs[i];
+		Array<irNewPhi> *succ_phis = &s->new_phis[succ->index];
+		for_array(j, succ->preds) {
+			if (succ->preds[j] != b) {
+				continue;
+			}
+			for_array(k, *succ_phis) {
+				irNewPhi np = (*succ_phis)[k];
+				np.phi->Instr.Phi.edges[j] = ir_opt_mem2reg_current(s, renaming, np.local_index);
+			}
+		}
+	}
+
+	isize count = s->locals.count;
+	for_array(i, b->dom.children) {
+		// The renaming is updated in place so all but the last child need a copy
+		irValue **r = renaming;
+		bool is_last = i+1 == b->dom.children.count;
+		if (!is_last) {
+			r = gb_alloc_array(heap_allocator(), irValue *, count);
+			gb_memmove(r, renaming, count*gb_size_of(irValue *));
+		}
+		ir_opt_mem2reg_rename(s, b->dom.children[i], r);
+		if (!is_last) {
+			gb_free(heap_allocator(), r);
+		}
+	}
+}
+
+// A phi whose edges are all itself or one other value is replaced by that value
+bool ir_opt_mem2reg_remove_trivial_phis(irMem2Reg *s) {
+	bool changed = false;
+	for_array(i, s->proc->blocks) {
+		Array<irNewPhi> *phis = &s->new_phis[i];
+		for_array(j, *phis) {
+			irNewPhi np = (*phis)[j];
+			irValue *phi = np.phi;
+			if (map_get(&s->replacements, hash_pointer(phi)) != nullptr) {
+				continue;
+			}
+			irValue *same = nullptr;
+			bool is_trivial = true;
+			Array<irValue *> edges = phi->Instr.Phi.edges;
+			for_array(k, edges) {
+				irValue *edge = ir_opt_mem2reg_resolve(s, edges[k]);
+				if (edge == phi || edge == same) {
+					continue;
+				}
+				if (same != nullptr) {
+					is_trivial = false;
+					break;
+				}
+				same = edge;
+			}
+			if (is_trivial) {
+				if (same == nullptr) {
+					// Only ever refers to itself so it is never given a value
+					same = ir_opt_mem2reg_undef(s, np.local_index);
+				}
+				map_set(&s->replacements, hash_pointer(phi), same);
+				changed = true;
+			}
+		}
+	}
+	return changed;
+}
+
+// Requires `ir_opt_build_referrers` and `ir_opt_build_dom_tree` to be called before this
+void ir_opt_mem2reg(irProcedure *proc) {
+	irMem2Reg s = {};
+	s.proc = proc;
+	array_init(&s.locals, heap_allocator());
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (v->Instr.kind != irInstr_Local) {
+				continue;
+			}
+			// The register index is not needed until `ir_number_proc_registers`
+			v->index = -1;
+			if (ir_opt_is_local_promotable(v)) {
+				v->index = cast(i32)s.locals.count;
+				array_add(&s.locals, v);
+			}
+		}
+	}
+	if (s.locals.count == 0) {
+		array_free(&s.locals);
+		return;
+	}
+
+	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&proc->module->tmp_arena);
+	gbAllocator ta = proc->module->tmp_allocator;
+	gbAllocator a  = proc->module->allocator;
+	isize block_count = proc->blocks.count;
+
+	Array<irBlock *> *frontiers = gb_alloc_array(ta, Array<irBlock *>, block_count);
+	s.new_phis = gb_alloc_array(ta, Array<irNewPhi>, block_count);
+	for (isize i = 0; i < block_count; i++) {
+		array_init(&frontiers[i], heap_allocator(), 0);
+		array_init(&s.new_phis[i], heap_allocator(), 0);
+	}
+	s.zeros  = gb_alloc_array(ta, irValue *, s.locals.count);
+	s.undefs = gb_alloc_array(ta, irValue *, s.locals.count);
+	ptr_set_init(&s.phi_set, heap_allocator());
+	map_init(&s.replacements, heap_allocator());
+
+	ir_opt_build_dom_frontier(proc, frontiers);
+
+	// Place the phi nodes. Each block is stamped with the index+1 of the local it last had
+	// a phi node or was in the work list for
+	i32 *has_phi = gb_alloc_array(ta, i32, block_count);
+	i32 *in_work = gb_alloc_array(ta, i32, block_count);
+	Array<irBlock *> work = {};
+	array_init(&work, heap_allocator());
+	for_array(i, s.locals) {
+		i32 stamp = cast(i32)i+1;
+		irValue *local = s.locals[i];
+		Type *type = local->Instr.Local.entity->type;
+
+		Array<irValue *> refs = local->Instr.Local.referrers;
+		for_array(j, refs) {
+			irInstr *r = &refs[j]->Instr;
+			if (r->kind == irInstr_Store || r->kind == irInstr_ZeroInit) {
+				irBlock *b = r->parent;
+				if (in_work[b->index] != stamp) {
+					in_work[b->index] = stamp;
+					array_add(&work, b);
+				}
+			}
+		}
+
+		while (work.count > 0) {
+			irBlock *u = array_pop(&work);
+			for_array(j, frontiers[u->index]) {
+				irBlock *v = frontiers[u->index][j];
+				if (has_phi[v->index] == stamp) {
+					continue;
+				}
+				has_phi[v->index] = stamp;
+
+				irValue *phi = ir_alloc_instr(proc, irInstr_Phi);
+				phi->Instr.parent   = v;
+				phi->Instr.Phi.type = type;
+				array_init_count(&phi->Instr.Phi.edges, a, v->preds.count);
+				irNewPhi np = {phi, i};
+				array_add(&s.new_phis[v->index], np);
+				ptr_set_add(&s.phi_set, phi);
+
+				if (in_work[v->index] != stamp) {
+					in_work[v->index] = stamp;
+					array_add(&work, v);
+				}
+			}
+		}
+	}
+
+	irValue **renaming = gb_alloc_array(ta, irValue *, s.locals.count);
+	ir_opt_mem2reg_rename(&s, proc->blocks[0], renaming);
+
+	while (ir_opt_mem2reg_remove_trivial_phis(&s)) {
+		// Removing a phi node may make others trivial
+	}
+
+	// Replace the uses of the removed loads and phi nodes
+	Array<irValue **> ops = {};
+	array_init(&ops, heap_allocator());
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		Array<irNewPhi> phis = s.new_phis[i];
+		for (isize j = 0; j < phis.count + b->instrs.count; j++) {
+			irValue *v = j < phis.count ? phis[j].phi : b->instrs[j-phis.count];
+			if (v == nullptr) {
+				continue;
+			}
+			array_clear(&ops);
+			ir_opt_add_operands(&ops, &v->Instr);
+			for_array(k, ops) {
+				if (*ops[k] != nullptr) {
+					*ops[k] = ir_opt_mem2reg_resolve(&s, *ops[k]);
+				}
+			}
+		}
+	}
+
+	// Remove the phi nodes that are only used by other dead phi nodes
+	PtrSet<irValue *> live = {};
+	ptr_set_init(&live, heap_allocator());
+	Array<irValue *> live_work = {};
+	array_init(&live_work, heap_allocator());
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (v == nullptr) {
+				continue;
+			}
+			array_clear(&ops);
+			ir_opt_add_operands(&ops, &v->Instr);
+			for_array(k, ops) {
+				irValue *op = *ops[k];
+				if (ir_opt_is_new_phi(&s, op) && !ptr_set_exists(&live, op)) {
+					ptr_set_add(&live, op);
+					array_add(&live_work, op);
+				}
+			}
+		}
+	}
+	while (live_work.count > 0) {
+		irValue *phi = array_pop(&live_work);
+		Array<irValue *> edges = phi->Instr.Phi.edges;
+		for_array(i, edges) {
+			irValue *edge = edges[i];
+			if (ir_opt_is_new_phi(&s, edge) && !ptr_set_exists(&live, edge)) {
+				ptr_set_add(&live, edge);
+				array_add(&live_work, edge);
+			}
+		}
+	}
+
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		Array<irNewPhi> phis = s.new_phis[i];
+
+		Array<irValue *> instrs = {};
+		array_init(&instrs, heap_allocator(), phis.count + b->instrs.count);
+		for_array(j, phis) {
+			if (ptr_set_exists(&live, phis[j].phi)) {
+				array_add(&instrs, phis[j].phi);
+			}
+		}
+		for_array(j, b->instrs) {
+			if (b->instrs[j] != nullptr) {
+				array_add(&instrs, b->instrs[j]);
+			}
+		}
+		array_free(&b->instrs);
+		b->instrs = instrs;
+
+		isize local_count = 0;
+		for_array(j, b->locals) {
+			irValue *l = b->locals[j];
+			if (l->index < 0) {
+				b->locals[local_count++] = l;
+			}
+		}
+		b->locals.count = local_count;
+	}
+	proc->local_count -= cast(i32)s.locals.count;
+
+	for_array(i, s.locals) {
+		array_free(&s.locals[i]->Instr.Local.referrers);
+	}
+	for (isize i = 0; i < block_count; i++) {
+		array_free(&frontiers[i]);
+		array_free(&s.new_phis[i]);
+	}
+	array_free(&live_work);
+	ptr_set_destroy(&live);
+	array_free(&ops);
+	array_free(&work);
+	map_destroy(&s.replacements);
+	ptr_set_destroy(&s.phi_set);
+	array_free(&s.locals);
+
+	gb_temp_arena_memory_end(tmp);
+}
+
+
+// The state shared by the passes which remove instructions or replace their uses.
+// For the duration of a pass, `value->index` of an instruction is its index in `instrs`
+struct irOptPass {
+	irProcedure *proc;
+	isize        count;
+	irValue **   instrs;
+	irValue **   replacements; // The value which replaces the uses of the instruction, if any
+	bool *       removed;
+	isize        replaced_count;
+	isize        removed_count;
+};
+
+void ir_opt_pass_init(irOptPass *p, irProcedure *proc) {
+	gbAllocator ta = proc->module->tmp_allocator;
+	isize count = 0;
+	for_array(i, proc->blocks) {
+		count += proc->blocks[i]->instrs.count;
+	}
+	p->proc         = proc;
+	p->count        = count;
+	p->instrs       = gb_alloc_array(ta, irValue *, count);
+	p->replacements = gb_alloc_array(ta, irValue *, count);
+	p->removed      = gb_alloc_array(ta, bool, count);
+
+	isize index = 0;
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			v->index = cast(i32)index;
+			p->instrs[index++] = v;
+		}
+	}
+}
+
+bool ir_opt_pass_is_instr(irOptPass *p, irValue *v) {
+	return v != nullptr && v->kind == irValue_Instr &&
+	       v->index >= 0 && v->index < p->count &&
+	       p->instrs[v->index] == v;
+}
+
+irValue *ir_opt_pass_resolve(irOptPass *p, irValue *v) {
+	while (ir_opt_pass_is_instr(p, v) && p->replacements[v->index] != nullptr) {
+		v = p->replacements[v->index];
+	}
+	return v;
+}
+
+void ir_opt_pass_resolve_operands(irOptPass *p, Array<irValue **> *ops, irInstr *instr) {
+	array_clear(ops);
+	ir_opt_add_operands(ops, instr);
+	for_array(i, *ops) {
+		irValue **op = (*ops)[i];
+		if (*op != nullptr) {
+			*op = ir_opt_pass_resolve(p, *op);
+		}
+	}
+}
+
+// `with` must already be resolved so that the replacements never form a cycle
+void ir_opt_pass_replace(irOptPass *p, irValue *v, irValue *with) {
+	GB_ASSERT(v != with);
+	p->replacements[v->index] = with;
+	p->replaced_count += 1;
+}
+
+void ir_opt_pass_remove(irOptPass *p, irValue *v) {
+	if (!p->removed[v->index]) {
+		p->removed[v->index] = true;
+		p->removed_count += 1;
+	}
+}
+
+// Removes the instructions which were removed or replaced and substitutes the
+// replacements into the operands of the rest
+void ir_opt_pass_sweep(irOptPass *p) {
+	if (p->replaced_count == 0 && p->removed_count == 0) {
+		return;
+	}
+	Array<irValue **> ops = {};
+	array_init(&ops, heap_allocator());
+	isize removed_locals = 0;
+	for_array(i, p->proc->blocks) {
+		irBlock *b = p->proc->blocks[i];
+		isize count = 0;
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (p->removed[v->index] || p->replacements[v->index] != nullptr) {
+				continue;
+			}
+			if (p->replaced_count > 0) {
+				ir_opt_pass_resolve_operands(p, &ops, &v->Instr);
+			}
+			b->instrs[count++] = v;
+		}
+		b->instrs.count = count;
+
+		isize local_count = 0;
+		for_array(j, b->locals) {
+			irValue *l = b->locals[j];
+			if (!ir_opt_pass_is_instr(p, l) || !p->removed[l->index]) {
+				b->locals[local_count++] = l;
+			}
+		}
+		removed_locals += b->locals.count - local_count;
+		b->locals.count = local_count;
+	}
+	p->proc->local_count -= cast(i32)removed_locals;
+	array_free(&ops);
+}
+
+
+bool ir_opt_are_values_equal(irValue *x, irValue *y) {
+	if (x == y) {
+		return true;
+	}
+	if (x == nullptr || y == nullptr || x->kind != y->kind) {
+		return false;
+	}
+	switch (x->kind) {
+	case irValue_Constant: {
+		ExactValue a = x->Constant.value;
+		ExactValue b = y->Constant.value;
+		if (a.kind != b.kind || !are_types_identical(x->Constant.type, y->Constant.type)) {
+			return false;
+		}
+		switch (a.kind) {
+		case ExactValue_Bool:    return a.value_bool == b.value_bool;
+		case ExactValue_Integer: return a.value_integer == b.value_integer;
+		// Compare the bits so that -0.0 and 0.0 are different and NaN is equal to itself
+		case ExactValue_Float:   return gb_memcompare(&a.value_float, &b.value_float, gb_size_of(f64)) == 0;
+		}
+		return false;
+	}
+	case irValue_Nil:
+		return are_types_identical(x->Nil.type, y->Nil.type);
+	}
+	return false;
+}
+
+u64 ir_opt_value_hash(irValue *v) {
+	switch (v->kind) {
+	case irValue_Constant: {
+		ExactValue ev = v->Constant.value;
+		switch (ev.kind) {
+		case ExactValue_Bool:    return hash_index_mix(cast(u64)ev.value_bool);
+		case ExactValue_Integer: return hash_index_mix(i128_to_u64(ev.value_integer));
+		case ExactValue_Float: {
+			u64 bits = 0;
+			gb_memmove(&bits, &ev.value_float, gb_size_of(f64));
+			return hash_index_mix(bits);
+		}
+		}
+		return cast(u64)ev.kind;
+	}
+	case irValue_Nil:
+		return cast(u64)irValue_Nil;
+	}
+	return hash_index_mix(cast(u64)cast(uintptr)v);
+}
 
-		ir_opt_mem2reg(proc);
-	#endif
 
-		GB_ASSERT(proc->blocks.count > 0);
+// Folds the phi nodes whose edges are all the same value or the phi node itself
+void ir_opt_phi_elim(irOptPass *p) {
+	gbAllocator a = p->proc->module->allocator;
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (isize i = 0; i < p->count; i++) {
+			irValue *v = p->instrs[i];
+			if (v->Instr.kind != irInstr_Phi || p->replacements[i] != nullptr) {
+				continue;
+			}
+			irValue *same = nullptr;
+			bool is_trivial = true;
+			Array<irValue *> edges = v->Instr.Phi.edges;
+			for_array(j, edges) {
+				irValue *edge = ir_opt_pass_resolve(p, edges[j]);
+				if (edge == v || ir_opt_are_values_equal(edge, same)) {
+					continue;
+				}
+				if (same != nullptr) {
+					is_trivial = false;
+					break;
+				}
+				same = edge;
+			}
+			if (!is_trivial || same == nullptr) {
+				continue;
+			}
+			Type *type = v->Instr.Phi.type;
+			if (!are_types_identical(ir_type(same), type)) {
+				if (same->kind != irValue_Constant) {
+					continue;
+				}
+				same = ir_value_constant(a, type, same->Constant.value);
+			}
+			ir_opt_pass_replace(p, v, same);
+			changed = true;
+		}
+	}
+}
+
+// Replaces the instructions which only ever produce one of their operands
+void ir_opt_copy_elim(irOptPass *p) {
+	for (isize i = 0; i < p->count; i++) {
+		irValue *v = p->instrs[i];
+		irInstr *instr = &v->Instr;
+		irValue *copy = nullptr;
+		switch (instr->kind) {
+		case irInstr_Select: {
+			irValue *cond = ir_opt_pass_resolve(p, instr->Select.cond);
+			irValue *x    = ir_opt_pass_resolve(p, instr->Select.true_value);
+			irValue *y    = ir_opt_pass_resolve(p, instr->Select.false_value);
+			if (cond->kind == irValue_Constant && cond->Constant.value.kind == ExactValue_Bool) {
+				copy = cond->Constant.value.value_bool ? x : y;
+			} else if (ir_opt_are_values_equal(x, y)) {
+				copy = x;
+			}
+			break;
+		}
+		case irInstr_Conv: {
+			irValue *value = ir_opt_pass_resolve(p, instr->Conv.value);
+			if (are_types_identical(instr->Conv.from, instr->Conv.to)) {
+				copy = value;
+			} else if (instr->Conv.kind == irConv_bitcast &&
+			           ir_opt_pass_is_instr(p, value) &&
+			           value->Instr.kind == irInstr_Conv &&
+			           value->Instr.Conv.kind == irConv_bitcast) {
+				// A bitcast back to the original type
+				copy = ir_opt_pass_resolve(p, value->Instr.Conv.value);
+			}
+			break;
+		}
+		}
+		if (copy != nullptr && copy != v &&
+		    are_types_identical(ir_type(copy), ir_instr_type(instr))) {
+			ir_opt_pass_replace(p, v, copy);
+		}
+	}
+}
+
+
+bool ir_opt_is_cse_instr(irInstr *instr) {
+	switch (instr->kind) {
+	case irInstr_PtrOffset:
+	case irInstr_ArrayElementPtr:
+	case irInstr_StructElementPtr:
+	case irInstr_StructExtractValue:
+	case irInstr_UnionTagPtr:
+	case irInstr_UnionTagValue:
+	case irInstr_Conv:
+	case irInstr_Select:
+	case irInstr_UnaryOp:
+	case irInstr_BinaryOp:
+		return true;
+	}
+	return false;
+}
+
+// The operands must already be resolved
+u64 ir_opt_cse_hash(irInstr *instr) {
+	u64 h = cast(u64)instr->kind;
+	irValue *ops[3] = {};
+	isize op_count = 0;
+	switch (instr->kind) {
+	case irInstr_PtrOffset:
+		ops[op_count++] = instr->PtrOffset.address;
+		ops[op_count++] = instr->PtrOffset.offset;
+		break;
+	case irInstr_ArrayElementPtr:
+		ops[op_count++] = instr->ArrayElementPtr.address;
+		ops[op_count++] = instr->ArrayElementPtr.elem_index;
+		break;
+	case irInstr_StructElementPtr:
+		h = h*31 + cast(u64)instr->StructElementPtr.elem_index;
+		ops[op_count++] = instr->StructElementPtr.address;
+		break;
+	case irInstr_StructExtractValue:
+		h = h*31 + cast(u64)instr->StructExtractValue.index;
+		ops[op_count++] = instr->StructExtractValue.address;
+		break;
+	case irInstr_UnionTagPtr:
+		ops[op_count++] = instr->UnionTagPtr.address;
+		break;
+	case irInstr_UnionTagValue:
+		ops[op_count++] = instr->UnionTagValue.address;
+		break;
+	case irInstr_Conv:
+		h = h*31 + cast(u64)instr->Conv.kind;
+		ops[op_count++] = instr->Conv.value;
+		break;
+	case irInstr_Select:
+		ops[op_count++] = instr->Select.cond;
+		ops[op_count++] = instr->Select.true_value;
+		ops[op_count++] = instr->Select.false_value;
+		break;
+	case irInstr_UnaryOp:
+		h = h*31 + cast(u64)instr->UnaryOp.op;
+		ops[op_count++] = instr->UnaryOp.expr;
+		break;
+	case irInstr_BinaryOp:
+		h = h*31 + cast(u64)instr->BinaryOp.op;
+		ops[op_count++] = instr->BinaryOp.left;
+		ops[op_count++] = instr->BinaryOp.right;
+		break;
+	}
+	for (isize i = 0; i < op_count; i++) {
+		h = hash_index_mix(h ^ ir_opt_value_hash(ops[i]));
+	}
+	return h;
+}
+
+bool ir_opt_are_cse_instrs_equal(irInstr *x, irInstr *y) {
+	if (x->kind != y->kind) {
+		return false;
+	}
+	switch (x->kind) {
+	case irInstr_PtrOffset:
+		return ir_opt_are_values_equal(x->PtrOffset.address, y->PtrOffset.address) &&
+		       ir_opt_are_values_equal(x->PtrOffset.offset,  y->PtrOffset.offset);
+	case irInstr_ArrayElementPtr:
+		return are_types_identical(x->ArrayElementPtr.result_type, y->ArrayElementPtr.result_type) &&
+		       ir_opt_are_values_equal(x->ArrayElementPtr.address,    y->ArrayElementPtr.address) &&
+		       ir_opt_are_values_equal(x->ArrayElementPtr.elem_index, y->ArrayElementPtr.elem_index);
+	case irInstr_StructElementPtr:
+		return x->StructElementPtr.elem_index == y->StructElementPtr.elem_index &&
+		       are_types_identical(x->StructElementPtr.result_type, y->StructElementPtr.result_type) &&
+		       ir_opt_are_values_equal(x->StructElementPtr.address, y->StructElementPtr.address);
+	case irInstr_StructExtractValue:
+		return x->StructExtractValue.index == y->StructExtractValue.index &&
+		       are_types_identical(x->StructExtractValue.result_type, y->StructExtractValue.result_type) &&
+		       ir_opt_are_values_equal(x->StructExtractValue.address, y->StructExtractValue.address);
+	case irInstr_UnionTagPtr:
+		return are_types_identical(x->UnionTagPtr.type, y->UnionTagPtr.type) &&
+		       ir_opt_are_values_equal(x->UnionTagPtr.address, y->UnionTagPtr.address);
+	case irInstr_UnionTagValue:
+		return are_types_identical(x->UnionTagValue.type, y->UnionTagValue.type) &&
+		       ir_opt_are_values_equal(x->UnionTagValue.address, y->UnionTagValue.address);
+	case irInstr_Conv:
+		return x->Conv.kind == y->Conv.kind &&
+		       are_types_identical(x->Conv.from, y->Conv.from) &&
+		       are_types_identical(x->Conv.to,   y->Conv.to) &&
+		       ir_opt_are_values_equal(x->Conv.value, y->Conv.value);
+	case irInstr_Select:
+		return ir_opt_are_values_equal(x->Select.cond,        y->Select.cond) &&
+		       ir_opt_are_values_equal(x->Select.true_value,  y->Select.true_value) &&
+		       ir_opt_are_values_equal(x->Select.false_value, y->Select.false_value);
+	case irInstr_UnaryOp:
+		return x->UnaryOp.op == y->UnaryOp.op &&
+		       are_types_identical(x->UnaryOp.type, y->UnaryOp.type) &&
+		       ir_opt_are_values_equal(x->UnaryOp.expr, y->UnaryOp.expr);
+	case irInstr_BinaryOp:
+		return x->BinaryOp.op == y->BinaryOp.op &&
+		       are_types_identical(x->BinaryOp.type, y->BinaryOp.type) &&
+		       ir_opt_are_values_equal(x->BinaryOp.left,  y->BinaryOp.left) &&
+		       ir_opt_are_values_equal(x->BinaryOp.right, y->BinaryOp.right);
+	}
+	return false;
+}
+
+// Replaces an instruction with an equal one which dominates it. The blocks are visited
+// in a preorder of the dominator tree so the dominating instructions are always seen first.
+// Requires `ir_opt_build_dom_tree` to be called before this
+void ir_opt_cse(irOptPass *p) {
+	Map<irValue *> exprs = {}; // Key: expression hash
+	map_init(&exprs, heap_allocator());
+	Array<irValue **> ops = {};
+	array_init(&ops, heap_allocator());
+	Array<irBlock *> stack = {};
+	array_init(&stack, heap_allocator());
+
+	array_add(&stack, p->proc->blocks[0]);
+	while (stack.count > 0) {
+		irBlock *b = array_pop(&stack);
+		for_array(i, b->dom.children) {
+			array_add(&stack, b->dom.children[i]);
+		}
+
+		for_array(i, b->instrs) {
+			irValue *v = b->instrs[i];
+			irInstr *instr = &v->Instr;
+			ir_opt_pass_resolve_operands(p, &ops, instr);
+			if (!ir_opt_is_cse_instr(instr)) {
+				continue;
+			}
+
+			HashKey key = hash_integer(ir_opt_cse_hash(instr));
+			irValue *found = nullptr;
+			for (MapEntry<irValue *> *e = multi_map_find_first(&exprs, key);
+			     e != nullptr;
+			     e = multi_map_find_next(&exprs, e)) {
+				irValue *c = e->value;
+				irBlock *cb = c->Instr.parent;
+				bool dominates = cb->dom.pre <= b->dom.pre && b->dom.post <= cb->dom.post;
+				if (dominates && ir_opt_are_cse_instrs_equal(&c->Instr, instr)) {
+					found = c;
+					break;
+				}
+			}
+			if (found != nullptr) {
+				ir_opt_pass_replace(p, v, found);
+			} else {
+				multi_map_insert(&exprs, key, v);
+			}
+		}
+	}
+
+	array_free(&stack);
+	array_free(&ops);
+	map_destroy(&exprs);
+}
+
+
+// The local or global which an address points into, if it is known
+irValue *ir_opt_address_root(irValue *address) {
+	for (;;) {
+		if (address->kind != irValue_Instr) {
+			return address;
+		}
+		irInstr *instr = &address->Instr;
+		switch (instr->kind) {
+		case irInstr_StructElementPtr: address = instr->StructElementPtr.address; continue;
+		case irInstr_ArrayElementPtr:  address = instr->ArrayElementPtr.address;  continue;
+		case irInstr_PtrOffset:        address = instr->PtrOffset.address;        continue;
+		case irInstr_UnionTagPtr:      address = instr->UnionTagPtr.address;      continue;
+		case irInstr_Conv:
+			if (instr->Conv.kind == irConv_bitcast) {
+				address = instr->Conv.value;
+				continue;
+			}
+			break;
+		}
+		return address;
+	}
+}
+
+bool ir_opt_is_identified_object(irValue *root) {
+	if (root->kind == irValue_Global) {
+		return true;
+	}
+	return root->kind == irValue_Instr && root->Instr.kind == irInstr_Local;
+}
+
+bool ir_opt_may_alias(irValue *root_a, irValue *root_b) {
+	if (root_a == root_b) {
+		return true;
+	}
+	// Two different locals or globals never overlap but any other pointer may point into either
+	return !ir_opt_is_identified_object(root_a) || !ir_opt_is_identified_object(root_b);
+}
+
+struct irOptMemoryValue {
+	irValue *address;
+	irValue *root;
+	irValue *value; // The value known to be at `address` or the store to it
+};
+
+enum {
+	// Bounds the cost of the linear searches in very long blocks
+	IR_OPT_MAX_MEMORY_VALUES = 32,
+};
+
+isize ir_opt_find_memory_value(Array<irOptMemoryValue> *values, irValue *address) {
+	for_array(i, *values) {
+		if ((*values)[i].address == address) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void ir_opt_remove_aliasing_memory_values(Array<irOptMemoryValue> *values, irValue *root) {
+	isize count = 0;
+	for_array(i, *values) {
+		irOptMemoryValue mv = (*values)[i];
+		if (!ir_opt_may_alias(mv.root, root)) {
+			(*values)[count++] = mv;
+		}
+	}
+	values->count = count;
+}
+
+void ir_opt_add_memory_value(Array<irOptMemoryValue> *values, irValue *address, irValue *root, irValue *value) {
+	if (values->count >= IR_OPT_MAX_MEMORY_VALUES) {
+		array_clear(values);
+	}
+	irOptMemoryValue mv = {address, root, value};
+	array_add(values, mv);
+}
+
+bool ir_opt_is_dead_local(irValue *local) {
+	Array<irValue *> refs = local->Instr.Local.referrers;
+	for_array(i, refs) {
+		irInstr *r = &refs[i]->Instr;
+		switch (r->kind) {
+		case irInstr_ZeroInit:
+		case irInstr_DebugDeclare:
+			continue;
+		case irInstr_Store:
+			if (r->Store.address == local && r->Store.value != local && !r->Store.atomic) {
+				continue;
+			}
+			break;
+		}
+		return false;
+	}
+	return true;
+}
+
+// Within each block, forwards a stored or loaded value to the later loads of the same
+// address and removes a store which is overwritten before anything could read it. Then removes
+// the locals which are only ever written to.
+void ir_opt_dead_store_elim(irOptPass *p) {
+	Array<irOptMemoryValue> available = {}; // Values of the loads and stores
+	Array<irOptMemoryValue> pending   = {}; // Stores which have not been read yet
+	array_init(&available, heap_allocator(), IR_OPT_MAX_MEMORY_VALUES);
+	array_init(&pending,   heap_allocator(), IR_OPT_MAX_MEMORY_VALUES);
+
+	for_array(i, p->proc->blocks) {
+		irBlock *b = p->proc->blocks[i];
+		array_clear(&available);
+		array_clear(&pending);
+
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			irInstr *instr = &v->Instr;
+			switch (instr->kind) {
+			case irInstr_Load: {
+				irValue *address = ir_opt_pass_resolve(p, instr->Load.address);
+				isize found = ir_opt_find_memory_value(&available, address);
+				if (found >= 0) {
+					irValue *value = ir_opt_pass_resolve(p, available[found].value);
+					if (value != v && are_types_identical(ir_type(value), instr->Load.type)) {
+						ir_opt_pass_replace(p, v, value);
+						break;
+					}
+				}
+				irValue *root = ir_opt_address_root(address);
+				ir_opt_remove_aliasing_memory_values(&pending, root);
+				if (found < 0) {
+					ir_opt_add_memory_value(&available, address, root, v);
+				}
+				break;
+			}
+			case irInstr_Store:
+			case irInstr_ZeroInit: {
+				if (instr->kind == irInstr_Store && instr->Store.atomic) {
+					array_clear(&available);
+					array_clear(&pending);
+					break;
+				}
+				irValue *address = nullptr;
+				if (instr->kind == irInstr_Store) {
+					address = ir_opt_pass_resolve(p, instr->Store.address);
+				} else {
+					address = ir_opt_pass_resolve(p, instr->ZeroInit.address);
+				}
+				irValue *root = ir_opt_address_root(address);
+
+				isize found = ir_opt_find_memory_value(&pending, address);
+				if (found >= 0) {
+					// Overwritten before it was read
+					ir_opt_pass_remove(p, pending[found].value);
+					pending[found] = pending[pending.count-1];
+					pending.count -= 1;
+				}
+				ir_opt_remove_aliasing_memory_values(&available, root);
+				if (instr->kind == irInstr_Store) {
+					ir_opt_add_memory_value(&available, address, root, instr->Store.value);
+				}
+				ir_opt_add_memory_value(&pending, address, root, v);
+				break;
+			}
+			case irInstr_Call:
+			case irInstr_StartupRuntime:
+				array_clear(&available);
+				array_clear(&pending);
+				break;
+			}
+		}
+	}
+
+	array_free(&pending);
+	array_free(&available);
+
+	ir_opt_pass_sweep(p);
+	ir_opt_build_referrers(p->proc);
+	for (isize i = 0; i < p->count; i++) {
+		irValue *v = p->instrs[i];
+		if (p->removed[i] || p->replacements[i] != nullptr ||
+		    v->Instr.kind != irInstr_Local || !ir_opt_is_dead_local(v)) {
+			continue;
+		}
+		ir_opt_pass_remove(p, v);
+		Array<irValue *> refs = v->Instr.Local.referrers;
+		for_array(j, refs) {
+			ir_opt_pass_remove(p, refs[j]);
+		}
+	}
+}
+
+
+bool ir_opt_is_instr_removable(irInstr *instr) {
+	switch (instr->kind) {
+	case irInstr_Local:
+	case irInstr_Load:
+	case irInstr_PtrOffset:
+	case irInstr_ArrayElementPtr:
+	case irInstr_StructElementPtr:
+	case irInstr_StructExtractValue:
+	case irInstr_UnionTagPtr:
+	case irInstr_UnionTagValue:
+	case irInstr_Conv:
+	case irInstr_Select:
+	case irInstr_Phi:
+	case irInstr_UnaryOp:
+	case irInstr_BinaryOp:
+		return true;
+	}
+	return false;
+}
+
+// Removes the instructions without side effects whose values are never used
+void ir_opt_dce(irOptPass *p) {
+	i32 *uses = gb_alloc_array(p->proc->module->tmp_allocator, i32, p->count);
+	Array<irValue **> ops = {};
+	array_init(&ops, heap_allocator());
+	Array<irValue *> work = {};
+	array_init(&work, heap_allocator());
+
+	for (isize i = 0; i < p->count; i++) {
+		array_clear(&ops);
+		ir_opt_add_operands(&ops, &p->instrs[i]->Instr);
+		for_array(j, ops) {
+			irValue *op = *ops[j];
+			if (ir_opt_pass_is_instr(p, op)) {
+				uses[op->index] += 1;
+			}
+		}
+	}
+	for (isize i = 0; i < p->count; i++) {
+		if (uses[i] == 0 && ir_opt_is_instr_removable(&p->instrs[i]->Instr)) {
+			array_add(&work, p->instrs[i]);
+		}
+	}
+
+	while (work.count > 0) {
+		irValue *v = array_pop(&work);
+		if (p->removed[v->index]) {
+			continue;
+		}
+		ir_opt_pass_remove(p, v);
+
+		array_clear(&ops);
+		ir_opt_add_operands(&ops, &v->Instr);
+		for_array(i, ops) {
+			irValue *op = *ops[i];
+			if (!ir_opt_pass_is_instr(p, op)) {
+				continue;
+			}
+			uses[op->index] -= 1;
+			if (uses[op->index] == 0 && ir_opt_is_instr_removable(&op->Instr)) {
+				array_add(&work, op);
+			}
+		}
+	}
+
+	array_free(&work);
+	array_free(&ops);
+}
+
+
+// Removes the bounds checks which can never fail: constant indices into fixed length arrays,
+// indices guarded by a dominating `index < len` branch (as with the index of a range loop) and checks
+// dominated by an identical check. An index check is the inline branch to the procedure's
+// `bounds_check_block`, the slice checks are calls to the checking procedures.
+// Requires `ir_opt_build_dom_tree` to be called before this
+
+struct irBce {
+	irOptPass *p;
+	irValue *  slice_check_proc;
+	irValue *  substring_check_proc;
+	irValue ** single_stores; // Indexed by the local, the only store to it if it is never written otherwise
+	i64 *      lower_bounds;  // Indexed by the integer instruction
+};
+
+enum {
+	// The lower bound of a value which is not known yet, lower bounds only ever decrease
+	IR_BCE_LOWER_BOUND_UNSET = I64_MAX,
+	IR_BCE_LOWER_BOUND_UNKNOWN = I64_MIN,
+	IR_BCE_MAX_ROUNDS = 16,
+};
+
+gb_global i64 ir_opt_bounds_check_count   = 0;
+gb_global i64 ir_opt_bounds_check_removed = 0;
+
+bool ir_opt_bce_constant(irValue *v, i64 *out) {
+	if (v->kind != irValue_Constant || v->Constant.value.kind != ExactValue_Integer) {
+		return false;
+	}
+	i128 x = v->Constant.value.value_integer;
+	if (i128_lt(x, i128_from_i64(I64_MIN+1)) || i128_gt(x, i128_from_i64(I64_MAX-1))) {
+		return false;
+	}
+	*out = i128_to_i64(x);
+	return true;
+}
+
+// Looks through a load of a local which is only ever stored to once, before the load
+irValue *ir_opt_bce_value(irBce *s, irValue *v) {
+	irOptPass *p = s->p;
+	while (ir_opt_pass_is_instr(p, v) && v->Instr.kind == irInstr_Load) {
+		irValue *local = v->Instr.Load.address;
+		if (!ir_opt_pass_is_instr(p, local) || local->Instr.kind != irInstr_Local) {
+			break;
+		}
+		irValue *store = s->single_stores[local->index];
+		if (store == nullptr) {
+			break;
+		}
+		irBlock *sb = store->Instr.parent;
+		irBlock *lb = v->Instr.parent;
+		bool dominates = false;
+		if (sb == lb) {
+			dominates = store->index < v->index;
+		} else {
+			dominates = sb->dom.pre <= lb->dom.pre && lb->dom.post <= sb->dom.post;
+		}
+		if (!dominates) {
+			break;
+		}
+		v = store->Instr.Store.value;
+	}
+	return v;
+}
+
+bool ir_opt_bce_are_values_equal(irBce *s, irValue *x, irValue *y) {
+	x = ir_opt_bce_value(s, x);
+	y = ir_opt_bce_value(s, y);
+	if (ir_opt_are_values_equal(x, y)) {
+		return true;
+	}
+	i64 a = 0, b = 0;
+	if (ir_opt_bce_constant(x, &a) && ir_opt_bce_constant(y, &b)) {
+		return a == b;
+	}
+	if (x->kind != irValue_Instr || y->kind != irValue_Instr ||
+	    x->Instr.kind != irInstr_StructExtractValue || y->Instr.kind != irInstr_StructExtractValue) {
+		return false;
+	}
+	// e.g. the `len` of the same slice loaded twice
+	return x->Instr.StructExtractValue.index == y->Instr.StructExtractValue.index &&
+	       ir_opt_bce_are_values_equal(s, x->Instr.StructExtractValue.address, y->Instr.StructExtractValue.address);
+}
+
+i64 ir_opt_bce_lower_bound(irBce *s, irValue *v) {
+	v = ir_opt_bce_value(s, v);
+	i64 c = 0;
+	if (ir_opt_bce_constant(v, &c)) {
+		return c;
+	}
+	if (ir_opt_pass_is_instr(s->p, v)) {
+		return s->lower_bounds[v->index];
+	}
+	return IR_BCE_LOWER_BOUND_UNKNOWN;
+}
+
+i64 ir_opt_bce_compute_lower_bound(irBce *s, irInstr *instr) {
+	switch (instr->kind) {
+	case irInstr_Phi: {
+		if (!is_type_integer(instr->Phi.type)) {
+			break;
+		}
+		i64 lb = IR_BCE_LOWER_BOUND_UNSET;
+		for_array(i, instr->Phi.edges) {
+			lb = gb_min(lb, ir_opt_bce_lower_bound(s, instr->Phi.edges[i]));
+		}
+		return lb;
+	}
+	case irInstr_BinaryOp: {
+		irValue *left  = instr->BinaryOp.left;
+		irValue *right = instr->BinaryOp.right;
+		if (!is_type_integer(ir_type(left))) {
+			break;
+		}
+		i64 c = 0;
+		switch (instr->BinaryOp.op) {
+		case Token_Add: {
+			// Only an increment by a constant, as with an induction variable, which cannot
+			// realistically wrap before the loop ends
+			irValue *x = left;
+			if (!ir_opt_bce_constant(right, &c)) {
+				if (!ir_opt_bce_constant(left, &c)) {
+					break;
+				}
+				x = right;
+			}
+			if (c < 0 || c > 1024) {
+				break;
+			}
+			i64 lb = ir_opt_bce_lower_bound(s, x);
+			if (lb == IR_BCE_LOWER_BOUND_UNSET || lb == IR_BCE_LOWER_BOUND_UNKNOWN) {
+				return lb;
+			}
+			return lb + c;
+		}
+		case Token_And:
+			if ((ir_opt_bce_constant(right, &c) || ir_opt_bce_constant(left, &c)) && c >= 0) {
+				return 0;
+			}
+			break;
+		}
+		break;
+	}
+	case irInstr_Conv:
+		if (instr->Conv.kind == irConv_zext) {
+			return 0;
+		}
+		break;
+	}
+	return IR_BCE_LOWER_BOUND_UNKNOWN;
+}
+
+// Optimistic fixed point iteration which starts with every lower bound unset
+void ir_opt_bce_compute_lower_bounds(irBce *s) {
+	irOptPass *p = s->p;
+	for (isize i = 0; i < p->count; i++) {
+		s->lower_bounds[i] = IR_BCE_LOWER_BOUND_UNSET;
+	}
+	for (isize round = 0; round < IR_BCE_MAX_ROUNDS; round++) {
+		bool changed = false;
+		for (isize i = 0; i < p->count; i++) {
+			i64 lb = ir_opt_bce_compute_lower_bound(s, &p->instrs[i]->Instr);
+			if (lb != s->lower_bounds[i]) {
+				s->lower_bounds[i] = lb;
+				changed = true;
+			}
+		}
+		if (!changed) {
+			return;
+		}
+	}
+	// Did not converge so none of the bounds can be trusted
+	for (isize i = 0; i < p->count; i++) {
+		s->lower_bounds[i] = IR_BCE_LOWER_BOUND_UNKNOWN;
+	}
+}
+
+bool ir_opt_bce_is_non_negative(irBce *s, irValue *v) {
+	i64 lb = ir_opt_bce_lower_bound(s, v);
+	return lb >= 0 && lb != IR_BCE_LOWER_BOUND_UNSET;
+}
+
+bool ir_opt_bce_is_less_equal(irBce *s, irValue *x, irValue *y) {
+	i64 a = 0, b = 0;
+	if (ir_opt_bce_constant(x, &a) && ir_opt_bce_constant(y, &b)) {
+		return a <= b;
+	}
+	if (ir_opt_bce_constant(x, &a) && a <= 0 && ir_opt_bce_is_non_negative(s, y)) {
+		return true;
+	}
+	return ir_opt_bce_are_values_equal(s, x, y);
+}
+
+// Whether `index < len` is known to hold at the start of `b`, either from constants or
+// from a dominating branch on a signed comparison
+bool ir_opt_bce_is_less(irBce *s, irBlock *b, irValue *index, irValue *len) {
+	i64 a = 0, c = 0;
+	if (ir_opt_bce_constant(index, &a) && ir_opt_bce_constant(len, &c)) {
+		return a < c;
+	}
+	bool len_is_constant = ir_opt_bce_constant(len, &c);
+
+	for (irBlock *d = b; d != nullptr; d = d->dom.idom) {
+		if (d->preds.count == 1) {
+			irBlock *pred = d->preds[0];
+			irInstr *term = &pred->instrs[pred->instrs.count-1]->Instr;
+			if (term->kind == irInstr_If && term->If.true_block == d && term->If.false_block != d) {
+				irValue *cond = term->If.cond;
+				if (cond->kind == irValue_Instr && cond->Instr.kind == irInstr_BinaryOp) {
+					irInstrBinaryOp *bo = &cond->Instr.BinaryOp;
+					irValue *lhs = nullptr;
+					irValue *rhs = nullptr;
+					switch (bo->op) {
+					case Token_Lt: lhs = bo->left;  rhs = bo->right; break;
+					case Token_Gt: lhs = bo->right; rhs = bo->left;  break;
+					}
+					Type *t = ir_type(bo->left);
+					if (lhs != nullptr && is_type_integer(t) && !is_type_unsigned(t) &&
+					    ir_opt_bce_are_values_equal(s, lhs, index)) {
+						i64 bound = 0;
+						if (ir_opt_bce_are_values_equal(s, rhs, len)) {
+							return true;
+						}
+						if (len_is_constant && ir_opt_bce_constant(rhs, &bound) && bound <= c) {
+							return true;
+						}
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+irValue *ir_opt_bce_unwrap_bitcast(irValue *v) {
+	if (v->kind == irValue_Instr && v->Instr.kind == irInstr_Conv && v->Instr.Conv.kind == irConv_bitcast) {
+		return v->Instr.Conv.value;
+	}
+	return v;
+}
+
+// An inline index check is `if uint(index) < uint(len)` branching to the `bounds_check_block`
+// on failure, see `ir_emit_bounds_check`
+bool ir_opt_bce_inline_check(irProcedure *proc, irValue *check, irValue **index_, irValue **len_) {
+	irInstr *instr = &check->Instr;
+	if (instr->kind != irInstr_If || proc->bounds_check_block == nullptr ||
+	    instr->If.false_block != proc->bounds_check_block) {
+		return false;
+	}
+	irValue *cond = instr->If.cond;
+	if (cond->kind != irValue_Instr || cond->Instr.kind != irInstr_BinaryOp ||
+	    cond->Instr.BinaryOp.op != Token_Lt) {
+		return false;
+	}
+	if (index_) *index_ = ir_opt_bce_unwrap_bitcast(cond->Instr.BinaryOp.left);
+	if (len_)   *len_   = ir_opt_bce_unwrap_bitcast(cond->Instr.BinaryOp.right);
+	return true;
+}
+
+// The failure edge is removed so the check becomes a jump to the rest of the block
+void ir_opt_bce_remove_inline_check(irProcedure *proc, irValue *check) {
+	irInstr *instr = &check->Instr;
+	irBlock *b    = instr->parent;
+	irBlock *done = instr->If.true_block;
+	irBlock *fail = instr->If.false_block;
+
+	instr->kind = irInstr_Jump;
+	instr->Jump.block = done;
+
+	isize count = 0;
+	for_array(i, b->succs) {
+		if (b->succs[i] != fail) {
+			b->succs[count++] = b->succs[i];
+		}
+	}
+	b->succs.count = count;
+	ir_remove_pred(fail, b);
+}
+
+bool ir_opt_bce_is_check_redundant(irBce *s, irBlock *b, irValue *check) {
+	irValue *index = nullptr;
+	irValue *len   = nullptr;
+	if (ir_opt_bce_inline_check(s->p->proc, check, &index, &len)) {
+		return ir_opt_bce_is_non_negative(s, index) && ir_opt_bce_is_less(s, b, index, len);
+	}
+
+	irInstrCall *call = &check->Instr.Call;
+	irValue **args = call->args;
+	if (call->value == s->slice_check_proc && call->arg_count == 6) {
+		irValue *low  = args[3];
+		irValue *high = args[4];
+		irValue *max  = args[5];
+		return ir_opt_bce_is_non_negative(s, low) &&
+		       ir_opt_bce_is_less_equal(s, low, high) &&
+		       ir_opt_bce_is_less_equal(s, high, max);
+	}
+	if (call->value == s->substring_check_proc && call->arg_count == 5) {
+		irValue *low  = args[3];
+		irValue *high = args[4];
+		return ir_opt_bce_is_non_negative(s, low) &&
+		       ir_opt_bce_is_less_equal(s, low, high);
+	}
+	return false;
+}
+
+bool ir_opt_bce_are_checks_equal(irBce *s, irValue *cx, irValue *cy) {
+	if (cx->Instr.kind != cy->Instr.kind) {
+		return false;
+	}
+	irProcedure *proc = s->p->proc;
+	irValue *xi = nullptr, *xl = nullptr;
+	irValue *yi = nullptr, *yl = nullptr;
+	bool x_inline = ir_opt_bce_inline_check(proc, cx, &xi, &xl);
+	bool y_inline = ir_opt_bce_inline_check(proc, cy, &yi, &yl);
+	if (x_inline || y_inline) {
+		return x_inline && y_inline &&
+		       ir_opt_bce_are_values_equal(s, xi, yi) &&
+		       ir_opt_bce_are_values_equal(s, xl, yl);
+	}
+
+	irInstrCall *x = &cx->Instr.Call;
+	irInstrCall *y = &cy->Instr.Call;
+	if (x->value != y->value || x->arg_count != y->arg_count) {
+		return false;
+	}
+	// The first three arguments are the position
+	for (isize i = 3; i < x->arg_count; i++) {
+		if (!ir_opt_bce_are_values_equal(s, x->args[i], y->args[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+irValue *ir_opt_bce_find_proc(irModule *m, char *name) {
+	irValue **found = ir_module_find_member(m, make_string_c(name));
+	if (found != nullptr) {
+		return *found;
+	}
+	return nullptr;
+}
+
+void ir_opt_bounds_check_elim(irOptPass *p) {
+	irProcedure *proc = p->proc;
+	irBce s = {};
+	s.p = p;
+	s.slice_check_proc     = ir_opt_bce_find_proc(proc->module, "__slice_expr_error");
+	s.substring_check_proc = ir_opt_bce_find_proc(proc->module, "__substring_expr_error");
+
+	Array<irValue *> checks = {}; // In a preorder of the dominator tree
+	array_init(&checks, heap_allocator());
+	Array<irBlock *> stack = {};
+	array_init(&stack, heap_allocator());
+	array_add(&stack, proc->blocks[0]);
+	while (stack.count > 0) {
+		irBlock *b = array_pop(&stack);
+		for_array(i, b->dom.children) {
+			array_add(&stack, b->dom.children[i]);
+		}
+		for_array(i, b->instrs) {
+			irValue *v = b->instrs[i];
+			if (v->Instr.kind != irInstr_Call) {
+				continue;
+			}
+			irValue *value = v->Instr.Call.value;
+			if (value != nullptr &&
+			    (value == s.slice_check_proc ||
+			     value == s.substring_check_proc)) {
+				array_add(&checks, v);
+			}
+		}
+		if (b->instrs.count > 0) {
+			irValue *term = b->instrs[b->instrs.count-1];
+			if (ir_opt_bce_inline_check(proc, term, nullptr, nullptr)) {
+				array_add(&checks, term);
+			}
+		}
+	}
+	array_free(&stack);
+	if (checks.count == 0) {
+		array_free(&checks);
+		return;
+	}
+
+	gbAllocator ta = proc->module->tmp_allocator;
+	s.single_stores = gb_alloc_array(ta, irValue *, p->count);
+	s.lower_bounds  = gb_alloc_array(ta, i64, p->count);
+
+	ir_opt_build_referrers(proc);
+	for (isize i = 0; i < p->count; i++) {
+		irValue *local = p->instrs[i];
+		if (local->Instr.kind != irInstr_Local) {
+			continue;
+		}
+		irValue *store = nullptr;
+		bool ok = true;
+		Array<irValue *> refs = local->Instr.Local.referrers;
+		for_array(j, refs) {
+			irInstr *r = &refs[j]->Instr;
+			if (r->kind == irInstr_Load || r->kind == irInstr_DebugDeclare) {
+				continue;
+			}
+			if (r->kind == irInstr_Store && r->Store.address == local &&
+			    r->Store.value != local && !r->Store.atomic && store == nullptr) {
+				store = refs[j];
+				continue;
+			}
+			ok = false;
+			break;
+		}
+		if (ok) {
+			s.single_stores[i] = store;
+		}
+	}
+	ir_opt_bce_compute_lower_bounds(&s);
+
+	for_array(i, checks) {
+		irValue *check = checks[i];
+		irBlock *b = check->Instr.parent;
+		bool redundant = ir_opt_bce_is_check_redundant(&s, b, check);
+		for (isize j = 0; !redundant && j < i; j++) {
+			// A failing check never returns so an identical check which it dominates cannot fail
+			irValue *prev = checks[j];
+			irBlock *pb = prev->Instr.parent;
+			bool dominates = pb->dom.pre <= b->dom.pre && b->dom.post <= pb->dom.post;
+			redundant = dominates && ir_opt_bce_are_checks_equal(&s, prev, check);
+		}
+		if (!redundant) {
+			continue;
+		}
+		if (check->Instr.kind == irInstr_If) {
+			ir_opt_bce_remove_inline_check(proc, check);
+		} else {
+			ir_opt_pass_remove(p, check);
+		}
+		ir_opt_bounds_check_removed += 1;
+	}
+	ir_opt_bounds_check_count += checks.count;
+
+	irBlock *fail = proc->bounds_check_block;
+	if (fail != nullptr && fail->preds.count == 0) {
+		for_array(i, proc->blocks) {
+			if (proc->blocks[i] == fail) {
+				proc->blocks[i] = nullptr;
+			}
+		}
+		ir_remove_dead_blocks(proc);
+		proc->bounds_check_block = nullptr;
+	}
+
+	array_free(&checks);
+}
+
+
+enum irOptPassKind {
+	irOptPass_Blocks,
+	irOptPass_Mem2Reg,
+	irOptPass_PhiElim,
+	irOptPass_CopyElim,
+	irOptPass_Cse,
+	irOptPass_DeadStoreElim,
+	irOptPass_BoundsCheckElim,
+	irOptPass_Dce,
+
+	irOptPass_COUNT,
+};
+
+String const ir_opt_pass_strings[irOptPass_COUNT] = {
+	{cast(u8 *)"blocks",                gb_size_of("blocks")-1},
+	{cast(u8 *)"mem2reg",               gb_size_of("mem2reg")-1},
+	{cast(u8 *)"phi elim",              gb_size_of("phi elim")-1},
+	{cast(u8 *)"copy elim",             gb_size_of("copy elim")-1},
+	{cast(u8 *)"cse",                   gb_size_of("cse")-1},
+	{cast(u8 *)"dead store/load elim",  gb_size_of("dead store/load elim")-1},
+	{cast(u8 *)"bounds check elim",     gb_size_of("bounds check elim")-1},
+	{cast(u8 *)"dce",                   gb_size_of("dce")-1},
+};
+
+// The lowest `-ir-opt` level at which each pass is run
+i32 const ir_opt_pass_levels[irOptPass_COUNT] = {
+	0, // blocks
+	1, // mem2reg
+	2, // phi elim
+	2, // copy elim
+	2, // cse
+	2, // dead store/load elim
+	2, // bounds check elim
+	2, // dce
+};
+
+struct irOptPassStats {
+	bool ran;
+	u64  time;
+	i64  removed; // Net count of the instructions removed, `mem2reg` adds phi nodes
+};
+
+gb_global irOptPassStats ir_opt_pass_stats[irOptPass_COUNT] = {};
+
+i64 ir_opt_instr_count(irModule *m) {
+	i64 count = 0;
+	for_array(i, m->procs) {
+		irProcedure *proc = m->procs[i];
+		for_array(j, proc->blocks) {
+			count += proc->blocks[j]->instrs.count;
+		}
+	}
+	return count;
+}
+
+void ir_opt_run_pass(irProcedure *proc, irOptPassKind kind) {
+	switch (kind) {
+	case irOptPass_Blocks:
+		ir_opt_blocks(proc);
+		return;
+	case irOptPass_Mem2Reg:
+		ir_opt_build_referrers(proc);
+		ir_opt_build_dom_tree(proc);
+		ir_opt_mem2reg(proc);
+		return;
+	}
+
+	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&proc->module->tmp_arena);
+	irOptPass p = {};
+	ir_opt_pass_init(&p, proc);
+	switch (kind) {
+	case irOptPass_PhiElim:         ir_opt_phi_elim(&p);          break;
+	case irOptPass_CopyElim:        ir_opt_copy_elim(&p);         break;
+	case irOptPass_Cse:             ir_opt_cse(&p);               break;
+	case irOptPass_DeadStoreElim:   ir_opt_dead_store_elim(&p);   break;
+	case irOptPass_BoundsCheckElim: ir_opt_bounds_check_elim(&p); break;
+	case irOptPass_Dce:             ir_opt_dce(&p);               break;
+	}
+	ir_opt_pass_sweep(&p);
+	gb_temp_arena_memory_end(tmp);
+}
+
+
+void ir_opt_tree(irGen *s) {
+	s->opt_called = true;
+	irModule *m = &s->module;
+	i32 level = build_context.ir_optimization_level;
+
+	// Each pass is run over every procedure before the next so that it can be timed as a whole
+	for (isize kind = 0; kind < irOptPass_COUNT; kind++) {
+		if (ir_opt_pass_levels[kind] > level) {
+			continue;
+		}
+		irOptPassStats *stats = &ir_opt_pass_stats[kind];
+		i64 instr_count = ir_opt_instr_count(m);
+		u64 start = time_stamp_time_now();
+
+		for_array(member_index, m->procs) {
+			irProcedure *proc = m->procs[member_index];
+			if (proc->blocks.count == 0) { // Prototype/external procedure
+				continue;
+			}
+			ir_opt_run_pass(proc, cast(irOptPassKind)kind);
+		}
+
+		stats->ran      = true;
+		stats->time    += time_stamp_time_now() - start;
+		stats->removed += instr_count - ir_opt_instr_count(m);
+	}
+
+	// TODO(bill): ir optimization
+	// [x] cse (common-subexpression) elim
+	// [x] copy elim
+	// [x] dead code elim
+	// [x] dead store/load elim
+	// [x] phi elim
+	// [ ] short circuit elim
+	// [x] bounds check elim
+	// [x] lift/mem2reg
+
+	for_array(member_index, m->procs) {
+		irProcedure *proc = m->procs[member_index];
+		if (proc->blocks.count == 0) {
+			continue;
+		}
 		ir_number_proc_registers(proc);
 	}
 }
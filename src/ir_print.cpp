@@ -622,8 +622,8 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 
 
 			isize value_count = type->Struct.fields.count;
-			ExactValue *values = gb_alloc_array(m->tmp_allocator, ExactValue, value_count);
-			bool *visited = gb_alloc_array(m->tmp_allocator, bool, value_count);
+			ExactValue *values = gb_alloc_array(region_allocator(Region_Print), ExactValue, value_count);
+			bool *visited = gb_alloc_array(region_allocator(Region_Print), bool, value_count);
 
 			if (cl->elems.count > 0) {
 				if (cl->elems[0]->kind == AstNode_FieldValue) {
@@ -635,7 +635,7 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 						TypeAndValue tav = type_and_value_of_expr(m->info, fv->value);
 						GB_ASSERT(tav.mode != Addressing_Invalid);
 
-						Selection sel = lookup_field(m->allocator, type, name, false);
+						Selection sel = lookup_field(region_allocator(Region_Print), type, name, false);
 						Entity *f = type->Struct.fields[sel.index[0]];
 
 						values[f->Variable.field_index] = tav.value;
@@ -1564,7 +1564,7 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		ir_fprintf(f, "call void ");
 		ir_print_encoded_global(f, str_lit("__bounds_check_error"), false);
 		ir_write_byte(f, '(');
-		ir_print_compound_element(f, m, exact_value_string(bc->pos.file), t_string);
+		ir_print_compound_element(f, m, exact_value_string(token_pos_file(bc->pos)), t_string);
 		ir_write_string(f, str_lit(", "));
 
 		ir_print_type(f, m, t_int);
@@ -1600,7 +1600,7 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		}
 
 		ir_write_byte(f, '(');
-		ir_print_compound_element(f, m, exact_value_string(bc->pos.file), t_string);
+		ir_print_compound_element(f, m, exact_value_string(token_pos_file(bc->pos)), t_string);
 		ir_write_string(f, str_lit(", "));
 
 		ir_print_type(f, m, t_int);
@@ -1650,10 +1650,10 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		ir_print_value(f, m, dd->value, vt);
 		ir_write_string(f, ", metadata !DILocalVariable(name: \"");
 		ir_print_escape_string(f, name, false, false);
-		ir_fprintf(f, "\", scope: !%d, line: %td)", di->id, pos.line);
+		ir_fprintf(f, "\", scope: !%d, line: %d)", di->id, pos.line);
 		ir_write_string(f, ", metadata !DIExpression()");
 		ir_write_byte(f, ')');
-		ir_fprintf(f, ", !dbg !DILocation(line: %td, column: %td, scope: !%d)", pos.line, pos.column, di->id);
+		ir_fprintf(f, ", !dbg !DILocation(line: %d, column: %d, scope: !%d)", pos.line, pos.column, di->id);
 
 		ir_write_byte(f, '\n');
 		break;
@@ -1752,6 +1752,12 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 	if (proc->tags & ProcTag_no_inline) {
 		ir_write_string(f, "noinline ");
 	}
+	if (proc->tags & ProcTag_cold) {
+		ir_write_string(f, "cold ");
+	}
+	if (proc->tags & ProcTag_no_return) {
+		ir_write_string(f, "noreturn ");
+	}
 
 
 	if (proc->entity != nullptr) {
@@ -2000,7 +2006,7 @@ void print_llvm_ir(irGen *ir) {
 				            "name: \"%.*s\", "
 				            // "linkageName: \"\", "
 				            "file: !%d, "
-				            "line: %td, "
+				            "line: %d, "
 				            "isDefinition: true, "
 				            "isLocal: false, "
 				            "unit: !0"
@@ -2026,4 +2032,5 @@ void print_llvm_ir(irGen *ir) {
 	}
 #endif
 	ir_file_buffer_destroy(f);
+	region_release(Region_Print);
 }
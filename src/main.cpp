@@ -1,7 +1,7 @@
 #define USE_CUSTOM_BACKEND 0
 // #define NO_ARRAY_BOUNDS_CHECK
 #if !defined(USE_THREADED_PARSER)
-#define USE_THREADED_PARSER 0
+#define USE_THREADED_PARSER 1
 #endif
 
 #include "common.cpp"
@@ -174,10 +174,13 @@ enum BuildFlagKind {
 	BuildFlag_Invalid,
 
 	BuildFlag_OptimizationLevel,
+	BuildFlag_IrOptimizationLevel,
 	BuildFlag_ShowTimings,
 	BuildFlag_ThreadCount,
 	BuildFlag_KeepTempFiles,
 	BuildFlag_Collection,
+	BuildFlag_LazyProcBodies,
+	BuildFlag_LazyCheck,
 
 	BuildFlag_COUNT,
 };
@@ -239,10 +242,13 @@ bool parse_build_flags(Array<String> args) {
 	Array<BuildFlag> build_flags = {};
 	array_init(&build_flags, heap_allocator(), BuildFlag_COUNT);
 	add_flag(&build_flags, BuildFlag_OptimizationLevel, str_lit("opt"),             BuildFlagParam_Integer);
+	add_flag(&build_flags, BuildFlag_IrOptimizationLevel, str_lit("ir-opt"),        BuildFlagParam_Integer);
 	add_flag(&build_flags, BuildFlag_ShowTimings,       str_lit("show-timings"),    BuildFlagParam_None);
 	add_flag(&build_flags, BuildFlag_ThreadCount,       str_lit("thread-count"),    BuildFlagParam_Integer);
 	add_flag(&build_flags, BuildFlag_KeepTempFiles,     str_lit("keep-temp-files"), BuildFlagParam_None);
 	add_flag(&build_flags, BuildFlag_Collection,        str_lit("collection"),      BuildFlagParam_String);
+	add_flag(&build_flags, BuildFlag_LazyProcBodies,    str_lit("lazy-proc-bodies"), BuildFlagParam_None);
+	add_flag(&build_flags, BuildFlag_LazyCheck,         str_lit("lazy-check"),      BuildFlagParam_None);
 
 
 	Array<String> flag_args = args;
@@ -376,6 +382,16 @@ bool parse_build_flags(Array<String> args) {
 							GB_ASSERT(value.kind == ExactValue_Integer);
 							build_context.optimization_level = cast(i32)i128_to_i64(value.value_integer);
 							break;
+						case BuildFlag_IrOptimizationLevel:
+							GB_ASSERT(value.kind == ExactValue_Integer);
+							// Reject anything other than a single digit from 0 to 2, e.g. `-ir-opt=3` or `-ir-opt=02`
+							if (param.len != 1 || param[0] < '0' || param[0] > '2') {
+								gb_printf_err("Invalid flag parameter for `%.*s` = `%.*s`, expected a level from 0 to 2\n", LIT(name), LIT(param));
+								bad_flags = true;
+								break;
+							}
+							build_context.ir_optimization_level = cast(i32)i128_to_i64(value.value_integer);
+							break;
 						case BuildFlag_ShowTimings:
 							GB_ASSERT(value.kind == ExactValue_Invalid);
 							build_context.show_timings = true;
@@ -394,6 +410,14 @@ bool parse_build_flags(Array<String> args) {
 							GB_ASSERT(value.kind == ExactValue_Invalid);
 							build_context.keep_temp_files = true;
 							break;
+						case BuildFlag_LazyProcBodies:
+							GB_ASSERT(value.kind == ExactValue_Invalid);
+							build_context.lazy_proc_bodies = true;
+							break;
+						case BuildFlag_LazyCheck:
+							GB_ASSERT(value.kind == ExactValue_Invalid);
+							build_context.lazy_check = true;
+							break;
 
 						case BuildFlag_Collection: {
 							GB_ASSERT(value.kind == ExactValue_String);
@@ -495,6 +519,16 @@ void show_timings(Checker *c, Timings *t) {
 		gb_printf("us/Token     - %.3f\n", 1.0e6*parse_time/cast(f64)tokens);
 		gb_printf("\n");
 	}
+	{
+		i64 hits   = gb_atomic64_load(&type_layout_cache_hits);
+		i64 misses = gb_atomic64_load(&type_layout_cache_misses);
+		i64 total  = gb_max(hits+misses, 1);
+		gb_printf("Type size/align cache\n");
+		gb_printf("Hits         - %lld\n", cast(long long)hits);
+		gb_printf("Misses       - %lld\n", cast(long long)misses);
+		gb_printf("Hit rate     - %.2f%%\n", 100.0*cast(f64)hits/cast(f64)total);
+		gb_printf("\n");
+	}
 	{
 		f64 total_time = t->total_time_seconds;
 		gb_printf("Total pass\n");
@@ -504,6 +538,53 @@ void show_timings(Checker *c, Timings *t) {
 		gb_printf("us/Token     - %.3f\n", 1.0e6*total_time/cast(f64)tokens);
 		gb_printf("\n");
 	}
+	{
+		isize total_used = 0;
+		isize total_size = 0;
+		gb_printf("AST memory   - used bytes, reserved bytes\n");
+		for_array(i, p->files) {
+			AstFile *f = p->files[i];
+			total_used += f->arena.total_used;
+			total_size += f->arena.total_size;
+			gb_printf("%12td %12td  %.*s\n", f->arena.total_used, f->arena.total_size, LIT(f->fullpath));
+		}
+		gb_printf("%12td %12td  total\n", total_used, total_size);
+		gb_printf("\n");
+	}
+	{
+		gb_printf("Region memory - allocations, allocated bytes, peak reserved bytes, blocks\n");
+		for (isize i = 0; i < Region_COUNT; i++) {
+			Region *r = &global_regions[i];
+			gb_printf("%12lld %12lld %12lld %6lld  %.*s\n",
+			          cast(long long)gb_atomic64_load(&r->allocation_count),
+			          cast(long long)gb_atomic64_load(&r->bytes_allocated),
+			          cast(long long)r->peak_bytes_reserved,
+			          cast(long long)r->block_count,
+			          LIT(region_strings[i]));
+		}
+		gb_printf("\n");
+	}
+	{
+		gb_printf("IR passes    - ms, instructions removed (-ir-opt=%d)\n", build_context.ir_optimization_level);
+		for (isize i = 0; i < irOptPass_COUNT; i++) {
+			irOptPassStats *stats = &ir_opt_pass_stats[i];
+			if (!stats->ran) {
+				continue;
+			}
+			gb_printf("%12.3f %12lld  %.*s\n",
+			          1000.0*cast(f64)stats->time/cast(f64)t->freq,
+			          cast(long long)stats->removed,
+			          LIT(ir_opt_pass_strings[i]));
+		}
+		gb_printf("\n");
+	}
+	if (ir_opt_pass_stats[irOptPass_BoundsCheckElim].ran) {
+		gb_printf("Bounds checks - removed, total\n");
+		gb_printf("%12lld %12lld\n",
+		          cast(long long)ir_opt_bounds_check_removed,
+		          cast(long long)ir_opt_bounds_check_count);
+		gb_printf("\n");
+	}
 }
 
 void remove_temp_files(String output_base) {
@@ -542,6 +623,13 @@ int main(int arg_count, char **arg_ptr) {
 	init_string_buffer_memory();
 	init_scratch_memory(gb_megabytes(10));
 	init_global_error_collector();
+	init_token_pos_files();
+	init_type_offsets_mutex();
+	init_type_intern_table();
+	init_global_regions();
+	init_keyword_hash_table();
+	init_atom_table();
+	init_fullpath_cache();
 
 	array_init(&library_collections, heap_allocator());
 	// NOTE(bill): `core` cannot be (re)defined by the user
@@ -596,6 +684,7 @@ int main(int arg_count, char **arg_ptr) {
 	if (!parse_build_flags(args)) {
 		return 1;
 	}
+	region_track_statistics = build_context.show_timings;
 
 
 	// NOTE(bill): add `shared` directory if it is not already set
@@ -652,7 +741,7 @@ int main(int arg_count, char **arg_ptr) {
 		return 1;
 	}
 
-	if (!ssa_generate(&parser, &checker.info)) {
+	if (!ssa_generate(&parser, checker.info)) {
 		return 1;
 	}
 #else
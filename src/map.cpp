@@ -6,8 +6,7 @@
 #define MAP_UTIL_STUFF
 // NOTE(bill): This util stuff is the same for every `Map`
 struct MapFindResult {
-	isize hash_index;
-	isize entry_prev;
+	isize slot_index;
 	isize entry_index;
 };
 
@@ -16,8 +15,11 @@ enum HashKeyKind {
 	HashKey_String,
 	HashKey_Ptr,
 	HashKey_PtrAndId,
+	HashKey_Atom,
 };
 
+struct Atom;
+
 struct PtrAndId {
 	void *ptr;
 	u32   id;
@@ -31,6 +33,7 @@ struct HashKey {
 		String       string; // if String, s.len > 0
 		void *       ptr;
 		PtrAndId ptr_and_id;
+		Atom *       atom;
 	};
 };
 
@@ -56,6 +59,11 @@ gb_inline HashKey hash_pointer(void *ptr) {
 	h.ptr = ptr;
 	return h;
 }
+gb_inline HashKey hash_integer(u64 u) {
+	HashKey h = {HashKey_Default};
+	h.key = u;
+	return h;
+}
 gb_inline HashKey hash_ptr_and_id(void *ptr, u32 id) {
 	HashKey h = {HashKey_PtrAndId};
 	h.key = cast(u64)cast(uintptr)ptr;
@@ -72,6 +80,12 @@ bool hash_key_equal(HashKey a, HashKey b) {
 				return a.string == b.string;
 			}
 			return false;
+		} else if (a.kind == HashKey_Atom) {
+			// Atoms are unique so only the pointers need comparing
+			if (b.kind == HashKey_Atom) {
+				return a.atom == b.atom;
+			}
+			return false;
 		} else if (a.kind == HashKey_PtrAndId) {
 			if (b.kind == HashKey_PtrAndId) {
 				return a.ptr_and_id.id == b.ptr_and_id.id;
@@ -85,19 +99,165 @@ bool hash_key_equal(HashKey a, HashKey b) {
 bool operator==(HashKey a, HashKey b) { return hash_key_equal(a, b); }
 bool operator!=(HashKey a, HashKey b) { return !hash_key_equal(a, b); }
 
+
+// `Map` and `PtrSet` keep their entries packed in an array and find them through a
+// `HashIndex`, an open addressing table of entry indices. The table is split into groups of
+// `HASH_GROUP_WIDTH` slots, each slot with a control byte which is either empty, deleted, or the
+// low 7 bits of the hash of its entry. A lookup tests a whole group against the hash at once
+// (with SSE2 on x86) and only compares the keys of the slots which match.
+enum {
+	HASH_GROUP_WIDTH  = 16,
+	HASH_CTRL_EMPTY   = 0x80,
+	HASH_CTRL_DELETED = 0xfe,
+};
+
+struct HashIndex {
+	u8 *  ctrl;     // `capacity` control bytes
+	i32 * slots;    // Entry index of each slot
+	isize capacity; // Zero or a power of two which is at least `HASH_GROUP_WIDTH`
+	isize used;     // Slots which are not empty, including the deleted ones
+	isize deleted;
+};
+
+gb_inline u64 hash_index_mix(u64 key) {
+	// Pointers and integer keys have very regular low bits
+	return fmix64(key);
+}
+
+gb_inline u8 hash_index_ctrl(u64 hash) {
+	return cast(u8)(hash & 0x7f);
+}
+
+gb_inline isize hash_index_first_group(HashIndex *ix, u64 hash) {
+	return cast(isize)(hash >> 7) & (ix->capacity-1) & ~cast(isize)(HASH_GROUP_WIDTH-1);
+}
+
+// Triangular steps between the groups visit every group as the group count is a power of two
+gb_inline isize hash_index_next_group(HashIndex *ix, isize group, isize *stride) {
+	*stride += HASH_GROUP_WIDTH;
+	return (group + *stride) & (ix->capacity-1);
+}
+
+// Returns a bit mask of the slots of the group whose control byte is `ctrl`
+gb_inline u32 hash_group_match(u8 const *group, u8 ctrl) {
+#if defined(GB_CPU_X86)
+	__m128i g = _mm_loadu_si128(cast(__m128i const *)group);
+	return cast(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(cast(char)ctrl)));
+#else
+	u32 mask = 0;
+	for (isize i = 0; i < HASH_GROUP_WIDTH; i++) {
+		if (group[i] == ctrl) {
+			mask |= 1u<<i;
+		}
+	}
+	return mask;
+#endif
+}
+
+// Returns a bit mask of the slots of the group which are empty or deleted
+gb_inline u32 hash_group_match_free(u8 const *group) {
+#if defined(GB_CPU_X86)
+	__m128i g = _mm_loadu_si128(cast(__m128i const *)group);
+	return cast(u32)_mm_movemask_epi8(g);
+#else
+	u32 mask = 0;
+	for (isize i = 0; i < HASH_GROUP_WIDTH; i++) {
+		if (group[i] & 0x80) {
+			mask |= 1u<<i;
+		}
+	}
+	return mask;
+#endif
+}
+
+void hash_index_init(HashIndex *ix, gbAllocator a, isize capacity) {
+	GB_ASSERT(capacity >= HASH_GROUP_WIDTH && gb_is_power_of_two(capacity));
+	u8 *data = cast(u8 *)gb_alloc_align(a, capacity*(1+gb_size_of(i32)), HASH_GROUP_WIDTH);
+	ix->ctrl     = data;
+	ix->slots    = cast(i32 *)(data + capacity);
+	ix->capacity = capacity;
+	ix->used     = 0;
+	ix->deleted  = 0;
+	gb_memset(ix->ctrl, HASH_CTRL_EMPTY, capacity);
+}
+
+void hash_index_destroy(HashIndex *ix, gbAllocator a) {
+	if (ix->ctrl != nullptr) {
+		gb_free(a, ix->ctrl);
+	}
+	gb_zero_item(ix);
+}
+
+void hash_index_clear(HashIndex *ix) {
+	if (ix->capacity > 0) {
+		gb_memset(ix->ctrl, HASH_CTRL_EMPTY, ix->capacity);
+	}
+	ix->used    = 0;
+	ix->deleted = 0;
+}
+
+// Keep at least one empty slot in every eight so that failed lookups stop early
+gb_inline bool hash_index_full(HashIndex *ix) {
+	return 8*(ix->used+1) > 7*ix->capacity;
+}
+
+// The minimum capacity to hold `count` live slots after a rehash
+gb_inline isize hash_index_capacity_for(isize count) {
+	isize capacity = HASH_GROUP_WIDTH;
+	while (8*count > 7*capacity) {
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+isize hash_index_find_free(HashIndex *ix, u64 hash) {
+	isize stride = 0;
+	isize group = hash_index_first_group(ix, hash);
+	for (;;) {
+		u32 mask = hash_group_match_free(ix->ctrl + group);
+		if (mask != 0) {
+			return group + bit_scan_forward(mask);
+		}
+		group = hash_index_next_group(ix, group, &stride);
+	}
+}
+
+gb_inline void hash_index_set(HashIndex *ix, isize slot, u64 hash, isize entry_index) {
+	if (ix->ctrl[slot] == HASH_CTRL_EMPTY) {
+		ix->used += 1;
+	} else {
+		ix->deleted -= 1;
+	}
+	ix->ctrl[slot]  = hash_index_ctrl(hash);
+	ix->slots[slot] = cast(i32)entry_index;
+}
+
+void hash_index_erase(HashIndex *ix, isize slot) {
+	// A lookup only stops at a group with an empty slot so if this group already has one, no
+	// lookup needs to probe past it and the slot can be made empty rather than deleted
+	u8 const *group = ix->ctrl + (slot & ~cast(isize)(HASH_GROUP_WIDTH-1));
+	if (hash_group_match(group, HASH_CTRL_EMPTY) != 0) {
+		ix->ctrl[slot] = HASH_CTRL_EMPTY;
+		ix->used -= 1;
+	} else {
+		ix->ctrl[slot] = HASH_CTRL_DELETED;
+		ix->deleted += 1;
+	}
+}
+
 #endif
 
 template <typename T>
 struct MapEntry {
 	HashKey  key;
-	isize    next;
+	isize    next; // Next entry with the same key for the `multi_map_*` procedures
 	T        value;
 };
 
 template <typename T>
 struct Map {
-	Array<isize>        hashes;
-	Array<MapEntry<T> > entries;
+	HashIndex           index;
+	Array<MapEntry<T> > entries; // In insertion order unless an entry has been removed
 };
 
 
@@ -123,14 +283,15 @@ template <typename T> void  multi_map_remove_all(Map<T> *h, HashKey key);
 
 template <typename T>
 gb_inline void map_init(Map<T> *h, gbAllocator a, isize capacity) {
-	array_init(&h->hashes,  a, capacity);
+	// The index is only allocated on the first insertion as a lot of maps are never used
+	gb_zero_item(&h->index);
 	array_init(&h->entries, a, capacity);
 }
 
 template <typename T>
 gb_inline void map_destroy(Map<T> *h) {
+	hash_index_destroy(&h->index, h->entries.allocator);
 	array_free(&h->entries);
-	array_free(&h->hashes);
 }
 
 template <typename T>
@@ -142,83 +303,71 @@ gb_internal isize map__add_entry(Map<T> *h, HashKey key) {
 	return h->entries.count-1;
 }
 
+// Finds the slot of `key`, the entry of which is the first of the entries with that key
 template <typename T>
 gb_internal MapFindResult map__find(Map<T> *h, HashKey key) {
-	MapFindResult fr = {-1, -1, -1};
-	if (h->hashes.count > 0) {
-		// fr.hash_index  = u128_to_i64(key.key % u128_from_i64(h->hashes.count));
-		fr.hash_index = key.key % h->hashes.count;
-		fr.entry_index = h->hashes[fr.hash_index];
-		while (fr.entry_index >= 0) {
-			if (hash_key_equal(h->entries[fr.entry_index].key, key)) {
-				return fr;
+	MapFindResult fr = {-1, -1};
+	HashIndex *ix = &h->index;
+	if (ix->capacity > 0) {
+		u64 hash = hash_index_mix(key.key);
+		u8 ctrl = hash_index_ctrl(hash);
+		isize stride = 0;
+		isize group = hash_index_first_group(ix, hash);
+		for (;;) {
+			u8 const *g = ix->ctrl + group;
+			for (u32 mask = hash_group_match(g, ctrl); mask != 0; mask &= mask-1) {
+				isize slot = group + bit_scan_forward(mask);
+				isize index = ix->slots[slot];
+				if (hash_key_equal(h->entries[index].key, key)) {
+					fr.slot_index  = slot;
+					fr.entry_index = index;
+					return fr;
+				}
 			}
-			fr.entry_prev = fr.entry_index;
-			fr.entry_index = h->entries[fr.entry_index].next;
-		}
-	}
-	return fr;
-}
-
-template <typename T>
-gb_internal MapFindResult map__find_from_entry(Map<T> *h, MapEntry<T> *e) {
-	MapFindResult fr = {-1, -1, -1};
-	if (h->hashes.count > 0) {
-		fr.hash_index  = e->key.key % h->hashes.count;
-		fr.entry_index = h->hashes[fr.hash_index];
-		while (fr.entry_index >= 0) {
-			if (&h->entries[fr.entry_index] == e) {
-				return fr;
+			if (hash_group_match(g, HASH_CTRL_EMPTY) != 0) {
+				break;
 			}
-			fr.entry_prev = fr.entry_index;
-			fr.entry_index = h->entries[fr.entry_index].next;
+			group = hash_index_next_group(ix, group, &stride);
 		}
 	}
 	return fr;
 }
 
+// Adds a slot for the first entry of a key which is not yet in the map
 template <typename T>
-gb_internal b32 map__full(Map<T> *h) {
-	return 0.75f * h->hashes.count <= h->entries.count;
+gb_internal void map__add_slot(Map<T> *h, HashKey key, isize entry_index) {
+	u64 hash = hash_index_mix(key.key);
+	isize slot = hash_index_find_free(&h->index, hash);
+	hash_index_set(&h->index, slot, hash, entry_index);
 }
 
 template <typename T>
 gb_inline void map_grow(Map<T> *h) {
-	isize new_count = ARRAY_GROW_FORMULA(h->entries.count);
-	map_rehash(h, new_count);
+	isize live = h->index.used - h->index.deleted;
+	map_rehash(h, ARRAY_GROW_FORMULA(live));
 }
 
+// Rebuilds the index with room for `new_count` keys
 template <typename T>
 void map_rehash(Map<T> *h, isize new_count) {
-	isize i, j;
-	Map<T> nh = {};
-	map_init(&nh, h->hashes.allocator);
-	array_resize(&nh.hashes, new_count);
-	array_reserve(&nh.entries, h->entries.count);
-	for (i = 0; i < new_count; i++) {
-		nh.hashes[i] = -1;
-	}
-	for (i = 0; i < h->entries.count; i++) {
+	gbAllocator a = h->entries.allocator;
+	hash_index_destroy(&h->index, a);
+	hash_index_init(&h->index, a, hash_index_capacity_for(gb_max(new_count, h->entries.count)));
+	for_array(i, h->entries) {
 		MapEntry<T> *e = &h->entries[i];
-		MapFindResult fr;
-		if (nh.hashes.count == 0) {
-			map_grow(&nh);
-		}
-		fr = map__find(&nh, e->key);
-		j = map__add_entry(&nh, e->key);
-		if (fr.entry_prev < 0) {
-			nh.hashes[fr.hash_index] = j;
-		} else {
-			nh.entries[fr.entry_prev].next = j;
+		MapFindResult fr = map__find(h, e->key);
+		if (fr.entry_index < 0) {
+			map__add_slot(h, e->key, i);
+			continue;
 		}
-		nh.entries[j].next = fr.entry_index;
-		nh.entries[j].value = e->value;
-		if (map__full(&nh)) {
-			map_grow(&nh);
+		// The slot must refer to the first entry of the key's chain
+		for (isize j = e->next; j >= 0; j = h->entries[j].next) {
+			if (j == fr.entry_index) {
+				h->index.slots[fr.slot_index] = cast(i32)i;
+				break;
+			}
 		}
 	}
-	map_destroy(h);
-	*h = nh;
 }
 
 template <typename T>
@@ -232,61 +381,61 @@ gb_inline T *map_get(Map<T> *h, HashKey key) {
 
 template <typename T>
 void map_set(Map<T> *h, HashKey key, T const &value) {
-	isize index;
-	MapFindResult fr;
-	if (h->hashes.count == 0)
-		map_grow(h);
-	fr = map__find(h, key);
+	MapFindResult fr = map__find(h, key);
 	if (fr.entry_index >= 0) {
-		index = fr.entry_index;
-	} else {
-		index = map__add_entry(h, key);
-		if (fr.entry_prev >= 0) {
-			h->entries[fr.entry_prev].next = index;
-		} else {
-			h->hashes[fr.hash_index] = index;
-		}
+		h->entries[fr.entry_index].value = value;
+		return;
 	}
-	h->entries[index].value = value;
-
-	if (map__full(h)) {
+	if (hash_index_full(&h->index)) {
 		map_grow(h);
 	}
+	isize index = map__add_entry(h, key);
+	h->entries[index].value = value;
+	map__add_slot(h, key, index);
 }
 
 
+// Removes the entry `fr.entry_index` which follows `entry_prev` in the chain of `fr.slot_index`
 template <typename T>
-void map__erase(Map<T> *h, MapFindResult fr) {
-	MapFindResult last;
-	if (fr.entry_prev < 0) {
-		h->hashes[fr.hash_index] = h->entries[fr.entry_index].next;
+void map__erase(Map<T> *h, MapFindResult fr, isize entry_prev) {
+	isize next = h->entries[fr.entry_index].next;
+	if (entry_prev >= 0) {
+		h->entries[entry_prev].next = next;
+	} else if (next >= 0) {
+		h->index.slots[fr.slot_index] = cast(i32)next;
 	} else {
-		h->entries[fr.entry_prev].next = h->entries[fr.entry_index].next;
-	}
-	if (fr.entry_index == h->entries.count-1) {
-		array_pop(&h->entries);
-		return;
+		hash_index_erase(&h->index, fr.slot_index);
 	}
-	h->entries[fr.entry_index] = h->entries[h->entries.count-1];
-	last = map__find(h, h->entries[fr.entry_index].key);
-	if (last.entry_prev >= 0) {
-		h->entries[last.entry_prev].next = fr.entry_index;
-	} else {
-		h->hashes[last.hash_index] = fr.entry_index;
+
+	// Move the last entry into the hole and fix whatever referred to it
+	isize last = h->entries.count-1;
+	if (fr.entry_index != last) {
+		h->entries[fr.entry_index] = h->entries[last];
+		MapFindResult lr = map__find(h, h->entries[last].key);
+		if (lr.entry_index == last) {
+			h->index.slots[lr.slot_index] = cast(i32)fr.entry_index;
+		} else {
+			isize i = lr.entry_index;
+			while (h->entries[i].next != last) {
+				i = h->entries[i].next;
+			}
+			h->entries[i].next = fr.entry_index;
+		}
 	}
+	array_pop(&h->entries);
 }
 
 template <typename T>
 void map_remove(Map<T> *h, HashKey key) {
 	MapFindResult fr = map__find(h, key);
 	if (fr.entry_index >= 0) {
-		map__erase(h, fr);
+		map__erase(h, fr, -1);
 	}
 }
 
 template <typename T>
 gb_inline void map_clear(Map<T> *h) {
-	array_clear(&h->hashes);
+	hash_index_clear(&h->index);
 	array_clear(&h->entries);
 }
 
@@ -304,13 +453,10 @@ MapEntry<T> *multi_map_find_first(Map<T> *h, HashKey key) {
 template <typename T>
 MapEntry<T> *multi_map_find_next(Map<T> *h, MapEntry<T> *e) {
 	isize i = e->next;
-	while (i >= 0) {
-		if (hash_key_equal(h->entries[i].key, e->key)) {
-			return &h->entries[i];
-		}
-		i = h->entries[i].next;
+	if (i < 0) {
+		return nullptr;
 	}
-	return nullptr;
+	return &h->entries[i];
 }
 
 template <typename T>
@@ -334,34 +480,37 @@ void multi_map_get_all(Map<T> *h, HashKey key, T *items) {
 	}
 }
 
+// The newest value of a key is found first
 template <typename T>
 void multi_map_insert(Map<T> *h, HashKey key, T const &value) {
-	MapFindResult fr;
-	isize i;
-	if (h->hashes.count == 0) {
-		map_grow(h);
-	}
-	// Make
-	fr = map__find(h, key);
-	i = map__add_entry(h, key);
-	if (fr.entry_prev < 0) {
-		h->hashes[fr.hash_index] = i;
-	} else {
-		h->entries[fr.entry_prev].next = i;
+	MapFindResult fr = map__find(h, key);
+	if (fr.entry_index >= 0) {
+		isize index = map__add_entry(h, key);
+		h->entries[index].next  = fr.entry_index;
+		h->entries[index].value = value;
+		h->index.slots[fr.slot_index] = cast(i32)index;
+		return;
 	}
-	h->entries[i].next = fr.entry_index;
-	h->entries[i].value = value;
-	// Grow if needed
-	if (map__full(h)) {
+	if (hash_index_full(&h->index)) {
 		map_grow(h);
 	}
+	isize index = map__add_entry(h, key);
+	h->entries[index].value = value;
+	map__add_slot(h, key, index);
 }
 
 template <typename T>
 void multi_map_remove(Map<T> *h, HashKey key, MapEntry<T> *e) {
-	MapFindResult fr = map__find_from_entry(h, e);
-	if (fr.entry_index >= 0) {
-		map__erase(h, fr);
+	isize index = e - h->entries.data;
+	MapFindResult fr = map__find(h, key);
+	isize prev = -1;
+	for (isize i = fr.entry_index; i >= 0; i = h->entries[i].next) {
+		if (i == index) {
+			fr.entry_index = index;
+			map__erase(h, fr, prev);
+			return;
+		}
+		prev = i;
 	}
 }
 
@@ -372,3 +521,90 @@ void multi_map_remove_all(Map<T> *h, HashKey key) {
 	}
 }
 #endif
+
+
+
+// A `ShardedMap` splits its entries between several `Map`s, each with its own lock, so that it can be
+// shared between threads without them all contending on a single mutex. Values are returned by copy
+// as another thread could grow the shard at any time.
+#define SHARDED_MAP_SHARD_BITS 4
+#define SHARDED_MAP_SHARD_COUNT (1<<SHARDED_MAP_SHARD_BITS)
+
+template <typename T>
+struct ShardedMapShard {
+	gbMutex mutex;
+	Map<T>  map;
+};
+
+template <typename T>
+struct ShardedMap {
+	ShardedMapShard<T> shards[SHARDED_MAP_SHARD_COUNT];
+	bool               is_concurrent; // The shards are only locked when this is set
+};
+
+template <typename T> void sharded_map_init   (ShardedMap<T> *h, gbAllocator a);
+template <typename T> void sharded_map_destroy(ShardedMap<T> *h);
+template <typename T> bool sharded_map_get    (ShardedMap<T> *h, HashKey key, T *value_ = nullptr);
+template <typename T> void sharded_map_set    (ShardedMap<T> *h, HashKey key, T const &value);
+template <typename T> void sharded_map_remove (ShardedMap<T> *h, HashKey key);
+template <typename T> void sharded_map_clear  (ShardedMap<T> *h);
+
+
+template <typename T>
+void sharded_map_init(ShardedMap<T> *h, gbAllocator a) {
+	for (isize i = 0; i < SHARDED_MAP_SHARD_COUNT; i++) {
+		gb_mutex_init(&h->shards[i].mutex);
+		map_init(&h->shards[i].map, a);
+	}
+	h->is_concurrent = false;
+}
+
+template <typename T>
+void sharded_map_destroy(ShardedMap<T> *h) {
+	for (isize i = 0; i < SHARDED_MAP_SHARD_COUNT; i++) {
+		map_destroy(&h->shards[i].map);
+		gb_mutex_destroy(&h->shards[i].mutex);
+	}
+}
+
+template <typename T>
+gb_inline ShardedMapShard<T> *sharded_map__shard(ShardedMap<T> *h, HashKey key) {
+	// A different mix from `hash_index_mix` so that the keys of a shard are still spread evenly
+	u64 x = key.key * 0x9e3779b97f4a7c15ull;
+	return &h->shards[x >> (64-SHARDED_MAP_SHARD_BITS)];
+}
+
+template <typename T>
+bool sharded_map_get(ShardedMap<T> *h, HashKey key, T *value_) {
+	ShardedMapShard<T> *shard = sharded_map__shard(h, key);
+	if (h->is_concurrent) gb_mutex_lock(&shard->mutex);
+	T *found = map_get(&shard->map, key);
+	if (found != nullptr && value_ != nullptr) {
+		*value_ = *found;
+	}
+	if (h->is_concurrent) gb_mutex_unlock(&shard->mutex);
+	return found != nullptr;
+}
+
+template <typename T>
+void sharded_map_set(ShardedMap<T> *h, HashKey key, T const &value) {
+	ShardedMapShard<T> *shard = sharded_map__shard(h, key);
+	if (h->is_concurrent) gb_mutex_lock(&shard->mutex);
+	map_set(&shard->map, key, value);
+	if (h->is_concurrent) gb_mutex_unlock(&shard->mutex);
+}
+
+template <typename T>
+void sharded_map_remove(ShardedMap<T> *h, HashKey key) {
+	ShardedMapShard<T> *shard = sharded_map__shard(h, key);
+	if (h->is_concurrent) gb_mutex_lock(&shard->mutex);
+	map_remove(&shard->map, key);
+	if (h->is_concurrent) gb_mutex_unlock(&shard->mutex);
+}
+
+template <typename T>
+void sharded_map_clear(ShardedMap<T> *h) {
+	for (isize i = 0; i < SHARDED_MAP_SHARD_COUNT; i++) {
+		map_clear(&h->shards[i].map);
+	}
+}
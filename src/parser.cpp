@@ -1,6 +1,7 @@
 struct AstNode;
 struct Scope;
 struct DeclInfo;
+struct CheckerNodeTable;
 
 enum ParseFileError {
 	ParseFile_None,
@@ -15,6 +16,105 @@ enum ParseFileError {
 	ParseFile_Count,
 };
 
+// A growable bump allocator made from a chain of blocks. Each file owns one and only the
+// thread parsing that file allocates from it, so no locking is required. Nothing is freed individually,
+// the whole arena is reset or freed as a unit.
+struct AstArenaBlock {
+	AstArenaBlock *prev;
+	isize          size; // Usable bytes following the header
+	isize          used;
+};
+
+enum {
+	AST_ARENA_MIN_BLOCK_SIZE = gb_kilobytes(16),
+	AST_ARENA_MAX_BLOCK_SIZE = gb_megabytes(4),
+};
+
+struct AstArena {
+	gbAllocator    backing;
+	AstArenaBlock *curr_block;
+	isize          block_size;  // Size of the next block, doubles up to AST_ARENA_MAX_BLOCK_SIZE
+	isize          block_count;
+	isize          total_used;  // Bytes handed out including alignment padding
+	isize          total_size;  // Bytes reserved from `backing`
+};
+
+void ast_arena_init(AstArena *arena, gbAllocator backing, isize block_size) {
+	gb_zero_item(arena);
+	arena->backing    = backing;
+	arena->block_size = gb_clamp(block_size, AST_ARENA_MIN_BLOCK_SIZE, AST_ARENA_MAX_BLOCK_SIZE);
+}
+
+void ast_arena_push_block(AstArena *arena, isize min_size) {
+	isize size = gb_max(arena->block_size, min_size);
+	AstArenaBlock *block = cast(AstArenaBlock *)gb_alloc(arena->backing, gb_size_of(AstArenaBlock) + size);
+	if (block == nullptr) {
+		gb_printf_err("Out of memory: unable to allocate %td bytes for the AST\n", size);
+		gb_exit(1);
+	}
+	block->prev = arena->curr_block;
+	block->size = size;
+	block->used = 0;
+
+	arena->curr_block   = block;
+	arena->block_count += 1;
+	arena->total_size  += size;
+	arena->block_size   = gb_min(2*arena->block_size, AST_ARENA_MAX_BLOCK_SIZE);
+}
+
+void *ast_arena_alloc(AstArena *arena, isize size, isize alignment) {
+	AstArenaBlock *block = arena->curr_block;
+	for (;;) {
+		if (block != nullptr) {
+			u8 *start = cast(u8 *)(block+1) + block->used;
+			u8 *ptr   = cast(u8 *)gb_align_forward(start, alignment);
+			isize total = (ptr - start) + size;
+			if (block->used + total <= block->size) {
+				block->used       += total;
+				arena->total_used += total;
+				gb_zero_size(ptr, size);
+				return ptr;
+			}
+		}
+		ast_arena_push_block(arena, size + alignment);
+		block = arena->curr_block;
+	}
+}
+
+// Keeps the most recent (largest) block for reuse
+void ast_arena_reset(AstArena *arena) {
+	AstArenaBlock *block = arena->curr_block;
+	if (block == nullptr) {
+		return;
+	}
+	AstArenaBlock *prev = block->prev;
+	while (prev != nullptr) {
+		AstArenaBlock *next = prev->prev;
+		gb_free(arena->backing, prev);
+		prev = next;
+	}
+	block->prev = nullptr;
+	block->used = 0;
+
+	arena->block_count = 1;
+	arena->total_used  = 0;
+	arena->total_size  = block->size;
+}
+
+void ast_arena_free(AstArena *arena) {
+	AstArenaBlock *block = arena->curr_block;
+	while (block != nullptr) {
+		AstArenaBlock *prev = block->prev;
+		gb_free(arena->backing, block);
+		block = prev;
+	}
+	arena->curr_block  = nullptr;
+	arena->block_count = 0;
+	arena->total_used  = 0;
+	arena->total_size  = 0;
+}
+
+
 struct CommentGroup {
 	Array<Token> list; // Token_Comment
 };
@@ -38,10 +138,11 @@ struct ImportedFile {
 struct AstFile {
 	isize               id;
 	String              fullpath;
-	gbArena             arena;
+	AstArena            arena;
 	Tokenizer           tokenizer;
-	Array<Token>        tokens;
+	Array<PackedToken>  tokens;
 	isize               curr_token_index;
+	isize               curr_line_index; // Line of `curr_token`, used to unpack the next token
 	Token               curr_token;
 	Token               prev_token; // previous non-comment
 
@@ -58,12 +159,16 @@ struct AstFile {
 	ImportedFileKind    file_kind;
 	bool                is_global_scope;
 	Array<AstNode *>    imports_and_exports; // `import` `using import` `export`
+	Array<ImportedFile> imports;             // In declaration order, including duplicates
 
 
 	AstNode *           curr_proc;
 	isize               scope_level;
+	gbMutex             lazy_body_mutex; // Held while a lazy procedure body is parsed or the arena is used after parsing
+	u32                 node_count;  // Used for `AstNode.index`
 	Scope *             scope;       // NOTE(bill): Created in checker
 	DeclInfo *          decl_info;   // NOTE(bill): Created in checker
+	CheckerNodeTable *  node_table;  // Created in checker
 
 
 	CommentGroup        lead_comment; // Comment (block) before the decl
@@ -78,6 +183,16 @@ struct AstFile {
 };
 
 
+// The set of every path imported so far. It is split into shards each with its own
+// lock so that the parsing threads only contend when their paths hash to the same shard
+#define IMPORT_PATH_SHARD_BITS 4
+#define IMPORT_PATH_SHARD_COUNT (1<<IMPORT_PATH_SHARD_BITS)
+
+struct ImportPathShard {
+	gbMutex   mutex;
+	Map<bool> paths; // Key: String (fullpath)
+};
+
 struct Parser {
 	String              init_fullpath;
 	Array<AstFile *>    files;
@@ -85,7 +200,15 @@ struct Parser {
 	isize               total_token_count;
 	isize               total_line_count;
 	gbMutex             file_add_mutex;
-	gbMutex             file_decl_mutex;
+	ImportPathShard     import_paths[IMPORT_PATH_SHARD_COUNT];
+
+	// `imports` doubles as the work queue for the parsing threads
+	gbMutex             import_mutex;
+	gbSemaphore         worker_semaphore;
+	isize               curr_import_index;
+	isize               active_worker_count;
+	isize               idle_worker_count;
+	ParseFileError      worker_error;
 };
 
 enum ProcTag {
@@ -94,6 +217,8 @@ enum ProcTag {
 
 
 	ProcTag_require_results = 1<<4,
+	ProcTag_no_return       = 1<<5,
+	ProcTag_cold            = 1<<6,
 
 	ProcTag_foreign         = 1<<10,
 	ProcTag_export          = 1<<11,
@@ -155,7 +280,8 @@ Array<AstNode *> make_ast_node_array(AstFile *f, isize init_capacity = 8) {
 // all the nodes and even memcpy in a different kind of node
 #define AST_NODE_KINDS \
 	AST_NODE_KIND(Ident,          "identifier",      struct { \
-		Token token;      \
+		Token  token;     \
+		Atom * atom;      \
 	}) \
 	AST_NODE_KIND(Implicit,       "implicit",        Token) \
 	AST_NODE_KIND(Undef,          "undef",           Token) \
@@ -173,6 +299,7 @@ Array<AstNode *> make_ast_node_array(AstFile *f, isize init_capacity = 8) {
 		AstNode *body;            \
 		u64      tags;            \
 		String   link_name;       \
+		isize    lazy_body_index; \
 	}) \
 	AST_NODE_KIND(CompoundLit, "compound literal", struct { \
 		AstNode *type; \
@@ -471,7 +598,7 @@ AST_NODE_KIND(_TypeBegin, "", i32) \
 	}) \
 AST_NODE_KIND(_TypeEnd,  "", i32)
 
-enum AstNodeKind {
+enum AstNodeKind : u16 {
 	AstNode_Invalid,
 #define AST_NODE_KIND(_kind_name_, ...) GB_JOIN2(AstNode_, _kind_name_),
 	AST_NODE_KINDS
@@ -492,7 +619,8 @@ String const ast_node_strings[] = {
 
 struct AstNode {
 	AstNodeKind kind;
-	u32         stmt_state_flags;
+	u16         stmt_state_flags;
+	u32         index; // Dense index within `file` starting at 1, 0 if the node has none, e.g. a clone
 	AstFile *   file;
 	union {
 #define AST_NODE_KIND(_kind_name_, name, ...) GB_JOIN2(AstNode, _kind_name_) _kind_name_;
@@ -502,6 +630,21 @@ struct AstNode {
 };
 
 
+// A node is only allocated with the common header and its own variant rather than the
+// whole union, so only ever access the variant which matches `kind`
+gb_global isize const ast_node_sizes[AstNode_Count] = {
+	gb_offset_of(AstNode, BadExpr),
+#define AST_NODE_KIND(_kind_name_, ...) gb_offset_of(AstNode, _kind_name_) + gb_size_of(GB_JOIN2(AstNode, _kind_name_)),
+	AST_NODE_KINDS
+#undef AST_NODE_KIND
+};
+
+gb_inline isize ast_node_size(AstNodeKind kind) {
+	GB_ASSERT(0 <= kind && kind < AstNode_Count);
+	return ast_node_sizes[kind];
+}
+
+
 #define ast_node(n_, Kind_, node_) GB_JOIN2(AstNode, Kind_) *n_ = &(node_)->Kind_; GB_ASSERT((node_)->kind == GB_JOIN2(AstNode_, Kind_))
 #define case_ast_node(n_, Kind_, node_) case GB_JOIN2(AstNode_, Kind_): { ast_node(n_, Kind_, node_);
 #ifndef case_end
@@ -643,8 +786,10 @@ AstNode *clone_ast_node(gbAllocator a, AstNode *node) {
 	if (node == nullptr) {
 		return nullptr;
 	}
-	AstNode *n = gb_alloc_item(a, AstNode);
-	gb_memmove(n, node, gb_size_of(AstNode));
+	isize size = ast_node_size(node->kind);
+	AstNode *n = cast(AstNode *)gb_alloc_align(a, size, gb_align_of(AstNode));
+	gb_memmove(n, node, size);
+	n->index = 0; // The clone must not share what the checker records for `node`
 
 	switch (n->kind) {
 	default: GB_PANIC("Unhandled AstNode %.*s", LIT(ast_node_strings[n->kind])); break;
@@ -938,14 +1083,10 @@ bool ast_node_expect(AstNode *node, AstNodeKind kind) {
 
 // NOTE(bill): And this below is why is I/we need a new language! Discriminated unions are a pain in C/C++
 AstNode *make_ast_node(AstFile *f, AstNodeKind kind) {
-	gbArena *arena = &f->arena;
-	if (gb_arena_size_remaining(arena, GB_DEFAULT_MEMORY_ALIGNMENT) <= gb_size_of(AstNode)) {
-		// NOTE(bill): If a syntax error is so bad, just quit!
-		gb_exit(1);
-	}
-	AstNode *node = gb_alloc_item(gb_arena_allocator(arena), AstNode);
-	node->kind = kind;
-	node->file = f;
+	AstNode *node = cast(AstNode *)ast_arena_alloc(&f->arena, ast_node_size(kind), gb_align_of(AstNode));
+	node->kind  = kind;
+	node->index = ++f->node_count;
+	node->file  = f;
 	return node;
 }
 
@@ -1080,6 +1221,7 @@ AstNode *ast_deref_expr(AstFile *f, AstNode *expr, Token op) {
 AstNode *ast_ident(AstFile *f, Token token) {
 	AstNode *result = make_ast_node(f, AstNode_Ident);
 	result->Ident.token = token;
+	result->Ident.atom  = make_atom(token.string);
 	return result;
 }
 
@@ -1125,6 +1267,14 @@ AstNode *ast_proc_lit(AstFile *f, AstNode *type, AstNode *body, u64 tags, String
 	return result;
 }
 
+// `lazy_body_index` is the index of the body's `{` token; it can never be the first
+// token in the file as the `proc` token must come before it
+AstNode *ast_proc_lit_lazy(AstFile *f, AstNode *type, isize lazy_body_index, u64 tags, String link_name) {
+	AstNode *result = ast_proc_lit(f, type, nullptr, tags, link_name);
+	result->ProcLit.lazy_body_index = lazy_body_index;
+	return result;
+}
+
 AstNode *ast_field_value(AstFile *f, AstNode *field, AstNode *value, Token eq) {
 	AstNode *result = make_ast_node(f, AstNode_FieldValue);
 	result->FieldValue.field = field;
@@ -1578,10 +1728,15 @@ AstNode *ast_foreign_library_decl(AstFile *f, Token token, Token filepath, Token
 }
 
 
+Token ast_file_token(AstFile *f, isize index) {
+	return tokenizer_unpack_token(&f->tokenizer, f->tokens[index]);
+}
+
 bool next_token0(AstFile *f) {
 	// Token prev = f->curr_token;
 	if (f->curr_token_index+1 < f->tokens.count) {
-		f->curr_token = f->tokens[++f->curr_token_index];
+		f->curr_token_index += 1;
+		f->curr_token = tokenizer_unpack_token(&f->tokenizer, f->tokens[f->curr_token_index], &f->curr_line_index);
 		return true;
 	}
 	syntax_error(f->curr_token, "Token is EOF");
@@ -1669,7 +1824,7 @@ TokenKind look_ahead_token_kind(AstFile *f, isize amount) {
 	isize index = f->curr_token_index;
 	while (amount > 0) {
 		index++;
-		kind = f->tokens[index].kind;
+		kind = cast(TokenKind)f->tokens[index].kind;
 		if (kind != Token_Comment) {
 			amount--;
 		}
@@ -1821,6 +1976,8 @@ Token expect_closing(AstFile *f, TokenKind kind, String context) {
 	return expect_token(f, kind);
 }
 
+bool ast_proc_lit_has_body(AstNode *proc_lit);
+
 bool is_semicolon_optional_for_node(AstFile *f, AstNode *s) {
 	if (s == nullptr) {
 		return false;
@@ -1847,7 +2004,7 @@ bool is_semicolon_optional_for_node(AstFile *f, AstNode *s) {
 	case AstNode_BitFieldType:
 		return true;
 	case AstNode_ProcLit:
-		return s->ProcLit.body != nullptr;
+		return ast_proc_lit_has_body(s);
 
 	case AstNode_ImportDecl:
 	case AstNode_ExportDecl:
@@ -1913,6 +2070,7 @@ AstNode *        parse_proc_type(AstFile *f, Token proc_token, String *link_name
 Array<AstNode *> parse_stmt_list(AstFile *f);
 AstNode *        parse_stmt(AstFile *f);
 AstNode *        parse_body(AstFile *f);
+bool             skip_body(AstFile *f);
 
 
 
@@ -2090,6 +2248,8 @@ void parse_proc_tags(AstFile *f, u64 *tags, String *link_name, ProcCallingConven
 		ELSE_IF_ADD_TAG(no_bounds_check)
 		ELSE_IF_ADD_TAG(inline)
 		ELSE_IF_ADD_TAG(no_inline)
+		ELSE_IF_ADD_TAG(no_return)
+		ELSE_IF_ADD_TAG(cold)
 		else if (tag_name == "cc_odin") {
 			if (cc == ProcCC_Invalid) {
 				cc = ProcCC_Odin;
@@ -2178,7 +2338,7 @@ AstNode *convert_stmt_to_expr(AstFile *f, AstNode *statement, String kind) {
 	syntax_error(f->curr_token, "Expected `%.*s`, found a simple statement.", LIT(kind));
 	Token end = f->curr_token;
 	if (f->tokens.count < f->curr_token_index) {
-		end = f->tokens[f->curr_token_index+1];
+		end = ast_file_token(f, f->curr_token_index+1);
 	}
 	return ast_bad_expr(f, f->curr_token, end);
 }
@@ -2309,6 +2469,12 @@ AstNode *parse_operand(AstFile *f, bool lhs) {
 			if ((tags & ProcTag_foreign) != 0) {
 				syntax_error(token, "A procedure tagged as `#foreign` cannot have a body");
 			}
+			if (build_context.lazy_proc_bodies) {
+				isize open_index = f->curr_token_index;
+				if (skip_body(f)) {
+					return ast_proc_lit_lazy(f, type, open_index, tags, link_name);
+				}
+			}
 			AstNode *curr_proc = f->curr_proc;
 			AstNode *body = nullptr;
 			f->curr_proc = type;
@@ -2595,7 +2761,7 @@ AstNode *parse_operand(AstFile *f, bool lhs) {
 			// TODO(bill): Is this correct???
 			// NOTE(bill): Sanity check as identifiers should be handled already
 			TokenPos pos = ast_node_token(type).pos;
-			GB_ASSERT_MSG(type->kind != AstNode_Ident, "Type cannot be identifier %.*s(%td:%td)", LIT(pos.file), pos.line, pos.column);
+			GB_ASSERT_MSG(type->kind != AstNode_Ident, "Type cannot be identifier %.*s(%d:%d)", LIT(token_pos_file(pos)), pos.line, pos.column);
 			return type;
 		}
 		#endif
@@ -3958,6 +4124,89 @@ AstNode *parse_body(AstFile *f) {
 	return ast_block_stmt(f, stmts, open, close);
 }
 
+// Skips over a `{ ... }` body by matching braces on the token kinds alone without
+// building anything. Returns false, without moving, if the braces are not balanced so that the
+// body can be parsed normally and the syntax error reported
+bool skip_body(AstFile *f) {
+	GB_ASSERT(f->curr_token.kind == Token_OpenBrace);
+	isize depth = 0;
+	for (isize i = f->curr_token_index; i < f->tokens.count; i++) {
+		switch (f->tokens[i].kind) {
+		case Token_OpenBrace:
+			depth++;
+			break;
+		case Token_CloseBrace:
+			depth--;
+			if (depth == 0) {
+				f->curr_token_index = i;
+				f->curr_token = ast_file_token(f, i);
+				f->curr_line_index = f->curr_token.pos.line-1;
+				advance_token(f);
+				return true;
+			}
+			break;
+		case Token_EOF:
+			return false;
+		}
+	}
+	return false;
+}
+
+bool ast_proc_lit_has_body(AstNode *proc_lit) {
+	GB_ASSERT(proc_lit->kind == AstNode_ProcLit);
+	return proc_lit->ProcLit.body != nullptr || proc_lit->ProcLit.lazy_body_index > 0;
+}
+
+// Returns the body of a procedure literal, parsing it first if it was skipped with
+// `-lazy-proc-bodies`. The parser state is saved and restored around it so it may be called at
+// any point after the file has been parsed
+AstNode *ast_proc_lit_body(AstNode *proc_lit) {
+	GB_ASSERT(proc_lit->kind == AstNode_ProcLit);
+	ast_node(pl, ProcLit, proc_lit);
+	if (pl->lazy_body_index <= 0) {
+		return pl->body;
+	}
+
+	AstFile *f = proc_lit->file;
+	gb_mutex_lock(&f->lazy_body_mutex);
+	defer (gb_mutex_unlock(&f->lazy_body_mutex));
+
+	if (pl->body != nullptr) {
+		return pl->body;
+	}
+
+	isize        prev_token_index = f->curr_token_index;
+	Token        prev_curr_token  = f->curr_token;
+	Token        prev_prev_token  = f->prev_token;
+	AstNode *    prev_curr_proc   = f->curr_proc;
+	bool         prev_allow_range = f->allow_range;
+	bool         prev_allow_type  = f->allow_type;
+	CommentGroup prev_lead        = f->lead_comment;
+	CommentGroup prev_line        = f->line_comment;
+
+	f->curr_token_index = pl->lazy_body_index;
+	f->curr_token       = ast_file_token(f, pl->lazy_body_index);
+	f->curr_line_index  = f->curr_token.pos.line-1;
+	f->prev_token       = ast_file_token(f, pl->lazy_body_index-1);
+	f->curr_proc        = pl->type;
+	f->allow_range      = false;
+	f->allow_type       = false;
+
+	pl->body = parse_body(f);
+
+	f->curr_token_index = prev_token_index;
+	f->curr_token       = prev_curr_token;
+	f->curr_line_index  = prev_curr_token.pos.line-1;
+	f->prev_token       = prev_prev_token;
+	f->curr_proc        = prev_curr_proc;
+	f->allow_range      = prev_allow_range;
+	f->allow_type       = prev_allow_type;
+	f->lead_comment     = prev_lead;
+	f->line_comment     = prev_line;
+
+	return pl->body;
+}
+
 AstNode *parse_if_stmt(AstFile *f) {
 	if (f->curr_proc == nullptr) {
 		syntax_error(f->curr_token, "You cannot use an if statement in the file scope");
@@ -4011,7 +4260,7 @@ AstNode *parse_if_stmt(AstFile *f) {
 		} break;
 		default:
 			syntax_error(f->curr_token, "Expected if statement block statement");
-			else_stmt = ast_bad_stmt(f, f->curr_token, f->tokens[f->curr_token_index+1]);
+			else_stmt = ast_bad_stmt(f, f->curr_token, ast_file_token(f, f->curr_token_index+1));
 			break;
 		}
 	}
@@ -4059,7 +4308,7 @@ AstNode *parse_when_stmt(AstFile *f) {
 		} break;
 		default:
 			syntax_error(f->curr_token, "Expected when statement block statement");
-			else_stmt = ast_bad_stmt(f, f->curr_token, f->tokens[f->curr_token_index+1]);
+			else_stmt = ast_bad_stmt(f, f->curr_token, ast_file_token(f, f->curr_token_index+1));
 			break;
 		}
 	}
@@ -4074,13 +4323,15 @@ AstNode *parse_when_stmt(AstFile *f) {
 
 
 AstNode *parse_return_stmt(AstFile *f) {
-	if (f->curr_proc == nullptr) {
-		syntax_error(f->curr_token, "You cannot use a return statement in the file scope");
-		return ast_bad_stmt(f, f->curr_token, f->curr_token);
-	}
-	if (f->expr_level > 0) {
-		syntax_error(f->curr_token, "You cannot use a return statement within an expression");
-		return ast_bad_stmt(f, f->curr_token, f->curr_token);
+	if (f->curr_proc == nullptr || f->expr_level > 0) {
+		if (f->curr_proc == nullptr) {
+			syntax_error(f->curr_token, "You cannot use a return statement in the file scope");
+		} else {
+			syntax_error(f->curr_token, "You cannot use a return statement within an expression");
+		}
+		Token token = expect_token(f, Token_return);
+		fix_advance_to_next_stmt(f);
+		return ast_bad_stmt(f, token, f->curr_token);
 	}
 
 	Token token = expect_token(f, Token_return);
@@ -4654,7 +4905,13 @@ Array<AstNode *> parse_stmt_list(AstFile *f) {
 	while (f->curr_token.kind != Token_case &&
 	       f->curr_token.kind != Token_CloseBrace &&
 	       f->curr_token.kind != Token_EOF) {
+		isize prev_token_index = f->curr_token_index;
 		AstNode *stmt = parse_stmt(f);
+		if (f->curr_token_index == prev_token_index) {
+			// An error recovery path did not consume anything; skip the token
+			// so that the same statement is not parsed again forever
+			advance_token(f);
+		}
 		if (stmt && stmt->kind != AstNode_EmptyStmt) {
 			array_add(&list, stmt);
 			if (stmt->kind == AstNode_ExprStmt &&
@@ -4699,7 +4956,7 @@ ParseFileError init_ast_file(AstFile *f, String fullpath, TokenPos *err_pos) {
 			err_pos->column = token.pos.column;
 			return ParseFile_InvalidToken;
 		}
-		array_add(&f->tokens, token);
+		array_add(&f->tokens, tokenizer_pack_token(&f->tokenizer, token));
 
 		if (token.kind == Token_EOF) {
 			break;
@@ -4707,35 +4964,44 @@ ParseFileError init_ast_file(AstFile *f, String fullpath, TokenPos *err_pos) {
 	}
 
 	f->curr_token_index = 0;
-	f->prev_token = f->tokens[f->curr_token_index];
-	f->curr_token = f->tokens[f->curr_token_index];
+	f->prev_token = ast_file_token(f, f->curr_token_index);
+	f->curr_token = ast_file_token(f, f->curr_token_index);
+	f->curr_line_index = 0;
 
-	// NOTE(bill): Is this big enough or too small?
-	isize arena_size = gb_size_of(AstNode);
-	arena_size *= 2*f->tokens.count;
-	gb_arena_init_from_allocator(&f->arena, heap_allocator(), arena_size);
+	// Roughly 16 bytes per token to start with, the arena grows as needed
+	isize arena_block_size = 16*f->tokens.count;
+	ast_arena_init(&f->arena, region_allocator(Region_Parse), arena_block_size);
 	array_init(&f->comments, heap_allocator());
 	array_init(&f->imports_and_exports, heap_allocator());
+	array_init(&f->imports, heap_allocator());
 
 	f->curr_proc = nullptr;
+	gb_mutex_init(&f->lazy_body_mutex);
 
 	return ParseFile_None;
 }
 
 void destroy_ast_file(AstFile *f) {
-	gb_arena_free(&f->arena);
+	ast_arena_free(&f->arena);
 	array_free(&f->tokens);
 	array_free(&f->comments);
 	array_free(&f->imports_and_exports);
+	array_free(&f->imports);
 	gb_free(heap_allocator(), f->tokenizer.fullpath.text);
 	destroy_tokenizer(&f->tokenizer);
+	gb_mutex_destroy(&f->lazy_body_mutex);
 }
 
 bool init_parser(Parser *p) {
 	array_init(&p->files, heap_allocator());
 	array_init(&p->imports, heap_allocator());
 	gb_mutex_init(&p->file_add_mutex);
-	gb_mutex_init(&p->file_decl_mutex);
+	for (isize i = 0; i < IMPORT_PATH_SHARD_COUNT; i++) {
+		gb_mutex_init(&p->import_paths[i].mutex);
+		map_init(&p->import_paths[i].paths, heap_allocator());
+	}
+	gb_mutex_init(&p->import_mutex);
+	gb_semaphore_init(&p->worker_semaphore);
 	return true;
 }
 
@@ -4751,12 +5017,34 @@ void destroy_parser(Parser *p) {
 #endif
 	array_free(&p->files);
 	array_free(&p->imports);
+	region_release(Region_Parse);
 	gb_mutex_destroy(&p->file_add_mutex);
-	gb_mutex_destroy(&p->file_decl_mutex);
+	for (isize i = 0; i < IMPORT_PATH_SHARD_COUNT; i++) {
+		gb_mutex_destroy(&p->import_paths[i].mutex);
+		map_destroy(&p->import_paths[i].paths);
+	}
+	gb_mutex_destroy(&p->import_mutex);
+	gb_semaphore_destroy(&p->worker_semaphore);
+}
+
+// Returns true if `path` was not already in the set, i.e. this caller added it
+bool import_path_set_add(Parser *p, String path) {
+	HashKey key = hash_string(path);
+	// Use the top bits for the shard as `Map` uses the bottom bits for its buckets
+	ImportPathShard *shard = &p->import_paths[key.key >> (64-IMPORT_PATH_SHARD_BITS)];
+
+	gb_mutex_lock(&shard->mutex);
+	defer (gb_mutex_unlock(&shard->mutex));
+
+	if (map_get(&shard->paths, key) != nullptr) {
+		return false;
+	}
+	map_set(&shard->paths, key, true);
+	return true;
 }
 
 // NOTE(bill): Returns true if it's added
-bool try_add_import_path(Parser *p, String path, String rel_path, TokenPos pos) {
+bool try_add_import_path(Parser *p, AstFile *f, String path, String rel_path, TokenPos pos) {
 	if (build_context.generate_docs) {
 		return false;
 	}
@@ -4764,21 +5052,28 @@ bool try_add_import_path(Parser *p, String path, String rel_path, TokenPos pos)
 	path = string_trim_whitespace(path);
 	rel_path = string_trim_whitespace(rel_path);
 
-	for_array(i, p->imports) {
-		String import = p->imports[i].path;
-		if (import == path) {
-			return false;
-		}
-	}
-
 	ImportedFile item = {};
 	item.kind     = ImportedFile_Normal;
 	item.path     = path;
 	item.rel_path = rel_path;
 	item.pos      = pos;
-	item.index    = p->imports.count;
+	array_add(&f->imports, item);
+
+	if (!import_path_set_add(p, path)) {
+		return false;
+	}
+
+	gb_mutex_lock(&p->import_mutex);
+	defer (gb_mutex_unlock(&p->import_mutex));
+
+	item.index = p->imports.count;
 	array_add(&p->imports, item);
 
+	// Wake up an idle parsing thread (if any) to handle this new file
+	if (p->idle_worker_count > 0) {
+		p->idle_worker_count--;
+		gb_semaphore_release(&p->worker_semaphore);
+	}
 
 	return true;
 }
@@ -4856,9 +5151,6 @@ bool determine_path_from_string(Parser *p, AstNode *node, String base_dir, Strin
 		return false;
 	}
 
-	gb_mutex_lock(&p->file_decl_mutex);
-	defer (gb_mutex_unlock(&p->file_decl_mutex));
-
 	if (collection_name.len > 0) {
 		if (!find_library_collection_path(collection_name, &base_dir)) {
 			// NOTE(bill): It's a naughty name
@@ -4915,7 +5207,7 @@ void parse_setup_file_decls(Parser *p, AstFile *f, String base_dir, Array<AstNod
 			}
 
 			id->fullpath = import_path;
-			try_add_import_path(p, import_path, original_string, ast_node_token(node).pos);
+			try_add_import_path(p, f, import_path, original_string, ast_node_token(node).pos);
 		} else if (node->kind == AstNode_ExportDecl) {
 			ast_node(ed, ExportDecl, node);
 
@@ -4930,7 +5222,7 @@ void parse_setup_file_decls(Parser *p, AstFile *f, String base_dir, Array<AstNod
 			export_path = string_trim_whitespace(export_path);
 
 			ed->fullpath = export_path;
-			try_add_import_path(p, export_path, original_string, ast_node_token(node).pos);
+			try_add_import_path(p, f, export_path, original_string, ast_node_token(node).pos);
 		} else if (node->kind == AstNode_ForeignLibraryDecl) {
 			ast_node(fl, ForeignLibraryDecl, node);
 
@@ -4991,7 +5283,7 @@ ParseFileError parse_import(Parser *p, ImportedFile imported_file) {
 		}
 
 		if (pos.line != 0) {
-			gb_printf_err("%.*s(%td:%td) ", LIT(pos.file), pos.line, pos.column);
+			gb_printf_err("%.*s(%d:%d) ", LIT(token_pos_file(pos)), pos.line, pos.column);
 		}
 		gb_printf_err("Failed to parse file: %.*s\n\t", LIT(import_rel_path));
 		switch (err) {
@@ -5008,7 +5300,7 @@ ParseFileError parse_import(Parser *p, ImportedFile imported_file) {
 			gb_printf_err("File cannot be found (`%.*s`)", LIT(import_path));
 			break;
 		case ParseFile_InvalidToken:
-			gb_printf_err("Invalid token found in file at (%td:%td)", err_pos.line, err_pos.column);
+			gb_printf_err("Invalid token found in file at (%d:%d)", err_pos.line, err_pos.column);
 			break;
 		}
 		gb_printf_err("\n");
@@ -5026,20 +5318,121 @@ ParseFileError parse_import(Parser *p, ImportedFile imported_file) {
 	return ParseFile_None;
 }
 
+// Returns false when there is no more work to be done
+bool parse_worker_next_import(Parser *p, ImportedFile *imported_file) {
+	gb_mutex_lock(&p->import_mutex);
+	defer (gb_mutex_unlock(&p->import_mutex));
+
+	for (;;) {
+		if (p->worker_error != ParseFile_None) {
+			break;
+		}
+		if (p->curr_import_index < p->imports.count) {
+			*imported_file = p->imports[p->curr_import_index++];
+			p->active_worker_count++;
+			return true;
+		}
+		if (p->active_worker_count == 0) {
+			break;
+		}
+
+		// The files still being parsed may yet add more imports
+		p->idle_worker_count++;
+		gb_mutex_unlock(&p->import_mutex);
+		gb_semaphore_wait(&p->worker_semaphore);
+		gb_mutex_lock(&p->import_mutex);
+	}
+
+	if (p->idle_worker_count > 0) {
+		gb_semaphore_post(&p->worker_semaphore, cast(i32)p->idle_worker_count);
+		p->idle_worker_count = 0;
+	}
+	return false;
+}
+
+void parse_worker_finish_import(Parser *p, ParseFileError err) {
+	gb_mutex_lock(&p->import_mutex);
+	defer (gb_mutex_unlock(&p->import_mutex));
+
+	p->active_worker_count--;
+	if (err != ParseFile_None && p->worker_error == ParseFile_None) {
+		p->worker_error = err;
+	}
+
+	bool is_done = p->active_worker_count == 0 && p->curr_import_index >= p->imports.count;
+	if ((is_done || p->worker_error != ParseFile_None) && p->idle_worker_count > 0) {
+		gb_semaphore_post(&p->worker_semaphore, cast(i32)p->idle_worker_count);
+		p->idle_worker_count = 0;
+	}
+}
+
 GB_THREAD_PROC(parse_worker_file_proc) {
 	if (thread == nullptr) return 0;
 	auto *p = cast(Parser *)thread->user_data;
-	isize index = thread->user_index;
-	ImportedFile imported_file = p->imports[index];
-	ParseFileError err = parse_import(p, imported_file);
-	return cast(isize)err;
+	ImportedFile imported_file = {};
+	while (parse_worker_next_import(p, &imported_file)) {
+		ParseFileError err = parse_import(p, imported_file);
+		parse_worker_finish_import(p, err);
+	}
+	return 0;
 }
 
+// The parsing threads discover imports in an arbitrary order, so renumber the
+// imports and files in the order that a single thread would have found them
+void parse_reorder_imports(Parser *p) {
+	gbAllocator a = heap_allocator();
+
+	Map<AstFile *> file_map = {}; // Key: String (fullpath)
+	Map<bool>      seen     = {}; // Key: String (fullpath)
+	map_init(&file_map, a, 2*p->files.count);
+	map_init(&seen,     a, 2*p->imports.count);
+	defer (map_destroy(&file_map));
+	defer (map_destroy(&seen));
+
+	for_array(i, p->files) {
+		AstFile *f = p->files[i];
+		map_set(&file_map, hash_string(f->fullpath), f);
+	}
+
+	Array<ImportedFile> imports = {};
+	array_init(&imports, a, p->imports.count);
+	for_array(i, p->imports) {
+		ImportedFile imp = p->imports[i];
+		if (imp.kind != ImportedFile_Normal) {
+			map_set(&seen, hash_string(imp.path), true);
+			array_add(&imports, imp);
+		}
+	}
+
+	p->files.count = 0;
+	for_array(i, imports) {
+		if (imports[i].kind == ImportedFile_Normal) {
+			imports[i].index = i;
+		}
+		AstFile **found = map_get(&file_map, hash_string(imports[i].path));
+		if (found == nullptr) {
+			// Empty files are never added
+			continue;
+		}
+		AstFile *f = *found;
+		f->id = imports[i].index;
+		array_add(&p->files, f);
+		for_array(j, f->imports) {
+			ImportedFile imp = f->imports[j];
+			HashKey key = hash_string(imp.path);
+			if (map_get(&seen, key) == nullptr) {
+				map_set(&seen, key, true);
+				array_add(&imports, imp);
+			}
+		}
+	}
+	GB_ASSERT(imports.count == p->imports.count);
+	GB_ASSERT(p->files.count == file_map.entries.count);
+
+	array_free(&p->imports);
+	p->imports = imports;
+}
 
-struct ParserThreadWork {
-	Parser *parser;
-	isize   import_index;
-};
 
 ParseFileError parse_files(Parser *p, String init_filename) {
 	GB_ASSERT(init_filename.text[init_filename.len] == 0);
@@ -5049,91 +5442,61 @@ ParseFileError parse_files(Parser *p, String init_filename) {
 	TokenPos init_pos = {};
 	ImportedFile init_imported_file = {ImportedFile_Init, init_fullpath, init_fullpath, init_pos};
 
-	isize shared_file_count = 0;
 	if (!build_context.generate_docs) {
 		String s = get_fullpath_core(heap_allocator(), str_lit("_preload.odin"));
 		ImportedFile runtime_file = {ImportedFile_Shared, s, s, init_pos};
+		import_path_set_add(p, s);
 		array_add(&p->imports, runtime_file);
-		shared_file_count++;
 	}
 	if (!build_context.generate_docs) {
 		String s = get_fullpath_core(heap_allocator(), str_lit("_soft_numbers.odin"));
 		ImportedFile runtime_file = {ImportedFile_Shared, s, s, init_pos};
+		import_path_set_add(p, s);
 		array_add(&p->imports, runtime_file);
-		shared_file_count++;
 	}
 
+	import_path_set_add(p, init_fullpath);
 	array_add(&p->imports, init_imported_file);
 	p->init_fullpath = init_fullpath;
 
-/*
-	// IMPORTANT TODO(bill): Figure out why this doesn't work on *nix sometimes
-#if USE_THREADED_PARSER && defined(GB_SYSTEM_WINDOWS)
+#if USE_THREADED_PARSER
 	isize thread_count = gb_max(build_context.thread_count, 1);
 	if (thread_count > 1) {
+		// The main thread is a worker too
 		Array<gbThread> worker_threads = {};
-		array_init_count(&worker_threads, heap_allocator(), thread_count);
+		array_init_count(&worker_threads, heap_allocator(), thread_count-1);
 		defer (array_free(&worker_threads));
 
-		for_array(i, p->imports) {
+		for_array(i, worker_threads) {
 			gbThread *t = &worker_threads[i];
 			gb_thread_init(t);
+			gb_thread_start(t, parse_worker_file_proc, p);
 		}
-		isize curr_import_index = 0;
 
-		// NOTE(bill): Make sure that these are in parsed in this order
-		for (isize i = 0; i < shared_file_count; i++) {
-			ParseFileError err = parse_import(p, p->imports[i]);
-			if (err != ParseFile_None) {
-				return err;
-			}
-			curr_import_index++;
-		}
-
-		for (;;) {
-			bool are_any_alive = false;
-			for_array(i, worker_threads) {
-				gbThread *t = &worker_threads[i];
-				if (gb_thread_is_running(t)) {
-					are_any_alive = true;
-				} else if (curr_import_index < p->imports.count) {
-					auto err = cast(ParseFileError)t->return_value;
-					if (err != ParseFile_None) {
-						for_array(i, worker_threads) {
-							gb_thread_destroy(&worker_threads[i]);
-						}
-						return err;
-					}
-					t->user_index = curr_import_index++;
-					gb_thread_start(t, parse_worker_file_proc, p);
-					are_any_alive = true;
-				}
-			}
-			if (!are_any_alive && curr_import_index >= p->imports.count) {
-				break;
-			}
-		}
+		gbThread main_thread = {};
+		main_thread.user_data = p;
+		parse_worker_file_proc(&main_thread);
 
 		for_array(i, worker_threads) {
+			gb_thread_join(&worker_threads[i]);
 			gb_thread_destroy(&worker_threads[i]);
 		}
-	} else {
-		for_array(i, p->imports) {
-			ParseFileError err = parse_import(p, p->imports[i]);
+
+		if (p->worker_error != ParseFile_None) {
+			return p->worker_error;
+		}
+
+		parse_reorder_imports(p);
+	} else
+#endif
+	{
+		for (isize import_index = 0; import_index < p->imports.count; import_index++) {
+			ParseFileError err = parse_import(p, p->imports[import_index]);
 			if (err != ParseFile_None) {
 				return err;
 			}
 		}
 	}
-#else */
-	isize import_index = 0;
-	for (; import_index < p->imports.count; import_index++) {
-		ParseFileError err = parse_import(p, p->imports[import_index]);
-		if (err != ParseFile_None) {
-			return err;
-		}
-	}
-// #endif
 
 	for_array(i, p->files) {
 		p->total_token_count += p->files[i]->tokens.count;
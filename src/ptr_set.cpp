@@ -1,6 +1,6 @@
+// A `PtrSet` uses the same `HashIndex` as `Map` with the pointers packed in `entries`
 struct PtrSetFindResult {
-	isize hash_index;
-	isize entry_prev;
+	isize slot_index;
 	isize entry_index;
 };
 
@@ -8,12 +8,11 @@ struct PtrSetFindResult {
 template <typename T>
 struct PtrSetEntry {
 	T       ptr;
-	isize   next;
 };
 
 template <typename T>
 struct PtrSet {
-	Array<isize>          hashes;
+	HashIndex             index;
 	Array<PtrSetEntry<T>> entries;
 };
 
@@ -29,103 +28,66 @@ template <typename T> void ptr_set_rehash           (PtrSet<T> *s, isize new_cou
 
 template <typename T>
 void ptr_set_init(PtrSet<T> *s, gbAllocator a, isize capacity) {
-	array_init(&s->hashes,  a, capacity);
+	gb_zero_item(&s->index);
 	array_init(&s->entries, a, capacity);
 }
 
 template <typename T>
 void ptr_set_destroy(PtrSet<T> *s) {
-	array_free(&s->hashes);
+	hash_index_destroy(&s->index, s->entries.allocator);
 	array_free(&s->entries);
 }
 
 template <typename T>
-gb_internal isize ptr_set__add_entry(PtrSet<T> *s, T ptr) {
-	PtrSetEntry<T> e = {};
-	e.ptr = ptr;
-	e.next = -1;
-	array_add(&s->entries, e);
-	return s->entries.count-1;
+gb_inline u64 ptr_set__hash(T ptr) {
+	return hash_index_mix(cast(u64)cast(uintptr)ptr);
 }
 
-
 template <typename T>
 gb_internal PtrSetFindResult ptr_set__find(PtrSet<T> *s, T ptr) {
-	PtrSetFindResult fr = {-1, -1, -1};
-	if (s->hashes.count > 0) {
-		uintptr p = cast(uintptr)ptr;
-		uintptr n = cast(uintptr)s->hashes.count;
-		fr.hash_index = cast(isize)(p % n);
-		fr.entry_index = s->hashes[fr.hash_index];
-		while (fr.entry_index >= 0) {
-			if (s->entries[fr.entry_index].ptr == ptr) {
-				return fr;
+	PtrSetFindResult fr = {-1, -1};
+	HashIndex *ix = &s->index;
+	if (ix->capacity > 0) {
+		u64 hash = ptr_set__hash(ptr);
+		u8 ctrl = hash_index_ctrl(hash);
+		isize stride = 0;
+		isize group = hash_index_first_group(ix, hash);
+		for (;;) {
+			u8 const *g = ix->ctrl + group;
+			for (u32 mask = hash_group_match(g, ctrl); mask != 0; mask &= mask-1) {
+				isize slot = group + bit_scan_forward(mask);
+				isize index = ix->slots[slot];
+				if (s->entries[index].ptr == ptr) {
+					fr.slot_index  = slot;
+					fr.entry_index = index;
+					return fr;
+				}
 			}
-			fr.entry_prev = fr.entry_index;
-			fr.entry_index = s->entries[fr.entry_index].next;
-		}
-	}
-	return fr;
-}
-
-template <typename T>
-gb_internal PtrSetFindResult ptr_set__find_from_entry(PtrSet<T> *s, PtrSetEntry<T> *e) {
-	PtrSetFindResult fr = {-1, -1, -1};
-	if (s->hashes.count > 0) {
-		fr.hash_index  = e->key.key % s->hashes.count;
-		fr.entry_index = s->hashes[fr.hash_index];
-		while (fr.entry_index >= 0) {
-			if (&s->entries[fr.entry_index] == e) {
-				return fr;
+			if (hash_group_match(g, HASH_CTRL_EMPTY) != 0) {
+				break;
 			}
-			fr.entry_prev = fr.entry_index;
-			fr.entry_index = s->entries[fr.entry_index].next;
+			group = hash_index_next_group(ix, group, &stride);
 		}
 	}
 	return fr;
 }
 
-template <typename T>
-gb_internal b32 ptr_set__full(PtrSet<T> *s) {
-	return 0.75f * s->hashes.count <= s->entries.count;
-}
-
 template <typename T>
 gb_inline void ptr_set_grow(PtrSet<T> *s) {
-	isize new_count = ARRAY_GROW_FORMULA(s->entries.count);
-	ptr_set_rehash(s, new_count);
+	isize live = s->index.used - s->index.deleted;
+	ptr_set_rehash(s, ARRAY_GROW_FORMULA(live));
 }
 
+// Rebuilds the index with room for `new_count` pointers
 template <typename T>
 void ptr_set_rehash(PtrSet<T> *s, isize new_count) {
-	isize i, j;
-	PtrSet<T> ns = {};
-	ptr_set_init(&ns, s->hashes.allocator);
-	array_resize(&ns.hashes, new_count);
-	array_reserve(&ns.entries, s->entries.count);
-	for (i = 0; i < new_count; i++) {
-		ns.hashes[i] = -1;
-	}
-	for (i = 0; i < s->entries.count; i++) {
-		PtrSetEntry<T> *e = &s->entries[i];
-		PtrSetFindResult fr;
-		if (ns.hashes.count == 0) {
-			ptr_set_grow(&ns);
-		}
-		fr = ptr_set__find(&ns, e->ptr);
-		j = ptr_set__add_entry(&ns, e->ptr);
-		if (fr.entry_prev < 0) {
-			ns.hashes[fr.hash_index] = j;
-		} else {
-			ns.entries[fr.entry_prev].next = j;
-		}
-		ns.entries[j].next = fr.entry_index;
-		if (ptr_set__full(&ns)) {
-			ptr_set_grow(&ns);
-		}
+	gbAllocator a = s->entries.allocator;
+	hash_index_destroy(&s->index, a);
+	hash_index_init(&s->index, a, hash_index_capacity_for(gb_max(new_count, s->entries.count)));
+	for_array(i, s->entries) {
+		u64 hash = ptr_set__hash(s->entries[i].ptr);
+		hash_index_set(&s->index, hash_index_find_free(&s->index, hash), hash, i);
 	}
-	ptr_set_destroy(s);
-	*s = ns;
 }
 
 template <typename T>
@@ -134,50 +96,34 @@ gb_inline bool ptr_set_exists(PtrSet<T> *s, T ptr) {
 	return index >= 0;
 }
 
-// Returns true if it already exists
 template <typename T>
 void ptr_set_add(PtrSet<T> *s, T ptr) {
-	isize index;
-	PtrSetFindResult fr;
-	if (s->hashes.count == 0) {
-		ptr_set_grow(s);
-	}
-	fr = ptr_set__find(s, ptr);
-	if (fr.entry_index >= 0) {
-		index = fr.entry_index;
-	} else {
-		index = ptr_set__add_entry(s, ptr);
-		if (fr.entry_prev >= 0) {
-			s->entries[fr.entry_prev].next = index;
-		} else {
-			s->hashes[fr.hash_index] = index;
-		}
+	if (ptr_set__find(s, ptr).entry_index >= 0) {
+		return;
 	}
-	if (ptr_set__full(s)) {
+	if (hash_index_full(&s->index)) {
 		ptr_set_grow(s);
 	}
+	PtrSetEntry<T> e = {};
+	e.ptr = ptr;
+	array_add(&s->entries, e);
+	u64 hash = ptr_set__hash(ptr);
+	hash_index_set(&s->index, hash_index_find_free(&s->index, hash), hash, s->entries.count-1);
 }
 
 
 template <typename T>
 void ptr_set__erase(PtrSet<T> *s, PtrSetFindResult fr) {
-	PtrSetFindResult last;
-	if (fr.entry_prev < 0) {
-		s->hashes[fr.hash_index] = s->entries[fr.entry_index].next;
-	} else {
-		s->entries[fr.entry_prev].next = s->entries[fr.entry_index].next;
-	}
-	if (fr.entry_index == s->entries.count-1) {
-		array_pop(&s->entries);
-		return;
-	}
-	s->entries[fr.entry_index] = s->entries[s->entries.count-1];
-	last = ptr_set__find(s, s->entries[fr.entry_index].ptr);
-	if (last.entry_prev >= 0) {
-		s->entries[last.entry_prev].next = fr.entry_index;
-	} else {
-		s->hashes[last.hash_index] = fr.entry_index;
+	hash_index_erase(&s->index, fr.slot_index);
+
+	// Move the last entry into the hole and fix its slot
+	isize last = s->entries.count-1;
+	if (fr.entry_index != last) {
+		s->entries[fr.entry_index] = s->entries[last];
+		PtrSetFindResult lr = ptr_set__find(s, s->entries[last].ptr);
+		s->index.slots[lr.slot_index] = cast(i32)fr.entry_index;
 	}
+	array_pop(&s->entries);
 }
 
 template <typename T>
@@ -190,6 +136,6 @@ void ptr_set_remove(PtrSet<T> *s, T ptr) {
 
 template <typename T>
 gb_inline void ptr_set_clear(PtrSet<T> *s) {
-	array_clear(&s->hashes);
+	hash_index_clear(&s->index);
 	array_clear(&s->entries);
 }
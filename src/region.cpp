@@ -0,0 +1,163 @@
+// A region is a bump allocator for everything with the lifetime of a compiler phase.
+// Nothing allocated from it is freed on its own; all of it is released at once when the phase's data
+// is no longer needed. Each thread bumps from its own block so the parser and checker threads do
+// not contend, only taking the lock for a new block.
+
+enum RegionKind {
+	Region_Parse, // AST
+	Region_Check, // Entities, Types, Scopes, DeclInfos
+	Region_Ir,    // irValues
+	Region_Print, // Temporaries whilst printing the LLVM IR
+
+	Region_COUNT,
+};
+
+String const region_strings[Region_COUNT] = {
+	{cast(u8 *)"parse", gb_size_of("parse")-1},
+	{cast(u8 *)"check", gb_size_of("check")-1},
+	{cast(u8 *)"ir",    gb_size_of("ir")-1},
+	{cast(u8 *)"print", gb_size_of("print")-1},
+};
+
+enum {
+	REGION_BLOCK_SIZE         = 1<<18,
+	REGION_OUT_OF_BAND_SIZE   = REGION_BLOCK_SIZE/8, // Larger allocations get a block of their own
+	REGION_DEFAULT_ALIGNMENT  = 16,
+};
+
+struct Region {
+	gbMutex     mutex;   // Guards `blocks`
+	Array<u8 *> blocks;
+	gbAtomic32  generation; // Incremented on release so that the threads drop their blocks
+
+	// Statistics
+	gbAtomic64  allocation_count; // Only counted with `region_track_statistics`
+	gbAtomic64  bytes_allocated;  // Only counted with `region_track_statistics`
+	i64         bytes_reserved;
+	i64         peak_bytes_reserved;
+	i64         block_count;
+	i64         release_count;
+};
+
+struct RegionThreadBlock {
+	u8 *pos;
+	u8 *end;
+	u32 generation;
+};
+
+gb_global Region global_regions[Region_COUNT] = {};
+gb_global bool   region_track_statistics = false;
+gb_thread_local RegionThreadBlock region_thread_blocks[Region_COUNT] = {};
+
+
+void init_global_regions(void) {
+	for (isize i = 0; i < Region_COUNT; i++) {
+		Region *r = &global_regions[i];
+		gb_mutex_init(&r->mutex);
+		array_init(&r->blocks, heap_allocator());
+		gb_atomic32_store(&r->generation, 1);
+	}
+}
+
+void *region_alloc_slow(RegionKind kind, isize size, isize alignment) {
+	Region *r = &global_regions[kind];
+	RegionThreadBlock *tb = &region_thread_blocks[kind];
+
+	isize block_size = REGION_BLOCK_SIZE;
+	bool out_of_band = size+alignment > REGION_OUT_OF_BAND_SIZE;
+	if (out_of_band) {
+		block_size = size+alignment;
+	}
+	// `heap_allocator` clears the memory, which the users of a region rely upon
+	u8 *block = cast(u8 *)gb_alloc_align(heap_allocator(), block_size, REGION_DEFAULT_ALIGNMENT);
+
+	gb_mutex_lock(&r->mutex);
+	array_add(&r->blocks, block);
+	r->block_count         += 1;
+	r->bytes_reserved      += block_size;
+	r->peak_bytes_reserved  = gb_max(r->peak_bytes_reserved, r->bytes_reserved);
+	u32 generation = cast(u32)gb_atomic32_load(&r->generation);
+	gb_mutex_unlock(&r->mutex);
+
+	u8 *ptr = cast(u8 *)gb_align_forward(block, alignment);
+	if (!out_of_band) {
+		tb->pos        = ptr + size;
+		tb->end        = block + block_size;
+		tb->generation = generation;
+	}
+	return ptr;
+}
+
+gb_inline void *region_alloc(RegionKind kind, isize size, isize alignment = REGION_DEFAULT_ALIGNMENT) {
+	if (alignment <= 0) {
+		alignment = REGION_DEFAULT_ALIGNMENT;
+	}
+	if (region_track_statistics) {
+		Region *r = &global_regions[kind];
+		gb_atomic64_fetch_add(&r->allocation_count, 1);
+		gb_atomic64_fetch_add(&r->bytes_allocated, size);
+	}
+
+	RegionThreadBlock *tb = &region_thread_blocks[kind];
+	if (tb->generation == cast(u32)global_regions[kind].generation.value) {
+		u8 *ptr = cast(u8 *)gb_align_forward(tb->pos, alignment);
+		if (ptr + size <= tb->end) {
+			tb->pos = ptr + size;
+			return ptr;
+		}
+	}
+	return region_alloc_slow(kind, size, alignment);
+}
+
+// Frees everything allocated from the region. No other thread may be using it.
+void region_release(RegionKind kind) {
+	Region *r = &global_regions[kind];
+	gb_mutex_lock(&r->mutex);
+	for_array(i, r->blocks) {
+		gb_free(heap_allocator(), r->blocks[i]);
+	}
+	array_clear(&r->blocks);
+	r->bytes_reserved  = 0;
+	r->release_count  += 1;
+	gb_atomic32_fetch_add(&r->generation, 1);
+	gb_mutex_unlock(&r->mutex);
+}
+
+
+GB_ALLOCATOR_PROC(region_allocator_proc) {
+	RegionKind kind = cast(RegionKind)cast(intptr)allocator_data;
+	void *ptr = nullptr;
+	gb_unused(flags);
+
+	switch (type) {
+	case gbAllocation_Alloc:
+		// The memory of a region is always cleared
+		ptr = region_alloc(kind, size, alignment);
+		break;
+	case gbAllocation_Free:
+		// Freed when the region is released
+		break;
+	case gbAllocation_FreeAll:
+		GB_PANIC("A region must be released with `region_release`");
+		break;
+	case gbAllocation_Resize:
+		if (size <= old_size) {
+			ptr = old_memory;
+		} else {
+			ptr = region_alloc(kind, size, alignment);
+			if (old_memory != nullptr) {
+				gb_memmove(ptr, old_memory, old_size);
+			}
+		}
+		break;
+	}
+
+	return ptr;
+}
+
+gbAllocator region_allocator(RegionKind kind) {
+	gbAllocator a;
+	a.proc = region_allocator_proc;
+	a.data = cast(void *)cast(intptr)kind;
+	return a;
+}
@@ -1143,9 +1143,9 @@ ssaAddr ssa_build_addr(ssaProc *p, AstNode *expr) {
 	TokenPos token_pos = ast_node_token(expr).pos;
 	GB_PANIC("Unexpected address expression\n"
 	         "\tAstNode: %.*s @ "
-	         "%.*s(%td:%td)\n",
+	         "%.*s(%d:%d)\n",
 	         LIT(ast_node_strings[expr->kind]),
-	         LIT(token_pos.file), token_pos.line, token_pos.column);
+	         LIT(token_pos_file(token_pos)), token_pos.line, token_pos.column);
 
 
 	return ssa_addr(nullptr);
@@ -1671,16 +1671,16 @@ ssaValue *ssa_build_expr(ssaProc *p, AstNode *expr) {
 
 	case_ast_node(bd, BasicDirective, expr);
 		TokenPos pos = bd->token.pos;
-		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(pos.file), pos.line, pos.column, LIT(bd->name));
+		GB_PANIC("Non-constant basic literal %.*s(%d:%d) - %.*s", LIT(token_pos_file(pos)), pos.line, pos.column, LIT(bd->name));
 	case_end;
 
 	case_ast_node(i, Ident, expr);
-		Entity *e = *map_get(&p->module->info->uses, hash_pointer(expr));
+		Entity *e = entity_of_ident(p->module->info, expr);
 		if (e->kind == Entity_Builtin) {
 			Token token = ast_node_token(expr);
 			GB_PANIC("TODO(bill): ssa_build_expr Entity_Builtin `%.*s`\n"
-			         "\t at %.*s(%td:%td)", LIT(builtin_procs[e->Builtin.id].name),
-			         LIT(token.pos.file), token.pos.line, token.pos.column);
+			         "\t at %.*s(%d:%d)", LIT(builtin_procs[e->Builtin.id].name),
+			         LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column);
 			return nullptr;
 		} else if (e->kind == Entity_Nil) {
 			GB_PANIC("TODO(bill): nil");
@@ -1825,7 +1825,7 @@ ssaValue *ssa_build_expr(ssaProc *p, AstNode *expr) {
 
 
 	case_ast_node(ce, CallExpr, expr);
-		if (map_get(&p->module->info->types, hash_pointer(ce->proc))->mode == Addressing_Type) {
+		if (type_and_value_of_expr(p->module->info, ce->proc).mode == Addressing_Type) {
 			GB_ASSERT(ce->args.count == 1);
 			ssaValue *x = ssa_build_expr(p, ce->args[0]);
 			return ssa_emit_conv(p, x, tv.type);
@@ -2370,14 +2370,14 @@ void ssa_build_proc(ssaModule *m, ssaProc *p) {
 		return;
 	}
 
-	ast_node(pl, ProcLit, p->decl_info->proc_lit);
-	if (pl->body == nullptr) {
+	AstNode *body = ast_proc_lit_body(p->decl_info->proc_lit);
+	if (body == nullptr) {
 		return;
 	}
 	p->entry = ssa_new_block(p, ssaBlock_Entry, "entry");
 
 	ssa_start_block(p, p->entry);
-	ssa_build_stmt(p, pl->body);
+	ssa_build_stmt(p, body);
 
 	if (p->entity->type->Proc.result_count == 0) {
 		ssa_emit_defer_stmts(p, ssaDeferExit_Return, nullptr);
@@ -2469,7 +2469,7 @@ bool ssa_generate(Parser *parser, CheckerInfo *info) {
 				// Handle later
 			} else if (scope->is_init && e->kind == Entity_Procedure && name == "main") {
 			} else {
-				name = ssa_mangle_name(&m, e->token.pos.file, e);
+				name = ssa_mangle_name(&m, token_pos_file(e->token.pos), e);
 			}
 		}
 
@@ -2485,7 +2485,7 @@ bool ssa_generate(Parser *parser, CheckerInfo *info) {
 		case Entity_Procedure: {
 			ast_node(pl, ProcLit, decl->proc_lit);
 			String original_name = name;
-			AstNode *body = pl->body;
+			AstNode *body = ast_proc_lit_body(decl->proc_lit);
 			if (e->Procedure.is_foreign) {
 				name = e->token.string; // NOTE(bill): Don't use the mangled name
 			}
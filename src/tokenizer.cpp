@@ -143,22 +143,134 @@ String const token_strings[] = {
 };
 
 
+struct KeywordHashEntry {
+	u32       hash;
+	TokenKind kind;
+};
+
+enum {
+	KEYWORD_HASH_TABLE_MIN_COUNT = 1<<6,
+	KEYWORD_HASH_TABLE_MAX_COUNT = 1<<12,
+};
+
+gb_global KeywordHashEntry keyword_hash_table[KEYWORD_HASH_TABLE_MAX_COUNT] = {};
+gb_global u32              keyword_hash_table_mask = 0;
+gb_global isize            max_keyword_size        = 0;
+
+gb_inline u32 keyword_hash(u8 const *text, isize len) {
+	u32 hash = 5381;
+	for (isize i = 0; i < len; i++) {
+		hash = (hash*33) ^ text[i];
+	}
+	return hash;
+}
+
+// Uses the smallest table in which no keywords collide, which makes it a perfect hash
+// and a lookup is at most one string comparison
+void init_keyword_hash_table(void) {
+	for (u32 count = KEYWORD_HASH_TABLE_MIN_COUNT; count <= KEYWORD_HASH_TABLE_MAX_COUNT; count *= 2) {
+		u32 mask = count-1;
+		bool is_perfect = true;
+		gb_zero_array(keyword_hash_table, count);
+
+		for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
+			String keyword = token_strings[k];
+			u32 hash = keyword_hash(keyword.text, keyword.len);
+			KeywordHashEntry *entry = &keyword_hash_table[hash & mask];
+			if (entry->kind != Token_Invalid) {
+				is_perfect = false;
+				break;
+			}
+			entry->hash = hash;
+			entry->kind = cast(TokenKind)k;
+			max_keyword_size = gb_max(max_keyword_size, keyword.len);
+		}
+
+		if (is_perfect) {
+			keyword_hash_table_mask = mask;
+			return;
+		}
+	}
+	GB_PANIC("Unable to create a perfect hash table for the keywords");
+}
+
+// Returns Token_Invalid if `s` is not a keyword
+gb_inline TokenKind keyword_kind(String s) {
+	// NOTE(bill): All keywords are > 1
+	if (1 < s.len && s.len <= max_keyword_size) {
+		u32 hash = keyword_hash(s.text, s.len);
+		KeywordHashEntry *entry = &keyword_hash_table[hash & keyword_hash_table_mask];
+		if (entry->kind != Token_Invalid && entry->hash == hash &&
+		    s == token_strings[entry->kind]) {
+			return entry->kind;
+		}
+	}
+	return Token_Invalid;
+}
+
+
+// A position is kept in every token of the AST, so the file is stored as an index into
+// `token_pos_files` rather than as its path. Use `token_pos_file` to get the path
 struct TokenPos {
-	String file;
-	isize  line;
-	isize  column;
+	i32 file_id; // 0 if the position has no file
+	i32 line;
+	i32 column;
+};
+
+// The paths of the files, indexed by `TokenPos::file_id`. Paths are only ever added and a chunk
+// never moves once allocated, so a path may be read without taking the lock
+#define TOKEN_POS_FILE_CHUNK_SIZE  256
+#define TOKEN_POS_FILE_CHUNK_COUNT 4096
+
+struct TokenPosFiles {
+	gbMutex  mutex;
+	i32      count;
+	String * chunks[TOKEN_POS_FILE_CHUNK_COUNT];
 };
 
-TokenPos token_pos(String file, isize line, isize column) {
-	TokenPos pos = {file, line, column};
+gb_global TokenPosFiles token_pos_files = {};
+
+void init_token_pos_files(void) {
+	gb_mutex_init(&token_pos_files.mutex);
+	token_pos_files.count = 1; // 0 is no file
+	token_pos_files.chunks[0] = gb_alloc_array(heap_allocator(), String, TOKEN_POS_FILE_CHUNK_SIZE);
+}
+
+i32 add_token_pos_file(String path) {
+	TokenPosFiles *files = &token_pos_files;
+	gb_mutex_lock(&files->mutex);
+	defer (gb_mutex_unlock(&files->mutex));
+
+	i32 id = files->count;
+	String **chunk = &files->chunks[id / TOKEN_POS_FILE_CHUNK_SIZE];
+	GB_ASSERT_MSG(id / TOKEN_POS_FILE_CHUNK_SIZE < TOKEN_POS_FILE_CHUNK_COUNT, "Too many files");
+	if (*chunk == nullptr) {
+		*chunk = gb_alloc_array(heap_allocator(), String, TOKEN_POS_FILE_CHUNK_SIZE);
+	}
+	(*chunk)[id % TOKEN_POS_FILE_CHUNK_SIZE] = path;
+	files->count += 1;
+	return id;
+}
+
+gb_inline String token_pos_file(TokenPos pos) {
+	return token_pos_files.chunks[pos.file_id / TOKEN_POS_FILE_CHUNK_SIZE][pos.file_id % TOKEN_POS_FILE_CHUNK_SIZE];
+}
+
+TokenPos token_pos(i32 file_id, i32 line, i32 column) {
+	TokenPos pos = {file_id, line, column};
 	return pos;
 }
 
 i32 token_pos_cmp(TokenPos const &a, TokenPos const &b) {
 	if (a.line == b.line) {
 		if (a.column == b.column) {
-			isize min_len = gb_min(a.file.len, b.file.len);
-			return gb_memcompare(a.file.text, b.file.text, min_len);
+			if (a.file_id == b.file_id) {
+				return 0;
+			}
+			String a_file = token_pos_file(a);
+			String b_file = token_pos_file(b);
+			isize min_len = gb_min(a_file.len, b_file.len);
+			return gb_memcompare(a_file.text, b_file.text, min_len);
 		}
 		return (a.column < b.column) ? -1 : +1;
 	}
@@ -172,43 +284,86 @@ bool operator<=(TokenPos const &a, TokenPos const &b) { return token_pos_cmp(a,
 bool operator> (TokenPos const &a, TokenPos const &b) { return token_pos_cmp(a, b) >  0; }
 bool operator>=(TokenPos const &a, TokenPos const &b) { return token_pos_cmp(a, b) >= 0; }
 
+// The position comes before the string so that the token packs into 32 bytes
 struct Token {
 	TokenKind kind;
-	String string;
-	TokenPos pos;
+	TokenPos  pos;
+	String    string;
 };
 
 Token empty_token = {Token_Invalid};
-Token blank_token = {Token_Ident, {cast(u8 *)"_", 1}};
+Token blank_token = {Token_Ident, {}, {cast(u8 *)"_", 1}};
 
 Token make_token_ident(String s) {
-	Token t = {Token_Ident, s};
+	Token t = {Token_Ident, {}, s};
 	return t;
 }
 
+enum PackedTokenFlag {
+	PackedTokenFlag_AllocatedString = 1<<0, // `len` is an index into `Tokenizer::allocated_strings`
+	PackedTokenFlag_QuotesRemoved   = 1<<1, // The string starts after the opening quote
+};
+
+// The compact form in which the parser stores a file's tokens. The `String` and
+// `TokenPos` of a `Token` are recreated from the tokenizer when required
+struct PackedToken {
+	u32 offset; // Of the first byte of the token from the start of the file
+	u32 len;
+	u16 kind;
+	u16 flags;
+};
+
 
 struct ErrorCollector {
-	TokenPos prev;
 	i64     count;
 	i64     warning_count;
 	gbMutex mutex;
 };
 
 gb_global ErrorCollector global_error_collector;
+// Per thread as files are parsed and procedure bodies are checked on many threads and
+// another thread moving on to the next file must not let a duplicate error through
+gb_thread_local TokenPos error_prev_pos;
+
+// Set whilst a procedure body is checked as a job. The job's errors are printed in the order of
+// the job keys once every job has finished, rather than in the order the jobs happened to run.
+gb_thread_local gbString *error_buffer = nullptr;
 
 void init_global_error_collector(void) {
 	gb_mutex_init(&global_error_collector.mutex);
 }
 
+void error_out_va(char const *fmt, va_list va) {
+	char buf[4096];
+	isize len = gb_snprintf_va(buf, gb_size_of(buf), fmt, va);
+	if (len <= 1) {
+		return;
+	}
+	if (error_buffer == nullptr) {
+		gb_file_write(gb_file_get_standard(gbFileStandard_Error), buf, len-1);
+	} else if (*error_buffer == nullptr) {
+		*error_buffer = gb_string_make_length(heap_allocator(), buf, len-1);
+	} else {
+		*error_buffer = gb_string_append_length(*error_buffer, buf, len-1);
+	}
+}
+
+void error_out(char const *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	error_out_va(fmt, va);
+	va_end(va);
+}
+
 void warning_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.warning_count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Warning: %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
+	if (error_prev_pos != token.pos) {
+		error_prev_pos = token.pos;
+		error_out("%.*s(%d:%d) Warning: %s\n",
+		          LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column,
+		          gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -218,13 +373,13 @@ void error_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
+	if (error_prev_pos != token.pos) {
+		error_prev_pos = token.pos;
+		error_out("%.*s(%d:%d) %s\n",
+		          LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column,
+		          gb_bprintf_va(fmt, va));
 	} else if (token.pos.line == 0) {
-		gb_printf_err("Error: %s\n", gb_bprintf_va(fmt, va));
+		error_out("Error: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -234,13 +389,13 @@ void syntax_error_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Syntax Error: %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
+	if (error_prev_pos != token.pos) {
+		error_prev_pos = token.pos;
+		error_out("%.*s(%d:%d) Syntax Error: %s\n",
+		          LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column,
+		          gb_bprintf_va(fmt, va));
 	} else if (token.pos.line == 0) {
-		gb_printf_err("Error: %s\n", gb_bprintf_va(fmt, va));
+		error_out("Error: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -250,13 +405,13 @@ void syntax_warning_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.warning_count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Syntax Warning: %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
+	if (error_prev_pos != token.pos) {
+		error_prev_pos = token.pos;
+		error_out("%.*s(%d:%d) Syntax Warning: %s\n",
+		          LIT(token_pos_file(token.pos)), token.pos.line, token.pos.column,
+		          gb_bprintf_va(fmt, va));
 	} else if (token.pos.line == 0) {
-		gb_printf_err("Warning: %s\n", gb_bprintf_va(fmt, va));
+		error_out("Warning: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -348,6 +503,7 @@ struct TokenizerState {
 
 struct Tokenizer {
 	String fullpath;
+	i32    file_id; // Of `fullpath` in `token_pos_files`
 	u8 *start;
 	u8 *end;
 
@@ -359,6 +515,9 @@ struct Tokenizer {
 
 	isize error_count;
 	Array<String> allocated_strings;
+	Array<u32>    line_offsets; // Byte offset of the start of each line
+
+	bool  is_memory_mapped; // `start` must be unmapped rather than freed
 };
 
 
@@ -408,6 +567,7 @@ void advance_to_next_rune(Tokenizer *t) {
 		if (t->curr_rune == '\n') {
 			t->line = t->curr;
 			t->line_count++;
+			array_add(&t->line_offsets, cast(u32)(t->line - t->start));
 		}
 		rune = *t->read_curr;
 		if (rune == 0) {
@@ -426,11 +586,97 @@ void advance_to_next_rune(Tokenizer *t) {
 		if (t->curr_rune == '\n') {
 			t->line = t->curr;
 			t->line_count++;
+			array_add(&t->line_offsets, cast(u32)(t->line - t->start));
 		}
 		t->curr_rune = GB_RUNE_EOF;
 	}
 }
 
+// Larger files (or ones that cannot be mapped) are read into memory instead
+#define TOKENIZER_MAX_MAPPED_FILE_SIZE gb_gigabytes(2)
+
+#if defined(GB_SYSTEM_UNIX) || defined(GB_SYSTEM_OSX)
+gbFileContents tokenizer_map_file_contents(char const *filepath) {
+	gbFileContents result = {0};
+
+	int fd = open(filepath, O_RDONLY);
+	if (fd < 0) {
+		return result;
+	}
+	defer (close(fd));
+
+	struct stat st = {};
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		return result;
+	}
+	isize size = cast(isize)st.st_size;
+	if (size <= 0 || size > TOKENIZER_MAX_MAPPED_FILE_SIZE) {
+		return result;
+	}
+
+	int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+	flags |= MAP_POPULATE;
+#endif
+	void *data = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+	if (data == MAP_FAILED) {
+		return result;
+	}
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	result.data = data;
+	result.size = size;
+	return result;
+}
+#elif defined(GB_SYSTEM_WINDOWS)
+gbFileContents tokenizer_map_file_contents(char const *filepath) {
+	gbFileContents result = {0};
+
+	wchar_t *w_path = gb__alloc_utf8_to_ucs2(heap_allocator(), filepath, nullptr);
+	if (w_path == nullptr) {
+		return result;
+	}
+	HANDLE file = CreateFileW(w_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	gb_free(heap_allocator(), w_path);
+	if (file == INVALID_HANDLE_VALUE) {
+		return result;
+	}
+	defer (CloseHandle(file));
+
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(file, &file_size)) {
+		return result;
+	}
+	isize size = cast(isize)file_size.QuadPart;
+	if (size <= 0 || size > TOKENIZER_MAX_MAPPED_FILE_SIZE) {
+		return result;
+	}
+
+	// The view keeps the mapping alive once both handles are closed
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		return result;
+	}
+	defer (CloseHandle(mapping));
+
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr) {
+		return result;
+	}
+
+	result.data = data;
+	result.size = size;
+	return result;
+}
+#else
+// Elsewhere the file is always read into memory
+gbFileContents tokenizer_map_file_contents(char const *filepath) {
+	gbFileContents result = {0};
+	return result;
+}
+#endif
+
 TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 	TokenizerInitError err = TokenizerInit_None;
 
@@ -438,22 +684,30 @@ TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 	gb_memcopy(c_str, fullpath.text, fullpath.len);
 	c_str[fullpath.len] = '\0';
 
-	// TODO(bill): Memory map rather than copy contents
-	gbFileContents fc = gb_file_read_contents(heap_allocator(), true, c_str);
+	bool is_memory_mapped = true;
+	gbFileContents fc = tokenizer_map_file_contents(c_str);
+	if (fc.data == nullptr) {
+		is_memory_mapped = false;
+		fc = gb_file_read_contents(heap_allocator(), true, c_str);
+	}
 	gb_zero_item(t);
 	if (fc.data != nullptr) {
 		t->start = cast(u8 *)fc.data;
 		t->line = t->read_curr = t->curr = t->start;
 		t->end = t->start + fc.size;
 		t->fullpath = fullpath;
+		t->file_id = add_token_pos_file(fullpath);
 		t->line_count = 1;
+		t->is_memory_mapped = is_memory_mapped;
+
+		array_init(&t->allocated_strings, heap_allocator());
+		array_init(&t->line_offsets, heap_allocator(), gb_max(fc.size/32, 16));
+		array_add(&t->line_offsets, cast(u32)0);
 
 		advance_to_next_rune(t);
 		if (t->curr_rune == GB_RUNE_BOM) {
 			advance_to_next_rune(t); // Ignore BOM at file beginning
 		}
-
-		array_init(&t->allocated_strings, heap_allocator());
 	} else {
 		gbFile f = {};
 		gbFileError file_err = gb_file_open(&f, c_str);
@@ -477,20 +731,166 @@ TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 
 gb_inline void destroy_tokenizer(Tokenizer *t) {
 	if (t->start != nullptr) {
-		gb_free(heap_allocator(), t->start);
+		if (t->is_memory_mapped) {
+		#if defined(GB_SYSTEM_UNIX) || defined(GB_SYSTEM_OSX)
+			munmap(t->start, t->end - t->start);
+		#elif defined(GB_SYSTEM_WINDOWS)
+			UnmapViewOfFile(t->start);
+		#endif
+		} else {
+			gb_free(heap_allocator(), t->start);
+		}
 	}
 	for_array(i, t->allocated_strings) {
 		gb_free(heap_allocator(), t->allocated_strings[i].text);
 	}
 	array_free(&t->allocated_strings);
+	array_free(&t->line_offsets);
+}
+
+// The `tokenizer_scan_*` procedures return the first byte in [curr, end) which is
+// not part of the run. Non-ASCII bytes always end a run so that `advance_to_next_rune` can
+// validate them. On x86, 16 bytes are tested at a time with SSE2.
+
+u8 *tokenizer_scan_whitespace(u8 *curr, u8 *end) {
+#if defined(GB_CPU_X86)
+	__m128i const space = _mm_set1_epi8(' ');
+	__m128i const tab   = _mm_set1_epi8('\t');
+	__m128i const nl    = _mm_set1_epi8('\n');
+	__m128i const cr    = _mm_set1_epi8('\r');
+	while (end - curr >= 16) {
+		__m128i c = _mm_loadu_si128(cast(__m128i const *)curr);
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, tab)),
+		                         _mm_or_si128(_mm_cmpeq_epi8(c, nl),    _mm_cmpeq_epi8(c, cr)));
+		u32 stop = ~cast(u32)_mm_movemask_epi8(m) & 0xffff;
+		if (stop != 0) {
+			return curr + bit_scan_forward(stop);
+		}
+		curr += 16;
+	}
+#endif
+	while (curr < end && (*curr == ' ' || *curr == '\t' || *curr == '\n' || *curr == '\r')) {
+		curr++;
+	}
+	return curr;
+}
+
+u8 *tokenizer_scan_identifier(u8 *curr, u8 *end) {
+#if defined(GB_CPU_X86)
+	// Signed comparisons, so bytes >= 0x80 are never in range
+	__m128i const lower_lo = _mm_set1_epi8('a'-1);
+	__m128i const lower_hi = _mm_set1_epi8('z'+1);
+	__m128i const upper_lo = _mm_set1_epi8('A'-1);
+	__m128i const upper_hi = _mm_set1_epi8('Z'+1);
+	__m128i const digit_lo = _mm_set1_epi8('0'-1);
+	__m128i const digit_hi = _mm_set1_epi8('9'+1);
+	__m128i const under    = _mm_set1_epi8('_');
+	while (end - curr >= 16) {
+		__m128i c = _mm_loadu_si128(cast(__m128i const *)curr);
+		__m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, lower_lo), _mm_cmplt_epi8(c, lower_hi));
+		__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, upper_lo), _mm_cmplt_epi8(c, upper_hi));
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, digit_lo), _mm_cmplt_epi8(c, digit_hi));
+		__m128i m = _mm_or_si128(_mm_or_si128(lower, upper), _mm_or_si128(digit, _mm_cmpeq_epi8(c, under)));
+		u32 stop = ~cast(u32)_mm_movemask_epi8(m) & 0xffff;
+		if (stop != 0) {
+			return curr + bit_scan_forward(stop);
+		}
+		curr += 16;
+	}
+#endif
+	while (curr < end && (gb_char_is_alphanumeric(cast(char)*curr) || *curr == '_')) {
+		curr++;
+	}
+	return curr;
+}
+
+u8 *tokenizer_scan_line_comment(u8 *curr, u8 *end) {
+#if defined(GB_CPU_X86)
+	__m128i const nl   = _mm_set1_epi8('\n');
+	__m128i const zero = _mm_setzero_si128();
+	while (end - curr >= 16) {
+		__m128i c = _mm_loadu_si128(cast(__m128i const *)curr);
+		__m128i m = _mm_or_si128(_mm_cmpeq_epi8(c, nl), _mm_cmpeq_epi8(c, zero));
+		u32 stop = cast(u32)(_mm_movemask_epi8(m) | _mm_movemask_epi8(c));
+		if (stop != 0) {
+			return curr + bit_scan_forward(stop);
+		}
+		curr += 16;
+	}
+#endif
+	while (curr < end && *curr != '\n' && *curr != 0 && *curr < 0x80) {
+		curr++;
+	}
+	return curr;
+}
+
+u8 *tokenizer_scan_block_comment(u8 *curr, u8 *end) {
+#if defined(GB_CPU_X86)
+	__m128i const slash = _mm_set1_epi8('/');
+	__m128i const star  = _mm_set1_epi8('*');
+	__m128i const zero  = _mm_setzero_si128();
+	while (end - curr >= 16) {
+		__m128i c = _mm_loadu_si128(cast(__m128i const *)curr);
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, slash), _mm_cmpeq_epi8(c, star)),
+		                         _mm_cmpeq_epi8(c, zero));
+		u32 stop = cast(u32)(_mm_movemask_epi8(m) | _mm_movemask_epi8(c));
+		if (stop != 0) {
+			return curr + bit_scan_forward(stop);
+		}
+		curr += 16;
+	}
+#endif
+	while (curr < end && *curr != '/' && *curr != '*' && *curr != 0 && *curr < 0x80) {
+		curr++;
+	}
+	return curr;
+}
+
+// Moves the tokenizer forward to `p`, where every byte in [t->curr, p) is ASCII.
+// This is equivalent to calling `advance_to_next_rune` until `t->curr == p`
+void tokenizer_skip_to(Tokenizer *t, u8 *p) {
+	GB_ASSERT(t->curr < p && p <= t->end);
+	u8 *last = p-1;
+	u8 *curr = t->curr;
+
+	// The newline (if any) at `last` is handled by `advance_to_next_rune`
+#if defined(GB_CPU_X86)
+	__m128i const nl = _mm_set1_epi8('\n');
+	while (last - curr >= 16) {
+		__m128i c = _mm_loadu_si128(cast(__m128i const *)curr);
+		u32 newlines = cast(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(c, nl));
+		if (newlines != 0) {
+			t->line_count += bit_set_count(newlines);
+			t->line = curr + bit_scan_reverse(newlines) + 1;
+			while (newlines != 0) {
+				isize i = bit_scan_forward(newlines);
+				array_add(&t->line_offsets, cast(u32)(curr+i+1 - t->start));
+				newlines &= newlines-1;
+			}
+		}
+		curr += 16;
+	}
+#endif
+	for (; curr < last; curr++) {
+		if (*curr == '\n') {
+			t->line_count++;
+			t->line = curr+1;
+			array_add(&t->line_offsets, cast(u32)(t->line - t->start));
+		}
+	}
+
+	t->curr      = last;
+	t->read_curr = p;
+	t->curr_rune = *last;
+	advance_to_next_rune(t);
 }
 
 void tokenizer_skip_whitespace(Tokenizer *t) {
-	while (t->curr_rune == ' ' ||
-	       t->curr_rune == '\t' ||
-	       t->curr_rune == '\n' ||
-	       t->curr_rune == '\r') {
-		advance_to_next_rune(t);
+	if (t->curr_rune == ' ' ||
+	    t->curr_rune == '\t' ||
+	    t->curr_rune == '\n' ||
+	    t->curr_rune == '\r') {
+		tokenizer_skip_to(t, tokenizer_scan_whitespace(t->curr, t->end));
 	}
 }
 
@@ -515,9 +915,9 @@ Token scan_number_to_token(Tokenizer *t, bool seen_decimal_point) {
 	Token token = {};
 	token.kind = Token_Integer;
 	token.string = make_string(t->curr, 1);
-	token.pos.file = t->fullpath;
-	token.pos.line = t->line_count;
-	token.pos.column = t->curr-t->line+1;
+	token.pos.file_id = t->file_id;
+	token.pos.line = cast(i32)t->line_count;
+	token.pos.column = cast(i32)(t->curr-t->line+1);
 
 	if (seen_decimal_point) {
 		token.kind = Token_Float;
@@ -771,27 +1171,26 @@ Token tokenizer_get_token(Tokenizer *t) {
 
 	Token token = {};
 	token.string = make_string(t->curr, 1);
-	token.pos.file = t->fullpath;
-	token.pos.line = t->line_count;
-	token.pos.column = t->curr - t->line + 1;
+	token.pos.file_id = t->file_id;
+	token.pos.line = cast(i32)t->line_count;
+	token.pos.column = cast(i32)(t->curr - t->line + 1);
 
 	Rune curr_rune = t->curr_rune;
 	if (rune_is_letter(curr_rune)) {
 		token.kind = Token_Ident;
 		while (rune_is_letter(t->curr_rune) || rune_is_digit(t->curr_rune)) {
-			advance_to_next_rune(t);
+			if (t->curr_rune < 0x80) {
+				tokenizer_skip_to(t, tokenizer_scan_identifier(t->curr, t->end));
+			} else {
+				advance_to_next_rune(t);
+			}
 		}
 
 		token.string.len = t->curr - token.string.text;
 
-		// NOTE(bill): All keywords are > 1
-		if (token.string.len > 1) {
-			for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
-				if (token.string == token_strings[k]) {
-					token.kind = cast(TokenKind)k;
-					break;
-				}
-			}
+		TokenKind keyword = keyword_kind(token.string);
+		if (keyword != Token_Invalid) {
+			token.kind = keyword;
 		}
 
 	} else if (gb_is_between(curr_rune, '0', '9')) {
@@ -959,7 +1358,11 @@ Token tokenizer_get_token(Tokenizer *t) {
 		case '/': {
 			if (t->curr_rune == '/') {
 				while (t->curr_rune != '\n' && t->curr_rune != GB_RUNE_EOF) {
-					advance_to_next_rune(t);
+					if (0 < t->curr_rune && t->curr_rune < 0x80) {
+						tokenizer_skip_to(t, tokenizer_scan_line_comment(t->curr, t->end));
+					} else {
+						advance_to_next_rune(t);
+					}
 				}
 				token.kind = Token_Comment;
 			} else if (t->curr_rune == '*') {
@@ -980,6 +1383,8 @@ Token tokenizer_get_token(Tokenizer *t) {
 							advance_to_next_rune(t);
 							comment_scope--;
 						}
+					} else if (0 < t->curr_rune && t->curr_rune < 0x80) {
+						tokenizer_skip_to(t, tokenizer_scan_block_comment(t->curr, t->end));
 					} else {
 						advance_to_next_rune(t);
 					}
@@ -1030,3 +1435,87 @@ Token tokenizer_get_token(Tokenizer *t) {
 	token.string.len = t->curr - token.string.text;
 	return token;
 }
+
+
+PackedToken tokenizer_pack_token(Tokenizer *t, Token token) {
+	GB_ASSERT(t->end - t->start <= U32_MAX);
+
+	PackedToken pt = {};
+	pt.kind   = cast(u16)token.kind;
+	pt.offset = t->line_offsets[token.pos.line-1] + cast(u32)(token.pos.column-1);
+
+	u8 *token_start = t->start + pt.offset;
+	if (t->start <= token.string.text && token.string.text <= t->end) {
+		if (token.string.text != token_start) {
+			GB_ASSERT(token.string.text == token_start+1);
+			pt.flags |= PackedTokenFlag_QuotesRemoved;
+		}
+		pt.len = cast(u32)token.string.len;
+	} else {
+		// An unquoted string literal, which is always the most recently allocated string
+		isize index = t->allocated_strings.count-1;
+		GB_ASSERT(index >= 0 && t->allocated_strings[index].text == token.string.text);
+		pt.len    = cast(u32)index;
+		pt.flags |= PackedTokenFlag_AllocatedString;
+	}
+	return pt;
+}
+
+isize tokenizer_offset_to_line_index(Tokenizer *t, u32 offset) {
+	// Find the last line which starts at or before `offset`
+	isize lo = 0;
+	isize hi = t->line_offsets.count-1;
+	while (lo < hi) {
+		isize mid = lo + (hi-lo+1)/2;
+		if (t->line_offsets[mid] <= offset) {
+			lo = mid;
+		} else {
+			hi = mid-1;
+		}
+	}
+	return lo;
+}
+
+// `line_index` is the line of the previously unpacked token. Scanning forward only ever steps it
+// onto the following lines, so the binary search is only needed when jumping backwards
+TokenPos tokenizer_offset_to_pos(Tokenizer *t, u32 offset, isize *line_index) {
+	isize line = *line_index;
+	if (line < 0 || line >= t->line_offsets.count || t->line_offsets[line] > offset) {
+		line = tokenizer_offset_to_line_index(t, offset);
+	} else {
+		while (line+1 < t->line_offsets.count && t->line_offsets[line+1] <= offset) {
+			line++;
+		}
+	}
+	*line_index = line;
+
+	TokenPos pos = {};
+	pos.file_id = t->file_id;
+	pos.line    = cast(i32)(line+1);
+	pos.column  = cast(i32)(offset - t->line_offsets[line] + 1);
+	return pos;
+}
+
+TokenPos tokenizer_offset_to_pos(Tokenizer *t, u32 offset) {
+	isize line_index = -1;
+	return tokenizer_offset_to_pos(t, offset, &line_index);
+}
+
+Token tokenizer_unpack_token(Tokenizer *t, PackedToken pt, isize *line_index) {
+	Token token = {};
+	token.kind = cast(TokenKind)pt.kind;
+	if (pt.flags & PackedTokenFlag_AllocatedString) {
+		token.string = t->allocated_strings[pt.len];
+	} else if (pt.flags & PackedTokenFlag_QuotesRemoved) {
+		token.string = make_string(t->start + pt.offset+1, pt.len);
+	} else {
+		token.string = make_string(t->start + pt.offset, pt.len);
+	}
+	token.pos = tokenizer_offset_to_pos(t, pt.offset, line_index);
+	return token;
+}
+
+Token tokenizer_unpack_token(Tokenizer *t, PackedToken pt) {
+	isize line_index = -1;
+	return tokenizer_unpack_token(t, pt, &line_index);
+}
@@ -196,6 +196,8 @@ struct Type {
 	TYPE_KINDS
 #undef TYPE_KIND
 	};
+	i64  cached_size;  // -1 until known, see `type_size_of`
+	i64  cached_align; // -1 until known, see `type_align_of`
 	bool failure;
 };
 
@@ -453,6 +455,8 @@ Type *alloc_type(gbAllocator a, TypeKind kind) {
 	Type *t = gb_alloc_item(a, Type);
 	gb_zero_item(t);
 	t->kind = kind;
+	t->cached_size  = -1;
+	t->cached_align = -1;
 	return t;
 }
 
@@ -471,36 +475,93 @@ Type *make_type_generic(gbAllocator a, i64 id, String name, Type *specialized) {
 	return t;
 }
 
-Type *make_type_pointer(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_Pointer);
-	t->Pointer.elem = elem;
+// Pointer, array, dynamic array, vector, slice and map types are hash-consed so that the
+// same element types always give the same `Type *` and `are_types_identical` stops at `x == y`.
+// They must not be modified once made. Interned types live for the whole compilation so they are
+// allocated with the heap allocator whatever allocator the caller passes
+struct TypeInternKey {
+	TypeKind kind;
+	i64      count;
+	Type *   elem;
+	Type *   value;
+};
+
+gb_global ShardedMap<Type *> type_intern_table = {};
+
+void init_type_intern_table(void) {
+	sharded_map_init(&type_intern_table, heap_allocator());
+	type_intern_table.is_concurrent = true;
+}
+
+bool type_intern_matches(Type *t, TypeInternKey const &k) {
+	if (t->kind != k.kind) {
+		return false;
+	}
+	switch (t->kind) {
+	case Type_Pointer:      return t->Pointer.elem == k.elem;
+	case Type_Array:        return t->Array.elem == k.elem && t->Array.count == k.count;
+	case Type_DynamicArray: return t->DynamicArray.elem == k.elem;
+	case Type_Vector:       return t->Vector.elem == k.elem && t->Vector.count == k.count;
+	case Type_Slice:        return t->Slice.elem == k.elem;
+	case Type_Map:          return t->Map.key == k.elem && t->Map.value == k.value;
+	}
+	return false;
+}
+
+Type *type_intern(TypeKind kind, Type *elem, Type *value, i64 count) {
+	TypeInternKey k = {};
+	gb_zero_item(&k); // The padding is hashed too
+	k.kind  = kind;
+	k.count = count;
+	k.elem  = elem;
+	k.value = value;
+	HashKey key = hashing_proc(&k, gb_size_of(k));
+
+	ShardedMapShard<Type *> *shard = sharded_map__shard(&type_intern_table, key);
+	gb_mutex_lock(&shard->mutex);
+	defer (gb_mutex_unlock(&shard->mutex));
+
+	Type **found = map_get(&shard->map, key);
+	if (found != nullptr && type_intern_matches(*found, k)) {
+		return *found;
+	}
+
+	Type *t = alloc_type(region_allocator(Region_Check), kind);
+	switch (kind) {
+	case Type_Pointer:      t->Pointer.elem = elem;                                 break;
+	case Type_Array:        t->Array.elem = elem;  t->Array.count = count;          break;
+	case Type_DynamicArray: t->DynamicArray.elem = elem;                            break;
+	case Type_Vector:       t->Vector.elem = elem; t->Vector.count = count;         break;
+	case Type_Slice:        t->Slice.elem = elem;                                   break;
+	case Type_Map:          t->Map.key = elem;     t->Map.value = value;            break;
+	default: GB_PANIC("Type kind %.*s cannot be interned", LIT(type_strings[kind])); break;
+	}
+	if (found == nullptr) {
+		// On a hash collision the type is left uninterned which is still correct as
+		// `are_types_identical` falls back to comparing the structure
+		map_set(&shard->map, key, t);
+	}
 	return t;
 }
 
+Type *make_type_pointer(gbAllocator a, Type *elem) {
+	return type_intern(Type_Pointer, elem, nullptr, 0);
+}
+
 Type *make_type_array(gbAllocator a, Type *elem, i64 count) {
-	Type *t = alloc_type(a, Type_Array);
-	t->Array.elem = elem;
-	t->Array.count = count;
-	return t;
+	return type_intern(Type_Array, elem, nullptr, count);
 }
 
 Type *make_type_dynamic_array(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_DynamicArray);
-	t->DynamicArray.elem = elem;
-	return t;
+	return type_intern(Type_DynamicArray, elem, nullptr, 0);
 }
 
 Type *make_type_vector(gbAllocator a, Type *elem, i64 count) {
-	Type *t = alloc_type(a, Type_Vector);
-	t->Vector.elem = elem;
-	t->Vector.count = count;
-	return t;
+	return type_intern(Type_Vector, elem, nullptr, count);
 }
 
 Type *make_type_slice(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_Slice);
-	t->Array.elem = elem;
-	return t;
+	return type_intern(Type_Slice, elem, nullptr, 0);
 }
 
 
@@ -564,13 +625,10 @@ Type *make_type_proc(gbAllocator a, Scope *scope, Type *params, isize param_coun
 bool is_type_valid_for_keys(Type *t);
 
 Type *make_type_map(gbAllocator a, i64 count, Type *key, Type *value) {
-	Type *t = alloc_type(a, Type_Map);
 	if (key != nullptr) {
 		GB_ASSERT(is_type_valid_for_keys(key));
 	}
-	t->Map.key   = key;
-	t->Map.value = value;
-	return t;
+	return type_intern(Type_Map, key, value, 0);
 }
 
 Type *make_type_bit_field_value(gbAllocator a, u32 bits) {
@@ -1233,6 +1291,97 @@ bool are_types_identical(Type *x, Type *y) {
 	return false;
 }
 
+gb_inline u64 type_hash_combine(u64 h, u64 x) {
+	return (h ^ x) * 0x100000001b3ull;
+}
+
+// Identical types have equal hashes, see `are_types_identical`. Beyond `depth` only the
+// kind is hashed, which just means more collisions
+u64 type_hash_structural(Type *t, isize depth = 0) {
+	u64 h = 0xcbf29ce484222325ull;
+	if (t == nullptr) {
+		return h;
+	}
+	h = type_hash_combine(h, t->kind);
+	if (depth > 8) {
+		return h;
+	}
+	depth += 1;
+
+	switch (t->kind) {
+	case Type_Generic:
+		h = type_hash_combine(h, type_hash_structural(t->Generic.specialized, depth));
+		break;
+	case Type_Basic:
+		h = type_hash_combine(h, t->Basic.kind);
+		break;
+	case Type_Array:
+		h = type_hash_combine(h, cast(u64)t->Array.count);
+		h = type_hash_combine(h, type_hash_structural(t->Array.elem, depth));
+		break;
+	case Type_DynamicArray:
+		h = type_hash_combine(h, type_hash_structural(t->DynamicArray.elem, depth));
+		break;
+	case Type_Vector:
+		h = type_hash_combine(h, cast(u64)t->Vector.count);
+		h = type_hash_combine(h, type_hash_structural(t->Vector.elem, depth));
+		break;
+	case Type_Slice:
+		h = type_hash_combine(h, type_hash_structural(t->Slice.elem, depth));
+		break;
+	case Type_BitField:
+		h = type_hash_combine(h, t->BitField.field_count);
+		h = type_hash_combine(h, cast(u64)t->BitField.custom_align);
+		break;
+	case Type_Enum:
+		h = type_hash_combine(h, cast(u64)cast(uintptr)t);
+		break;
+	case Type_Union:
+		h = type_hash_combine(h, t->Union.variants.count);
+		h = type_hash_combine(h, cast(u64)t->Union.custom_align);
+		for_array(i, t->Union.variants) {
+			h = type_hash_combine(h, type_hash_structural(t->Union.variants[i], depth));
+		}
+		break;
+	case Type_Struct:
+		h = type_hash_combine(h, t->Struct.fields.count);
+		h = type_hash_combine(h, cast(u64)t->Struct.custom_align);
+		h = type_hash_combine(h, (t->Struct.is_raw_union<<2) | (t->Struct.is_packed<<1) | t->Struct.is_ordered);
+		for_array(i, t->Struct.fields) {
+			Entity *f = t->Struct.fields[i];
+			h = type_hash_combine(h, gb_fnv64a(f->token.string.text, f->token.string.len));
+			h = type_hash_combine(h, (f->flags&EntityFlag_Using) != 0);
+			h = type_hash_combine(h, type_hash_structural(f->type, depth));
+		}
+		break;
+	case Type_Pointer:
+		h = type_hash_combine(h, type_hash_structural(t->Pointer.elem, depth));
+		break;
+	case Type_Named:
+		h = type_hash_combine(h, cast(u64)cast(uintptr)t->Named.type_name);
+		break;
+	case Type_Tuple:
+		h = type_hash_combine(h, t->Tuple.variables.count);
+		for_array(i, t->Tuple.variables) {
+			Entity *e = t->Tuple.variables[i];
+			h = type_hash_combine(h, e->kind);
+			h = type_hash_combine(h, type_hash_structural(e->type, depth));
+		}
+		break;
+	case Type_Proc:
+		h = type_hash_combine(h, t->Proc.calling_convention);
+		h = type_hash_combine(h, (t->Proc.c_vararg<<1) | t->Proc.variadic);
+		h = type_hash_combine(h, type_hash_structural(t->Proc.params, depth));
+		h = type_hash_combine(h, type_hash_structural(t->Proc.results, depth));
+		break;
+	case Type_Map:
+		h = type_hash_combine(h, type_hash_structural(t->Map.key,   depth));
+		h = type_hash_combine(h, type_hash_structural(t->Map.value, depth));
+		break;
+	}
+	return h;
+}
+
 Type *default_bit_field_value_type(Type *type) {
 	if (type == nullptr) {
 		return t_invalid;
@@ -1703,6 +1852,7 @@ Selection lookup_field_with_selection(gbAllocator a, Type *type_, String field_n
 struct TypePath {
 	Array<Type *> path; // Entity_TypeName;
 	bool failure;
+	bool no_cache; // Set if the walk met a type whose layout may still change
 };
 
 void type_path_init(TypePath *tp) {
@@ -1774,10 +1924,85 @@ i64 align_formula(i64 size, i64 align) {
 	return size;
 }
 
+// The size and alignment of a type are cached on its base type once known, so only the
+// first computation walks the type with a `TypePath`. Basic types are not cached as they are already
+// cheap and `basic_types` is statically initialized. Named types use their base type's cache. A
+// result is not cached if the walk met a polymorphic or invalid type, or an aggregate with no
+// elements yet, as those may still be filled in by the checker
+gb_global gbAtomic64 type_layout_cache_hits   = {};
+gb_global gbAtomic64 type_layout_cache_misses = {};
+
+// The IR procedure jobs lay out types in parallel. Every thread computes the same value for a
+// type, so relaxed atomic accesses are enough
+gb_inline i64 type_layout_cache_load(i64 *cached) {
+#if defined(GB_COMPILER_MSVC)
+	return *cast(i64 volatile *)cached;
+#else
+	return __atomic_load_n(cached, __ATOMIC_RELAXED);
+#endif
+}
+
+gb_inline void type_layout_cache_store(i64 *cached, i64 value) {
+#if defined(GB_COMPILER_MSVC)
+	*cast(i64 volatile *)cached = value;
+#else
+	__atomic_store_n(cached, value, __ATOMIC_RELAXED);
+#endif
+}
+
+gb_inline void type_layout_count(bool hit) {
+	if (build_context.show_timings) {
+		gb_atomic64_fetch_add(hit ? &type_layout_cache_hits : &type_layout_cache_misses, 1);
+	}
+}
+
+bool type_layout_can_cache(Type *t, TypePath *path) {
+	if (path == nullptr || path->failure || path->no_cache) {
+		return false;
+	}
+	switch (t->kind) {
+	case Type_Invalid:
+	case Type_Basic:
+	case Type_Named:
+	case Type_Generic:
+		return false;
+	case Type_Struct: return t->Struct.fields.count > 0;
+	case Type_Union:  return t->Union.variants.count > 0;
+	case Type_Tuple:  return t->Tuple.variables.count > 0;
+	case Type_Enum:   return t->Enum.base_type != nullptr;
+	}
+	return true;
+}
+
+void type_layout_mark_uncacheable(Type *t, TypePath *path) {
+	if (path == nullptr) {
+		return;
+	}
+	if (t->kind == Type_Generic ||
+	    (t->kind == Type_Basic && t->Basic.kind == Basic_Invalid)) {
+		path->no_cache = true;
+	}
+}
+
 i64 type_size_of(gbAllocator allocator, Type *t) {
 	if (t == nullptr) {
 		return 0;
 	}
+	if (!t->failure) {
+		Type *bt = base_type(t);
+		if (bt != nullptr && bt->kind == Type_Basic && bt->Basic.kind != Basic_Invalid) {
+			type_layout_count(true);
+			return type_size_of_internal(allocator, bt, nullptr);
+		}
+		if (bt != nullptr && bt->kind != Type_Basic) {
+			i64 size = type_layout_cache_load(&bt->cached_size);
+			if (size >= 0) {
+				type_layout_count(true);
+				return size;
+			}
+		}
+	}
+	type_layout_count(false);
 	i64 size;
 	TypePath path = {0};
 	type_path_init(&path);
@@ -1790,6 +2015,21 @@ i64 type_align_of(gbAllocator allocator, Type *t) {
 	if (t == nullptr) {
 		return 1;
 	}
+	if (!t->failure) {
+		Type *bt = base_type(t);
+		if (bt != nullptr && bt->kind == Type_Basic && bt->Basic.kind != Basic_Invalid) {
+			type_layout_count(true);
+			return type_align_of_internal(allocator, bt, nullptr);
+		}
+		if (bt != nullptr && bt->kind != Type_Basic) {
+			i64 align = type_layout_cache_load(&bt->cached_align);
+			if (align >= 0) {
+				type_layout_count(true);
+				return align;
+			}
+		}
+	}
+	type_layout_count(false);
 	i64 align;
 	TypePath path = {0};
 	type_path_init(&path);
@@ -1799,12 +2039,47 @@ i64 type_align_of(gbAllocator allocator, Type *t) {
 }
 
 
+i64 type_align_of_internal_uncached(gbAllocator allocator, Type *t, TypePath *path);
+i64 type_size_of_internal_uncached (gbAllocator allocator, Type *t, TypePath *path);
+
 i64 type_align_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
 	if (t->failure) {
 		return FAILURE_ALIGNMENT;
 	}
-
 	t = base_type(t);
+	if (t->kind != Type_Basic) {
+		i64 align = type_layout_cache_load(&t->cached_align);
+		if (align >= 0) {
+			return align;
+		}
+	}
+	type_layout_mark_uncacheable(t, path);
+	i64 align = type_align_of_internal_uncached(allocator, t, path);
+	if (type_layout_can_cache(t, path)) {
+		type_layout_cache_store(&t->cached_align, align);
+	}
+	return align;
+}
+
+i64 type_size_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
+	if (t->failure) {
+		return FAILURE_SIZE;
+	}
+	if (t->kind != Type_Basic && t->kind != Type_Named) {
+		i64 size = type_layout_cache_load(&t->cached_size);
+		if (size >= 0) {
+			return size;
+		}
+	}
+	type_layout_mark_uncacheable(t, path);
+	i64 size = type_size_of_internal_uncached(allocator, t, path);
+	if (type_layout_can_cache(t, path)) {
+		type_layout_cache_store(&t->cached_size, size);
+	}
+	return size;
+}
+
+i64 type_align_of_internal_uncached(gbAllocator allocator, Type *t, TypePath *path) {
 
 	switch (t->kind) {
 	case Type_Basic: {
@@ -1974,21 +2249,51 @@ Array<i64> type_set_offsets_of(gbAllocator allocator, Array<Entity *> fields, bo
 	return offsets;
 }
 
+// The offsets are set lazily and procedure bodies may be checked by several threads,
+// so they are set whilst holding this lock. It is recursive as setting the offsets of a type may
+// set the offsets of the types of its fields
+gb_global gbMutex          type_offsets_mutex;
+gb_thread_local isize      type_offsets_lock_depth = 0;
+
+void init_type_offsets_mutex(void) {
+	gb_mutex_init(&type_offsets_mutex);
+}
+
+void type_lock_offsets(void) {
+	if (type_offsets_lock_depth++ == 0) {
+		gb_mutex_lock(&type_offsets_mutex);
+	}
+}
+
+void type_unlock_offsets(void) {
+	if (--type_offsets_lock_depth == 0) {
+		gb_mutex_unlock(&type_offsets_mutex);
+	}
+}
+
 bool type_set_offsets(gbAllocator allocator, Type *t) {
 	t = base_type(t);
 	if (t->kind == Type_Struct) {
 		if (!t->Struct.are_offsets_set) {
-			t->Struct.are_offsets_being_processed = true;
-			t->Struct.offsets = type_set_offsets_of(allocator, t->Struct.fields, t->Struct.is_packed, t->Struct.is_raw_union);
-			t->Struct.are_offsets_set = true;
-			return true;
+			type_lock_offsets();
+			defer (type_unlock_offsets());
+			if (!t->Struct.are_offsets_set) {
+				t->Struct.are_offsets_being_processed = true;
+				t->Struct.offsets = type_set_offsets_of(allocator, t->Struct.fields, t->Struct.is_packed, t->Struct.is_raw_union);
+				t->Struct.are_offsets_set = true;
+				return true;
+			}
 		}
 	} else if (is_type_tuple(t)) {
 		if (!t->Tuple.are_offsets_set) {
-			t->Struct.are_offsets_being_processed = true;
-			t->Tuple.offsets = type_set_offsets_of(allocator, t->Tuple.variables, false, false);
-			t->Tuple.are_offsets_set = true;
-			return true;
+			type_lock_offsets();
+			defer (type_unlock_offsets());
+			if (!t->Tuple.are_offsets_set) {
+				t->Struct.are_offsets_being_processed = true;
+				t->Tuple.offsets = type_set_offsets_of(allocator, t->Tuple.variables, false, false);
+				t->Tuple.are_offsets_set = true;
+				return true;
+			}
 		}
 	} else {
 		GB_PANIC("Invalid type for setting offsets");
@@ -1996,11 +2301,7 @@ bool type_set_offsets(gbAllocator allocator, Type *t) {
 	return false;
 }
 
-i64 type_size_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
-	if (t->failure) {
-		return FAILURE_SIZE;
-	}
-
+i64 type_size_of_internal_uncached(gbAllocator allocator, Type *t, TypePath *path) {
 	switch (t->kind) {
 	case Type_Named: {
 		type_path_push(path, t);
@@ -2163,11 +2464,19 @@ i64 type_size_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
 			if (path->failure) {
 				return FAILURE_SIZE;
 			}
-			if (t->Struct.are_offsets_being_processed && t->Struct.offsets.data == nullptr) {
-				type_path_print_illegal_cycle(path, path->path.count-1);
-				return FAILURE_SIZE;
+			if (!t->Struct.are_offsets_set) {
+				// Another thread may be setting the offsets, which is not a cycle
+				type_lock_offsets();
+				bool is_cycle = t->Struct.are_offsets_being_processed && t->Struct.offsets.data == nullptr;
+				if (!is_cycle) {
+					type_set_offsets(allocator, t);
+				}
+				type_unlock_offsets();
+				if (is_cycle) {
+					type_path_print_illegal_cycle(path, path->path.count-1);
+					return FAILURE_SIZE;
+				}
 			}
-			type_set_offsets(allocator, t);
 			i64 size = t->Struct.offsets[count-1] + type_size_of_internal(allocator, t->Struct.fields[count-1]->type, path);
 			return align_formula(size, align);
 		}